@@ -1,81 +1,8274 @@
 #include <boost/beast.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/config.hpp>
+#include <boost/crc.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#if defined(_WIN32)
+#include <windows.h>
+#include <io.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/sendfile.h>
+#endif
+
 // Boost ktphanelerinin ksa isim alanlar
 namespace beast = boost::beast;
 namespace http = beast::http;
 namespace net = boost::asio;
 using tcp = net::ip::tcp;
 
-// JSON verisi iin basit bir struct
-struct JsonData {
-    std::string key;
-    std::string value;
+// Gelen istein balk alanlar ve gvdesi istee ait arenadan ayrlr (bkz. request_arena)
+using arena_allocator = std::pmr::polymorphic_allocator<char>;
+using arena_fields = http::basic_fields<arena_allocator>;
+using arena_body = http::basic_string_body<char, std::char_traits<char>, arena_allocator>;
+using api_request = http::request<arena_body, arena_fields>;
+
+// JSON verisi iin basit bir struct
+struct JsonData {
+    std::string key;
+    std::string value;
+};
+
+// Dosyada 64 bit konuma git
+inline bool seek_file(std::FILE* file, std::uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+// Gvdesi bellekte deil diskte duran cevabn (indirmeler) ak dosyas ve gnderilecek aral.
+// Nesne yok edilince dosya kapanr ve release arlr (r. indirme yuvas boaltlr).
+struct file_body {
+    std::FILE* file = nullptr;
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+    std::function<void()> release;
+
+    file_body() = default;
+    file_body(const file_body&) = delete;
+    file_body& operator=(const file_body&) = delete;
+
+    ~file_body() {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+        if (release) {
+            release();
+        }
+    }
+
+    // Araln at. baytndan itibaren n bayt oku (sendfile kullanlamayan yollar iin)
+    bool read(std::uint64_t at, char* out, std::size_t n) const {
+        return seek_file(file, offset + at) && std::fread(out, 1, n, file) == n;
+    }
+};
+
+// Bir route'un rettii, protokolden (HTTP/1.1 veya HTTP/2) bamsz cevap.
+// Gvde paylaml tutulur; bylece nbellekteki cevap kopyalanmadan gnderilir.
+struct route_result {
+    http::status status = http::status::ok;
+    std::string content_type;
+    std::shared_ptr<const std::string> body;
+    // Doluysa gvde body yerine bu dosya aralndan gnderilir
+    std::shared_ptr<file_body> file;
+    // Content-Type ve Content-Length dndaki balklar (r. Content-Range, ETag)
+    std::vector<std::pair<std::string, std::string>> headers;
+
+    std::uint64_t body_size() const {
+        return file ? file->length : body ? body->size() : 0;
+    }
+};
+
+using route_ptr = std::shared_ptr<const route_result>;
+
+inline route_ptr make_result(http::status status, std::string content_type, std::string body) {
+    auto result = std::make_shared<route_result>();
+    result->status = status;
+    result->content_type = std::move(content_type);
+    result->body = std::make_shared<const std::string>(std::move(body));
+    return result;
+}
+
+// Sadece yola bal (istein geri kalanndan bamsz) cevaplarn nbellei
+class response_cache {
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, route_ptr> entries_;
+
+public:
+    route_ptr find(const std::string& key) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        return it == entries_.end() ? nullptr : it->second;
+    }
+
+    void store(const std::string& key, route_ptr value) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        entries_.emplace(key, std::move(value));
+    }
+};
+
+// Route tablosu: HTTP/1.1 ve HTTP/2 oturumlar ayn tabloyu ve ayn nbellei kullanr
+class router {
+public:
+    using handler = std::function<route_ptr(const api_request&)>;
+    // Cevab sonradan, herhangi bir thread'den teslim etmek iin; oturum cevab kendi io thread'ine tar
+    using responder = std::function<void(route_ptr)>;
+    // Cevap hemen hazrsa onu dner; deilse defer() ile bir responder alr ve nullptr dner
+    using async_handler = std::function<route_ptr(const api_request&, const std::function<responder()>& defer)>;
+
+private:
+    struct entry {
+        handler fn;
+        async_handler async_fn;
+        bool cacheable;
+    };
+
+    std::unordered_map<std::string, entry> routes_;
+    // Yolun geri kalann parametre olarak alan route'lar (r. /scores/around/<oyuncu>)
+    std::vector<std::pair<std::string, handler>> prefixes_;
+    response_cache cache_;
+    route_ptr not_found_ = make_result(http::status::not_found, "text/plain", "404 Sayfa Bulunamadi");
+
+public:
+    // cacheable=true ise handler'n cevab sadece yola baldr ve ilk ardan sonra nbellekten dner
+    void add(std::string path, handler fn, bool cacheable = false) {
+        routes_[std::move(path)] = entry{ std::move(fn), nullptr, cacheable };
+    }
+
+    void add_async(std::string path, async_handler fn) {
+        routes_[std::move(path)] = entry{ nullptr, std::move(fn), false };
+    }
+
+    // prefix ile balayan ve tam eleen route'u olmayan yollar; nbellee alnmaz
+    void add_prefix(std::string prefix, handler fn) {
+        prefixes_.emplace_back(std::move(prefix), std::move(fn));
+    }
+
+    // Gelen URL'ye (URI) gre ynlendirme yapma (routing). nullptr dnerse cevap, make_responder()'n
+    // rettii responder'a daha sonra verilecektir; make_responder sadece asenkron route'larda arlr.
+    template <class MakeResponder>
+    route_ptr dispatch(const api_request& req, MakeResponder&& make_responder) {
+        auto const target = req.target();
+        std::string path(target.substr(0, target.find('?')));
+
+        auto it = routes_.find(path);
+        if (it == routes_.end()) {
+            for (auto const& prefix : prefixes_) {
+                if (path.size() > prefix.first.size() && path.compare(0, prefix.first.size(), prefix.first) == 0) {
+                    return prefix.second(req);
+                }
+            }
+            // Tanmlanmam URL iin 404 Not Found hatas
+            return not_found_;
+        }
+
+        if (it->second.async_fn) {
+            return it->second.async_fn(req, std::function<responder()>(std::ref(make_responder)));
+        }
+        if (!it->second.cacheable) {
+            return it->second.fn(req);
+        }
+
+        if (auto cached = cache_.find(path)) {
+            return cached;
+        }
+        auto result = it->second.fn(req);
+        cache_.store(path, result);
+        return result;
+    }
+};
+
+// stek aamalarnn (accept, read, parse, handler, write) rneklemeli izlenmesi.
+// Her io thread'i kendi halka tamponuna yazar; /admin/trace hepsini Chrome about:tracing JSON'u olarak dker.
+namespace trace {
+
+using clock = std::chrono::steady_clock;
+
+const clock::time_point origin = clock::now();
+
+inline std::uint64_t now_ns() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - origin).count());
+}
+
+struct event {
+    const char* phase;
+    std::uint64_t request;
+    std::uint64_t start_ns;
+    std::uint64_t duration_ns;
+};
+
+// Tek bir thread'in son N olayn tutan halka tampon. Kilidi sadece
+// rneklenen olaylarda ve dkm srasnda alnr, pratikte hi ekime olmaz.
+class ring {
+private:
+    mutable std::mutex mutex_;
+    std::vector<event> events_;
+    std::size_t next_ = 0;
+    bool wrapped_ = false;
+    int tid_;
+
+public:
+    ring(int tid, std::size_t capacity)
+        : events_(capacity), tid_(tid) {
+    }
+
+    int tid() const {
+        return tid_;
+    }
+
+    void push(const event& e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_[next_] = e;
+        if (++next_ == events_.size()) {
+            next_ = 0;
+            wrapped_ = true;
+        }
+    }
+
+    void snapshot(std::vector<event>& out) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (wrapped_) {
+            out.insert(out.end(), events_.begin() + static_cast<std::ptrdiff_t>(next_), events_.end());
+        }
+        out.insert(out.end(), events_.begin(), events_.begin() + static_cast<std::ptrdiff_t>(next_));
+    }
+};
+
+class registry {
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<ring>> rings_;
+    std::atomic<unsigned> rate_{ 0 };
+    std::size_t capacity_ = 16384;
+
+public:
+    static registry& instance() {
+        static registry r;
+        return r;
+    }
+
+    // Her rate. istek rneklenir; 0 izlemeyi kapatr
+    void set_rate(unsigned every_nth) {
+        rate_.store(every_nth, std::memory_order_relaxed);
+    }
+
+    unsigned rate() const {
+        return rate_.load(std::memory_order_relaxed);
+    }
+
+    ring& local() {
+        thread_local std::shared_ptr<ring> mine = [this] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(std::make_shared<ring>(static_cast<int>(rings_.size()) + 1, capacity_));
+            return rings_.back();
+        }();
+        return *mine;
+    }
+
+    // Tm thread'lerin olaylarn Chrome trace-event JSON formatnda dndr
+    std::string dump_chrome_json() const {
+        std::vector<std::shared_ptr<ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings = rings_;
+        }
+
+        std::string out = R"({"displayTimeUnit":"ns","traceEvents":[)";
+        bool first = true;
+        char line[256];
+        std::vector<event> events;
+        for (auto const& r : rings) {
+            std::snprintf(line, sizeof(line),
+                R"(%s{"name":"thread_name","ph":"M","pid":1,"tid":%d,"args":{"name":"io-%d"}})",
+                first ? "" : ",", r->tid(), r->tid());
+            out += line;
+            first = false;
+
+            events.clear();
+            r->snapshot(events);
+            for (auto const& e : events) {
+                std::snprintf(line, sizeof(line),
+                    R"(,{"name":"%s","cat":"http","ph":"X","pid":1,"tid":%d,"ts":%.3f,"dur":%.3f,"args":{"request":%llu}})",
+                    e.phase, r->tid(), e.start_ns / 1000.0, e.duration_ns / 1000.0,
+                    static_cast<unsigned long long>(e.request));
+                out += line;
+            }
+        }
+        out += "]}";
+        return out;
+    }
+};
+
+// Bir istein izleme durumu; id 0 ise istek rneklenmemitir ve hibir zaman damgas alnmaz
+struct request_trace {
+    std::uint64_t id = 0;
+    bool begun = false;
+    std::uint64_t read_start = 0;
+    std::uint64_t read_end = 0;
+    std::uint64_t write_start = 0;
+
+    bool sampled() const {
+        return id != 0;
+    }
+
+    // rnekleme kararn ver; thread bana saya kullanld iin paylalan durum yoktur
+    static bool should_sample() {
+        unsigned const rate = registry::instance().rate();
+        if (rate == 0) {
+            return false;
+        }
+        thread_local std::uint64_t counter = 0;
+        return ++counter % rate == 0;
+    }
+
+    // start verilmezse istein balangc u an kabul edilir
+    void begin(std::uint64_t start = 0) {
+        thread_local std::uint64_t sequence = 0;
+        *this = {};
+        begun = true;
+        if (!should_sample()) {
+            return;
+        }
+        id = (static_cast<std::uint64_t>(registry::instance().local().tid()) << 40) | ++sequence;
+        read_start = start != 0 ? start : now_ns();
+        read_end = read_start;
+    }
+
+    void record(const char* phase, std::uint64_t start, std::uint64_t end) const {
+        if (sampled()) {
+            registry::instance().local().push({ phase, id, start, end - start });
+        }
+    }
+};
+
+} // namespace trace
+
+// JSON string deerini trnaklaryla birlikte kal olarak ekle
+inline void append_json_string(std::string& out, std::string_view s) {
+    out.push_back('"');
+    for (unsigned char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            }
+            else {
+                out.push_back(static_cast<char>(c));
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+// Dz bir JSON nesnesinin alanlarn DOM kurmadan srayla okuyan kk okuyucu.
+// Kullanm: while (r.next_key(key)) { if (key == "x") r.read_int(x); else r.skip_value(); } sonra r.ok().
+class json_object_reader {
+private:
+    std::string_view in_;
+    std::size_t pos_ = 0;
+    bool started_ = false;
+    bool done_ = false;
+    bool ok_ = true;
+
+    void skip_ws() {
+        while (pos_ < in_.size() && (in_[pos_] == ' ' || in_[pos_] == '\t' || in_[pos_] == '\n' || in_[pos_] == '\r')) {
+            ++pos_;
+        }
+    }
+
+    bool consume(char c) {
+        skip_ws();
+        if (pos_ < in_.size() && in_[pos_] == c) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool fail() {
+        ok_ = false;
+        return false;
+    }
+
+    static void append_utf8(std::string& out, std::uint32_t cp) {
+        if (cp < 0x80) {
+            out.push_back(static_cast<char>(cp));
+        }
+        else if (cp < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        }
+        else if (cp < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        }
+        else {
+            out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+        }
+    }
+
+    bool read_hex4(std::uint32_t& value) {
+        if (pos_ + 4 > in_.size()) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char const c = in_[pos_++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<std::uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<std::uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<std::uint32_t>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+public:
+    explicit json_object_reader(std::string_view in)
+        : in_(in) {
+    }
+
+    // Bir sonraki anahtar oku; nesne bittiyse (veya hata varsa) false dner
+    bool next_key(std::string& key) {
+        if (!ok_ || done_) {
+            return false;
+        }
+        if (!started_) {
+            started_ = true;
+            if (!consume('{')) {
+                return fail();
+            }
+            if (consume('}')) {
+                done_ = true;
+                return false;
+            }
+        }
+        else {
+            if (consume('}')) {
+                done_ = true;
+                return false;
+            }
+            if (!consume(',')) {
+                return fail();
+            }
+        }
+        if (!read_string(key) || !consume(':')) {
+            return fail();
+        }
+        return true;
+    }
+
+    bool read_string(std::string& out) {
+        out.clear();
+        if (!consume('"')) {
+            return fail();
+        }
+        while (pos_ < in_.size()) {
+            char const c = in_[pos_++];
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return fail();
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (pos_ >= in_.size()) {
+                break;
+            }
+            switch (in_[pos_++]) {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                std::uint32_t cp = 0;
+                if (!read_hex4(cp)) {
+                    return fail();
+                }
+                // UTF-16 vekil ifti
+                if (cp >= 0xd800 && cp <= 0xdbff) {
+                    std::uint32_t low = 0;
+                    if (pos_ + 2 > in_.size() || in_[pos_] != '\\' || in_[pos_ + 1] != 'u') {
+                        return fail();
+                    }
+                    pos_ += 2;
+                    if (!read_hex4(low) || low < 0xdc00 || low > 0xdfff) {
+                        return fail();
+                    }
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                return fail();
+            }
+        }
+        return fail();
+    }
+
+    // String dizisi; en fazla max eleman kabul edilir
+    bool read_string_array(std::vector<std::string>& out, std::size_t max) {
+        out.clear();
+        if (!consume('[')) {
+            return fail();
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (out.size() == max) {
+                return fail();
+            }
+            out.emplace_back();
+            if (!read_string(out.back())) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']') || fail();
+    }
+
+    // Tam say dizisi; en fazla max eleman kabul edilir
+    bool read_int_array(std::vector<std::int64_t>& out, std::size_t max) {
+        out.clear();
+        if (!consume('[')) {
+            return fail();
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            if (out.size() == max) {
+                return fail();
+            }
+            out.emplace_back();
+            if (!read_int(out.back())) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']') || fail();
+    }
+
+    // Dizinin elemanlarn zmeden ham metinleri olarak dndr (r. nesne dizisi; her eleman ayr okunur)
+    bool read_array_items(std::vector<std::string_view>& out) {
+        out.clear();
+        if (!consume('[')) {
+            return fail();
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            skip_ws();
+            std::size_t const start = pos_;
+            if (!skip_value()) {
+                return false;
+            }
+            out.push_back(in_.substr(start, pos_ - start));
+        } while (consume(','));
+        return consume(']') || fail();
+    }
+
+    // Nesne dizisi: her eleman kendi okuyucusuyla each(okuyucu)'ya verilir; en fazla max eleman
+    template <class Each>
+    bool read_object_array(std::size_t max, Each&& each) {
+        std::vector<std::string_view> items;
+        if (!read_array_items(items) || items.size() > max) {
+            return fail();
+        }
+        for (auto item : items) {
+            json_object_reader reader(item);
+            if (!each(reader)) {
+                return fail();
+            }
+        }
+        return true;
+    }
+
+    // Sadece tam say kabul edilir (kesirli/sl saylar hata saylr)
+    bool read_int(std::int64_t& out) {
+        skip_ws();
+        auto const* first = in_.data() + pos_;
+        auto const* last = in_.data() + in_.size();
+        auto const [ptr, ec] = std::from_chars(first, last, out);
+        if (ec != std::errc{} || (ptr != last && (*ptr == '.' || *ptr == 'e' || *ptr == 'E'))) {
+            return fail();
+        }
+        pos_ += static_cast<std::size_t>(ptr - first);
+        return true;
+    }
+
+    bool skip_value() {
+        skip_ws();
+        if (pos_ >= in_.size()) {
+            return fail();
+        }
+        if (in_[pos_] == '"') {
+            std::string ignored;
+            return read_string(ignored);
+        }
+        if (in_[pos_] == '{' || in_[pos_] == '[') {
+            int depth = 0;
+            while (pos_ < in_.size()) {
+                char const c = in_[pos_];
+                if (c == '"') {
+                    std::string ignored;
+                    if (!read_string(ignored)) {
+                        return false;
+                    }
+                    continue;
+                }
+                ++pos_;
+                if (c == '{' || c == '[') {
+                    ++depth;
+                }
+                else if ((c == '}' || c == ']') && --depth == 0) {
+                    return true;
+                }
+            }
+            return fail();
+        }
+        std::size_t const start = pos_;
+        while (pos_ < in_.size() && std::strchr("+-.0123456789eEtruefalsn", in_[pos_]) != nullptr) {
+            ++pos_;
+        }
+        return pos_ != start || fail();
+    }
+
+    // Nesnenin tamam hatasz okunduysa ve sonrasnda sadece boluk varsa true
+    bool ok() {
+        skip_ws();
+        return ok_ && done_ && pos_ == in_.size();
+    }
+};
+
+// Gvde biimleri: JSON'a ek olarak sk arlan route'lar (skor gnderimi vb.) iin kompakt ikili
+// kodlamalar. stek biimi Content-Type'tan, cevap biimi Accept'ten seilir; varsaylan JSON'dur.
+enum class body_format { json, msgpack, cbor };
+
+inline const char* content_type_of(body_format format) {
+    switch (format) {
+    case body_format::msgpack: return "application/msgpack";
+    case body_format::cbor: return "application/cbor";
+    default: return "application/json";
+    }
+}
+
+// Medya tr ad (parametreler ve boluklar hari, byk/kk harf duyarsz); tannmyorsa false
+inline bool parse_media_type(std::string_view media, body_format& format) {
+    media = media.substr(0, media.find(';'));
+    while (!media.empty() && media.front() == ' ') {
+        media.remove_prefix(1);
+    }
+    while (!media.empty() && media.back() == ' ') {
+        media.remove_suffix(1);
+    }
+    auto const is = [media](std::string_view name) {
+        return media.size() == name.size() && std::equal(media.begin(), media.end(), name.begin(),
+            [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+    };
+    if (is("application/msgpack") || is("application/x-msgpack") || is("application/vnd.msgpack")) {
+        format = body_format::msgpack;
+    }
+    else if (is("application/cbor")) {
+        format = body_format::cbor;
+    }
+    else if (is("application/json") || is("*/*") || is("application/*")) {
+        format = body_format::json;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+// stek gvdesinin biimi; Content-Type yoksa veya tannmyorsa eskisi gibi JSON kabul edilir
+inline body_format request_format(const api_request& req) {
+    body_format format = body_format::json;
+    auto const type = req[http::field::content_type];
+    parse_media_type(std::string_view(type.data(), type.size()), format);
+    return format;
+}
+
+// Cevap biimi: Accept listesindeki ilk tannan tr (q deerleri dikkate alnmaz)
+inline body_format response_format(const api_request& req) {
+    auto const header = req[http::field::accept];
+    std::string_view accept(header.data(), header.size());
+    while (!accept.empty()) {
+        auto const comma = accept.find(',');
+        body_format format;
+        if (parse_media_type(accept.substr(0, comma), format)) {
+            return format;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        accept.remove_prefix(comma + 1);
+    }
+    return body_format::json;
+}
+
+// kili kodlamadaki bir enin bal
+struct binary_item {
+    enum kind_type { integer, string, array, map, other } kind = other;
+    std::int64_t value = 0;
+    // string/other: bayt, array: eleman, map: anahtar-deer ifti says
+    std::uint64_t length = 0;
+};
+
+// Byk endian n baytlk iaretsiz say
+inline bool read_big_endian(std::string_view in, std::size_t& pos, std::size_t n, std::uint64_t& out) {
+    if (in.size() - pos < n) {
+        return false;
+    }
+    out = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        out = (out << 8) | static_cast<unsigned char>(in[pos++]);
+    }
+    return true;
+}
+
+inline void append_big_endian(std::string& out, std::uint64_t value, std::size_t n) {
+    for (std::size_t i = n; i-- > 0;) {
+        out.push_back(static_cast<char>(value >> (i * 8)));
+    }
+}
+
+// MessagePack e balklar. nil, bool, float, bin ve ext "other" saylr ve sadece atlanabilir.
+struct msgpack_codec {
+    static bool read_head(std::string_view in, std::size_t& pos, binary_item& item) {
+        if (pos >= in.size()) {
+            return false;
+        }
+        unsigned const b = static_cast<unsigned char>(in[pos++]);
+        item = {};
+        std::uint64_t n = 0;
+        if (b <= 0x7f || b >= 0xe0) {
+            item.kind = binary_item::integer;
+            item.value = b <= 0x7f ? static_cast<std::int64_t>(b) : static_cast<std::int64_t>(b) - 0x100;
+            return true;
+        }
+        if (b <= 0xbf) {
+            item.kind = b <= 0x8f ? binary_item::map : b <= 0x9f ? binary_item::array : binary_item::string;
+            item.length = b <= 0x9f ? (b & 0x0f) : (b & 0x1f);
+            return true;
+        }
+        switch (b) {
+        case 0xc0: case 0xc2: case 0xc3:
+            return true;
+        case 0xc4: case 0xc5: case 0xc6:
+            return read_big_endian(in, pos, std::size_t{ 1 } << (b - 0xc4), item.length);
+        case 0xc7: case 0xc8: case 0xc9:
+            if (!read_big_endian(in, pos, std::size_t{ 1 } << (b - 0xc7), n)) {
+                return false;
+            }
+            item.length = n + 1;
+            return true;
+        case 0xca: case 0xcb:
+            item.length = b == 0xca ? 4 : 8;
+            return true;
+        case 0xcc: case 0xcd: case 0xce: case 0xcf:
+            if (!read_big_endian(in, pos, std::size_t{ 1 } << (b - 0xcc), n) || n > static_cast<std::uint64_t>(INT64_MAX)) {
+                return false;
+            }
+            item.kind = binary_item::integer;
+            item.value = static_cast<std::int64_t>(n);
+            return true;
+        case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+            unsigned const bits = 8u << (b - 0xd0);
+            if (!read_big_endian(in, pos, bits / 8, n)) {
+                return false;
+            }
+            item.kind = binary_item::integer;
+            item.value = static_cast<std::int64_t>(n << (64 - bits)) >> (64 - bits);
+            return true;
+        }
+        case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:
+            item.length = 1 + (std::uint64_t{ 1 } << (b - 0xd4));
+            return true;
+        case 0xd9: case 0xda: case 0xdb:
+            item.kind = binary_item::string;
+            return read_big_endian(in, pos, std::size_t{ 1 } << (b - 0xd9), item.length);
+        case 0xdc: case 0xdd:
+            item.kind = binary_item::array;
+            return read_big_endian(in, pos, b == 0xdc ? 2 : 4, item.length);
+        case 0xde: case 0xdf:
+            item.kind = binary_item::map;
+            return read_big_endian(in, pos, b == 0xde ? 2 : 4, item.length);
+        default:
+            return false;
+        }
+    }
+
+    static void write_length(std::string& out, unsigned fix, unsigned fix_max, unsigned wide, std::uint64_t n) {
+        if (n <= fix_max) {
+            out.push_back(static_cast<char>(fix | n));
+        }
+        else if (n <= 0xffff) {
+            out.push_back(static_cast<char>(wide));
+            append_big_endian(out, n, 2);
+        }
+        else {
+            out.push_back(static_cast<char>(wide + 1));
+            append_big_endian(out, n, 4);
+        }
+    }
+
+    static void write_map(std::string& out, std::size_t n) {
+        write_length(out, 0x80, 0x0f, 0xde, n);
+    }
+
+    static void write_array(std::string& out, std::size_t n) {
+        write_length(out, 0x90, 0x0f, 0xdc, n);
+    }
+
+    static void write_string(std::string& out, std::string_view s) {
+        if (s.size() > 0x1f && s.size() <= 0xff) {
+            out.push_back(static_cast<char>(0xd9));
+            out.push_back(static_cast<char>(s.size()));
+        }
+        else {
+            write_length(out, 0xa0, 0x1f, 0xda, s.size());
+        }
+        out.append(s.data(), s.size());
+    }
+
+    static void write_int(std::string& out, std::int64_t v) {
+        if (v >= -32 && v <= 0x7f) {
+            out.push_back(static_cast<char>(v));
+            return;
+        }
+        unsigned code;
+        std::size_t bytes;
+        if (v >= 0) {
+            bytes = v <= 0xff ? 1 : v <= 0xffff ? 2 : v <= 0xffffffffLL ? 4 : 8;
+            code = 0xcc;
+        }
+        else {
+            bytes = v >= INT8_MIN ? 1 : v >= INT16_MIN ? 2 : v >= INT32_MIN ? 4 : 8;
+            code = 0xd0;
+        }
+        code += bytes == 1 ? 0 : bytes == 2 ? 1 : bytes == 4 ? 2 : 3;
+        out.push_back(static_cast<char>(code));
+        append_big_endian(out, static_cast<std::uint64_t>(v), bytes);
+    }
+
+    static void write_bool(std::string& out, bool b) {
+        out.push_back(static_cast<char>(b ? 0xc3 : 0xc2));
+    }
+};
+
+// CBOR (RFC 8949) e balklar. Etiketler atlanr; belirsiz uzunluklu eler desteklenmez.
+struct cbor_codec {
+    static bool read_head(std::string_view in, std::size_t& pos, binary_item& item) {
+        for (;;) {
+            if (pos >= in.size()) {
+                return false;
+            }
+            unsigned const b = static_cast<unsigned char>(in[pos++]);
+            unsigned const info = b & 0x1f;
+            std::uint64_t arg = info;
+            if (info >= 24 && (info > 27 || !read_big_endian(in, pos, std::size_t{ 1 } << (info - 24), arg))) {
+                return false;
+            }
+            item = {};
+            switch (b >> 5) {
+            case 0: case 1:
+                if (arg > static_cast<std::uint64_t>(INT64_MAX)) {
+                    return false;
+                }
+                item.kind = binary_item::integer;
+                item.value = (b >> 5) == 0 ? static_cast<std::int64_t>(arg) : -1 - static_cast<std::int64_t>(arg);
+                return true;
+            case 2:
+                item.length = arg;
+                return true;
+            case 3:
+                item.kind = binary_item::string;
+                item.length = arg;
+                return true;
+            case 4:
+                item.kind = binary_item::array;
+                item.length = arg;
+                return true;
+            case 5:
+                item.kind = binary_item::map;
+                item.length = arg;
+                return true;
+            case 6:
+                continue;
+            default:
+                // Basit deerler ve kayan noktal saylar: deer balkla birlikte okundu
+                return true;
+            }
+        }
+    }
+
+    static void write_head(std::string& out, unsigned major, std::uint64_t arg) {
+        if (arg < 24) {
+            out.push_back(static_cast<char>((major << 5) | arg));
+            return;
+        }
+        std::size_t const bytes = arg <= 0xff ? 1 : arg <= 0xffff ? 2 : arg <= 0xffffffffULL ? 4 : 8;
+        out.push_back(static_cast<char>((major << 5) | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27)));
+        append_big_endian(out, arg, bytes);
+    }
+
+    static void write_map(std::string& out, std::size_t n) {
+        write_head(out, 5, n);
+    }
+
+    static void write_array(std::string& out, std::size_t n) {
+        write_head(out, 4, n);
+    }
+
+    static void write_string(std::string& out, std::string_view s) {
+        write_head(out, 3, s.size());
+        out.append(s.data(), s.size());
+    }
+
+    static void write_int(std::string& out, std::int64_t v) {
+        if (v >= 0) {
+            write_head(out, 0, static_cast<std::uint64_t>(v));
+        }
+        else {
+            write_head(out, 1, ~static_cast<std::uint64_t>(v));
+        }
+    }
+
+    static void write_bool(std::string& out, bool b) {
+        out.push_back(static_cast<char>(b ? 0xf5 : 0xf4));
+    }
+};
+
+// kili kodlanm bir nesneyi (map) DOM kurmadan okuyan, json_object_reader ile ayn arayzdeki okuyucu;
+// bylece ayn ayrtrma kodu her biimden dorudan tipli struct'lara okur.
+template <class Codec>
+class binary_object_reader {
+private:
+    //  ie elerde atlama derinlii snr (kt niyetli girdide yn tamasn)
+    static constexpr int max_depth = 32;
+
+    std::string_view in_;
+    std::size_t pos_ = 0;
+    std::uint64_t remaining_ = 0;
+    bool started_ = false;
+    bool ok_ = true;
+
+    bool fail() {
+        ok_ = false;
+        return false;
+    }
+
+    bool head(binary_item& item, binary_item::kind_type kind) {
+        return (Codec::read_head(in_, pos_, item) && item.kind == kind) || fail();
+    }
+
+    bool skip(int depth) {
+        binary_item item;
+        if (depth > max_depth || !Codec::read_head(in_, pos_, item)) {
+            return fail();
+        }
+        switch (item.kind) {
+        case binary_item::string:
+        case binary_item::other:
+            if (item.length > in_.size() - pos_) {
+                return fail();
+            }
+            pos_ += static_cast<std::size_t>(item.length);
+            return true;
+        case binary_item::array:
+        case binary_item::map: {
+            std::uint64_t const count = item.kind == binary_item::map ? item.length * 2 : item.length;
+            if (count > in_.size() - pos_) {
+                return fail();
+            }
+            for (std::uint64_t i = 0; i < count; ++i) {
+                if (!skip(depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            return true;
+        }
+    }
+
+public:
+    explicit binary_object_reader(std::string_view in)
+        : in_(in) {
+    }
+
+    bool next_key(std::string& key) {
+        if (!ok_) {
+            return false;
+        }
+        if (!started_) {
+            started_ = true;
+            binary_item item;
+            if (!head(item, binary_item::map)) {
+                return false;
+            }
+            remaining_ = item.length;
+        }
+        if (remaining_ == 0) {
+            return false;
+        }
+        --remaining_;
+        return read_string(key);
+    }
+
+    bool read_string(std::string& out) {
+        binary_item item;
+        if (!head(item, binary_item::string) || item.length > in_.size() - pos_) {
+            return fail();
+        }
+        out.assign(in_.data() + pos_, static_cast<std::size_t>(item.length));
+        pos_ += out.size();
+        return true;
+    }
+
+    bool read_int(std::int64_t& out) {
+        binary_item item;
+        if (!head(item, binary_item::integer)) {
+            return false;
+        }
+        out = item.value;
+        return true;
+    }
+
+    bool read_string_array(std::vector<std::string>& out, std::size_t max) {
+        out.clear();
+        binary_item item;
+        if (!head(item, binary_item::array) || item.length > max) {
+            return fail();
+        }
+        out.resize(static_cast<std::size_t>(item.length));
+        for (auto& s : out) {
+            if (!read_string(s)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool read_int_array(std::vector<std::int64_t>& out, std::size_t max) {
+        out.clear();
+        binary_item item;
+        if (!head(item, binary_item::array) || item.length > max) {
+            return fail();
+        }
+        out.resize(static_cast<std::size_t>(item.length));
+        for (auto& v : out) {
+            if (!read_int(v)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <class Each>
+    bool read_object_array(std::size_t max, Each&& each) {
+        binary_item item;
+        if (!head(item, binary_item::array) || item.length > max) {
+            return fail();
+        }
+        for (std::uint64_t i = 0; i < item.length; ++i) {
+            std::size_t const start = pos_;
+            if (!skip(1)) {
+                return false;
+            }
+            binary_object_reader reader(in_.substr(start, pos_ - start));
+            if (!each(reader)) {
+                return fail();
+            }
+        }
+        return true;
+    }
+
+    bool skip_value() {
+        return skip(0);
+    }
+
+    bool ok() const {
+        return ok_ && started_ && remaining_ == 0 && pos_ == in_.size();
+    }
+};
+
+using msgpack_reader = binary_object_reader<msgpack_codec>;
+using cbor_reader = binary_object_reader<cbor_codec>;
+
+// Gvdeyi istein biimine gre dorudan out'a oku; T::read(reader) her biim iin ayn koddur
+template <class T>
+bool decode_body(const api_request& req, T& out) {
+    switch (request_format(req)) {
+    case body_format::msgpack: {
+        msgpack_reader reader(req.body());
+        return out.read(reader);
+    }
+    case body_format::cbor: {
+        cbor_reader reader(req.body());
+        return out.read(reader);
+    }
+    default: {
+        json_object_reader reader(req.body());
+        return out.read(reader);
+    }
+    }
+}
+
+// Cevap gvdesini seilen biimde yazar; handler'lar biimden bamszdr. kili biimler uzunluu
+// ne yazd iin nesne ve dizilerin eleman says batan verilir.
+class body_writer {
+private:
+    body_format format_;
+    std::string out_;
+    // JSON: ak nesne/dizilerin kapan karakterleri
+    std::string closers_;
+    bool need_comma_ = false;
+    bool after_key_ = false;
+
+    // JSON: deerden nce gereken ayra
+    void separate() {
+        if (after_key_) {
+            after_key_ = false;
+        }
+        else if (need_comma_) {
+            out_ += ", ";
+        }
+    }
+
+public:
+    explicit body_writer(body_format format)
+        : format_(format) {
+    }
+
+    void begin_object(std::size_t fields) {
+        switch (format_) {
+        case body_format::msgpack: return msgpack_codec::write_map(out_, fields);
+        case body_format::cbor: return cbor_codec::write_map(out_, fields);
+        default:
+            separate();
+            out_.push_back('{');
+            closers_.push_back('}');
+            need_comma_ = false;
+        }
+    }
+
+    void begin_array(std::size_t items) {
+        switch (format_) {
+        case body_format::msgpack: return msgpack_codec::write_array(out_, items);
+        case body_format::cbor: return cbor_codec::write_array(out_, items);
+        default:
+            separate();
+            out_.push_back('[');
+            closers_.push_back(']');
+            need_comma_ = false;
+        }
+    }
+
+    // Son alan nesneyi veya diziyi kapat
+    void end() {
+        if (format_ == body_format::json) {
+            out_.push_back(closers_.back());
+            closers_.pop_back();
+            need_comma_ = true;
+        }
+    }
+
+    void key(std::string_view name) {
+        string_value(name);
+        if (format_ == body_format::json) {
+            out_ += ": ";
+            after_key_ = true;
+        }
+    }
+
+    void string_value(std::string_view s) {
+        switch (format_) {
+        case body_format::msgpack: return msgpack_codec::write_string(out_, s);
+        case body_format::cbor: return cbor_codec::write_string(out_, s);
+        default:
+            separate();
+            append_json_string(out_, s);
+            need_comma_ = true;
+        }
+    }
+
+    void int_value(std::int64_t v) {
+        switch (format_) {
+        case body_format::msgpack: return msgpack_codec::write_int(out_, v);
+        case body_format::cbor: return cbor_codec::write_int(out_, v);
+        default:
+            separate();
+            out_ += std::to_string(v);
+            need_comma_ = true;
+        }
+    }
+
+    void bool_value(bool b) {
+        switch (format_) {
+        case body_format::msgpack: return msgpack_codec::write_bool(out_, b);
+        case body_format::cbor: return cbor_codec::write_bool(out_, b);
+        default:
+            separate();
+            out_ += b ? "true" : "false";
+            need_comma_ = true;
+        }
+    }
+
+    std::string take() {
+        return std::move(out_);
+    }
+
+    route_ptr result(http::status status = http::status::ok) {
+        return make_result(status, content_type_of(format_), std::move(out_));
+    }
+};
+
+// {"status": "error", "message": ...} cevab istenen biimde
+inline route_ptr error_result(body_format format, http::status status, std::string_view message) {
+    body_writer writer(format);
+    writer.begin_object(2);
+    writer.key("status");
+    writer.string_value("error");
+    writer.key("message");
+    writer.string_value(message);
+    writer.end();
+    return writer.result(status);
+}
+
+// Hedef URL'nin sorgu ksmndan bir parametreyi oku (yzde kodlamas zlmez)
+inline std::string_view query_param(std::string_view target, std::string_view name) {
+    auto const q = target.find('?');
+    if (q == std::string_view::npos) {
+        return {};
+    }
+    std::string_view rest = target.substr(q + 1);
+    while (!rest.empty()) {
+        auto const amp = rest.find('&');
+        std::string_view const pair = rest.substr(0, amp);
+        auto const eq = pair.find('=');
+        if (pair.substr(0, eq) == name) {
+            return eq == std::string_view::npos ? std::string_view{} : pair.substr(eq + 1);
+        }
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        rest.remove_prefix(amp + 1);
+    }
+    return {};
+}
+
+// URL yzde kodlamasn z ('+' boluk saylmaz); geersiz kodlamada false
+inline bool percent_decode(std::string_view in, std::string& out) {
+    out.clear();
+    out.reserve(in.size());
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        if (in[i] != '%') {
+            out.push_back(in[i]);
+            continue;
+        }
+        unsigned value = 0;
+        if (i + 2 >= in.size() || std::from_chars(in.data() + i + 1, in.data() + i + 3, value, 16).ptr != in.data() + i + 3) {
+            return false;
+        }
+        out.push_back(static_cast<char>(value));
+        i += 2;
+    }
+    return true;
+}
+
+// Dosyay diske zorla yaz (fsync)
+inline bool sync_file(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#if defined(_WIN32)
+    return _commit(_fileno(file)) == 0;
+#else
+    return ::fsync(fileno(file)) == 0;
+#endif
+}
+
+// rename sonras dizin girdisinin de kalc olmas iin dizini fsync et
+inline void sync_directory(const std::filesystem::path& dir) {
+#if !defined(_WIN32)
+    int const fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    boost::ignore_unused(dir);
+#endif
+}
+
+inline std::uint32_t crc32(const void* data, std::size_t n) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, n);
+    return crc.checksum();
+}
+
+// SHA-256 (FIPS 180-4). Oyun srmleri ve yamalar ierikleriyle adreslenir; istemci de ayn zeti hesaplar.
+class sha256 {
+public:
+    using digest = std::array<unsigned char, 32>;
+
+private:
+    std::array<std::uint32_t, 8> state_ = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    unsigned char block_[64] = {};
+    std::size_t used_ = 0;
+    std::uint64_t length_ = 0;
+
+    static std::uint32_t rotr(std::uint32_t x, int n) {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    void compress(const unsigned char* p) {
+        static constexpr std::uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+        std::uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = std::uint32_t(p[4 * i]) << 24 | std::uint32_t(p[4 * i + 1]) << 16 | std::uint32_t(p[4 * i + 2]) << 8 | p[4 * i + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            std::uint32_t const s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            std::uint32_t const s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        std::uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+        std::uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+        for (int i = 0; i < 64; ++i) {
+            std::uint32_t const t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            std::uint32_t const t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state_[0] += a;
+        state_[1] += b;
+        state_[2] += c;
+        state_[3] += d;
+        state_[4] += e;
+        state_[5] += f;
+        state_[6] += g;
+        state_[7] += h;
+    }
+
+public:
+    void update(const void* data, std::size_t n) {
+        auto const* p = static_cast<const unsigned char*>(data);
+        length_ += n;
+        if (used_ != 0) {
+            std::size_t const take = std::min(n, sizeof(block_) - used_);
+            std::memcpy(block_ + used_, p, take);
+            used_ += take;
+            p += take;
+            n -= take;
+            if (used_ < sizeof(block_)) {
+                return;
+            }
+            compress(block_);
+            used_ = 0;
+        }
+        for (; n >= sizeof(block_); p += sizeof(block_), n -= sizeof(block_)) {
+            compress(p);
+        }
+        std::memcpy(block_, p, n);
+        used_ = n;
+    }
+
+    digest finish() {
+        std::uint64_t const bits = length_ * 8;
+        unsigned char pad[72] = { 0x80 };
+        std::size_t const pad_size = (used_ < 56 ? 56 - used_ : 120 - used_);
+        for (int i = 0; i < 8; ++i) {
+            pad[pad_size + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+        }
+        update(pad, pad_size + 8);
+        digest out;
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                out[4 * i + j] = static_cast<unsigned char>(state_[i] >> (24 - 8 * j));
+            }
+        }
+        return out;
+    }
+};
+
+inline std::string to_hex(const unsigned char* data, std::size_t n) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out(n * 2, '0');
+    for (std::size_t i = 0; i < n; ++i) {
+        out[2 * i] = digits[data[i] >> 4];
+        out[2 * i + 1] = digits[data[i] & 15];
+    }
+    return out;
+}
+
+// 64 karakterlik kk harf onaltlk SHA-256 zeti mi
+inline bool is_sha256_hex(std::string_view text) {
+    return text.size() == 64 && text.find_first_not_of("0123456789abcdef") == std::string_view::npos;
+}
+
+// Byk dosyalar sabit boyutlu bloklarla okuyup kayt kayt ayrtrmak iin tampon
+class chunked_reader {
+private:
+    std::FILE* file_;
+    std::vector<char> buffer_;
+    std::size_t begin_ = 0;
+    std::size_t end_ = 0;
+    std::uint64_t offset_ = 0;
+
+public:
+    explicit chunked_reader(std::FILE* file, std::size_t block = 8 * 1024 * 1024)
+        : file_(file), buffer_(block) {
+    }
+
+    // n bayt kesintisiz olarak tampondaysa onu gsteren iareti, dosya bittiyse nullptr
+    const char* peek(std::size_t n) {
+        if (end_ - begin_ < n) {
+            std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+            if (buffer_.size() < n) {
+                buffer_.resize(n);
+            }
+            end_ += std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+            if (end_ < n) {
+                return nullptr;
+            }
+        }
+        return buffer_.data() + begin_;
+    }
+
+    void consume(std::size_t n) {
+        begin_ += n;
+        offset_ += n;
+    }
+
+    // u ana kadar tketilen bayt says (son geerli kaydn sonu)
+    std::uint64_t offset() const {
+        return offset_;
+    }
+};
+
+// Bir skor deiikliinin log kayd: [crc32][isim uzunluu u16][skor i64][zaman i64][isim].
+// Saylar makinenin bayt srasyla (x86/ARM: little-endian) yazlr.
+struct score_record {
+    std::string player;
+    std::int64_t score = 0;
+    std::int64_t time = 0;
+
+    static constexpr std::size_t header_size = 4 + 2 + 8 + 8;
+    static constexpr std::size_t max_player = 64;
+
+    void encode(std::string& out) const {
+        std::size_t const start = out.size();
+        out.resize(start + header_size);
+        char* p = out.data() + start;
+        std::uint16_t const length = static_cast<std::uint16_t>(player.size());
+        std::memcpy(p + 4, &length, 2);
+        std::memcpy(p + 6, &score, 8);
+        std::memcpy(p + 14, &time, 8);
+        out += player;
+        std::uint32_t const crc = crc32(out.data() + start + 4, out.size() - start - 4);
+        std::memcpy(out.data() + start, &crc, 4);
+    }
+
+    // Yarm kalm veya bozuk kaytta false dner
+    bool decode(chunked_reader& in) {
+        const char* p = in.peek(header_size);
+        if (p == nullptr) {
+            return false;
+        }
+        std::uint32_t crc;
+        std::uint16_t length;
+        std::memcpy(&crc, p, 4);
+        std::memcpy(&length, p + 4, 2);
+        if (length == 0 || length > max_player) {
+            return false;
+        }
+        p = in.peek(header_size + length);
+        if (p == nullptr || crc32(p + 4, header_size - 4 + length) != crc) {
+            return false;
+        }
+        std::memcpy(&score, p + 6, 8);
+        std::memcpy(&time, p + 14, 8);
+        player.assign(p + header_size, length);
+        in.consume(header_size + length);
+        return true;
+    }
+};
+
+// Oyuncu adnn 64 bitlik hash'i (FNV-1a + son kartrma)
+inline std::uint64_t player_hash(std::string_view name) {
+    std::uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : name) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+// ok sreli (paral) kurulumda bu srecin pay: oyuncu hash'i % count == index olan oyuncular
+struct shard_placement {
+    std::size_t index = 0;
+    std::size_t count = 1;
+
+    static std::size_t owner(std::string_view player, std::size_t count) {
+        return static_cast<std::size_t>(player_hash(player) % count);
+    }
+
+    bool owns(std::string_view player) const {
+        return count <= 1 || owner(player, count) == index;
+    }
+};
+
+// Sra istatistikli B+ aac.  dmler her ocuun eleman saysn tutar; bylece ekleme,
+// silme, bir anahtarn sras ve k. eleman O(log n)'dir. Yapraklar ift ynl baldr,
+// k. elemandan balayan N eleman yaprak zincirinde O(log n + N) ile gezilir.
+// Silmede dmler birletirilmez, sadece boalan dm kaldrlr.
+class rank_tree {
+public:
+    using key = std::pair<std::int64_t, std::uint32_t>;
+
+private:
+    static constexpr std::uint16_t fanout = 64;
+    // Toplu kurulumda dmler 3/4 doldurulur, sonraki eklemeler hemen blnmeye yol amasn
+    static constexpr std::uint16_t bulk_fill = fanout * 3 / 4;
+
+    struct node {
+        bool leaf;
+        std::uint16_t n = 0;
+        key keys[fanout];  // yaprakta elemanlar, i dmde ocuklarn alt snrlar
+
+        explicit node(bool is_leaf) : leaf(is_leaf) {
+        }
+    };
+
+    struct leaf_node : node {
+        leaf_node* prev = nullptr;
+        leaf_node* next = nullptr;
+
+        leaf_node() : node(true) {
+        }
+    };
+
+    struct inner_node : node {
+        node* child[fanout];
+        std::uint32_t count[fanout];
+
+        inner_node() : node(false) {
+        }
+    };
+
+    node* root_ = nullptr;
+    leaf_node* first_ = nullptr;
+    std::size_t size_ = 0;
+
+    static void destroy(node* x) {
+        if (x->leaf) {
+            delete static_cast<leaf_node*>(x);
+            return;
+        }
+        auto* in = static_cast<inner_node*>(x);
+        for (std::uint16_t i = 0; i < in->n; ++i) {
+            destroy(in->child[i]);
+        }
+        delete in;
+    }
+
+    static std::uint32_t subtree_count(const node* x) {
+        if (x->leaf) {
+            return x->n;
+        }
+        auto const* in = static_cast<const inner_node*>(x);
+        std::uint32_t total = 0;
+        for (std::uint16_t i = 0; i < in->n; ++i) {
+            total += in->count[i];
+        }
+        return total;
+    }
+
+    // k'nn bulunduu (veya eklenecei) ocuk: alt snr k'dan byk olmayan son ocuk
+    static std::uint16_t child_index(const inner_node* in, const key& k) {
+        return static_cast<std::uint16_t>(std::upper_bound(in->keys + 1, in->keys + in->n, k) - in->keys - 1);
+    }
+
+    static std::uint16_t leaf_index(const node* x, const key& k) {
+        return static_cast<std::uint16_t>(std::lower_bound(x->keys, x->keys + x->n, k) - x->keys);
+    }
+
+    // Dolu yapra ikiye bl, yeni sa yapra dndr
+    leaf_node* split_leaf(leaf_node* left) {
+        auto* right = new leaf_node();
+        std::uint16_t const half = fanout / 2;
+        std::copy(left->keys + half, left->keys + left->n, right->keys);
+        right->n = static_cast<std::uint16_t>(left->n - half);
+        left->n = half;
+        right->prev = left;
+        right->next = left->next;
+        if (left->next != nullptr) {
+            left->next->prev = right;
+        }
+        left->next = right;
+        return right;
+    }
+
+    static inner_node* split_inner(inner_node* left) {
+        auto* right = new inner_node();
+        std::uint16_t const half = fanout / 2;
+        right->n = static_cast<std::uint16_t>(left->n - half);
+        std::copy(left->keys + half, left->keys + left->n, right->keys);
+        std::copy(left->child + half, left->child + left->n, right->child);
+        std::copy(left->count + half, left->count + left->n, right->count);
+        left->n = half;
+        return right;
+    }
+
+    // x'e k'y ekle; x blndyse yeni sa kardeini dndr
+    node* insert_into(node* x, const key& k) {
+        if (x->leaf) {
+            auto* target = static_cast<leaf_node*>(x);
+            leaf_node* right = nullptr;
+            std::uint16_t pos = leaf_index(target, k);
+            if (target->n == fanout) {
+                right = split_leaf(target);
+                if (pos > target->n) {
+                    pos = static_cast<std::uint16_t>(pos - target->n);
+                    target = right;
+                }
+            }
+            std::copy_backward(target->keys + pos, target->keys + target->n, target->keys + target->n + 1);
+            target->keys[pos] = k;
+            ++target->n;
+            return right;
+        }
+
+        auto* in = static_cast<inner_node*>(x);
+        std::uint16_t const i = child_index(in, k);
+        node* const grown = insert_into(in->child[i], k);
+        if (grown == nullptr) {
+            ++in->count[i];
+            return nullptr;
+        }
+
+        in->count[i] = subtree_count(in->child[i]);
+        inner_node* target = in;
+        inner_node* right = nullptr;
+        std::uint16_t pos = static_cast<std::uint16_t>(i + 1);
+        if (in->n == fanout) {
+            right = split_inner(in);
+            if (pos > in->n) {
+                pos = static_cast<std::uint16_t>(pos - in->n);
+                target = right;
+            }
+        }
+        std::copy_backward(target->keys + pos, target->keys + target->n, target->keys + target->n + 1);
+        std::copy_backward(target->child + pos, target->child + target->n, target->child + target->n + 1);
+        std::copy_backward(target->count + pos, target->count + target->n, target->count + target->n + 1);
+        target->keys[pos] = grown->keys[0];
+        target->child[pos] = grown;
+        target->count[pos] = subtree_count(grown);
+        ++target->n;
+        return right;
+    }
+
+    // [first, last) sral anahtarlarnn x'in alt aacndaki sralar (base: x'ten nceki eleman says)
+    static void rank_sorted(const node* x, std::size_t base, const key* first, const key* last, std::size_t* out) {
+        if (x->leaf) {
+            std::uint16_t i = 0;
+            for (; first != last; ++first, ++out) {
+                while (i < x->n && x->keys[i] < *first) {
+                    ++i;
+                }
+                *out = base + i;
+            }
+            return;
+        }
+        auto const* in = static_cast<const inner_node*>(x);
+        for (std::uint16_t c = 0; c < in->n && first != last; ++c) {
+            const key* const end = c + 1 < in->n ? std::lower_bound(first, last, in->keys[c + 1]) : last;
+            if (end != first) {
+                rank_sorted(in->child[c], base, first, end, out);
+                out += end - first;
+                first = end;
+            }
+            base += in->count[c];
+        }
+    }
+
+    // x'ten k'y sil; x boaldysa silinir ve true dner (st dm onu listesinden karr)
+    bool erase_from(node* x, const key& k) {
+        if (x->leaf) {
+            auto* lf = static_cast<leaf_node*>(x);
+            std::uint16_t const pos = leaf_index(lf, k);
+            std::copy(lf->keys + pos + 1, lf->keys + lf->n, lf->keys + pos);
+            --lf->n;
+            if (lf->n > 0) {
+                return false;
+            }
+            if (lf->prev != nullptr) {
+                lf->prev->next = lf->next;
+            }
+            else {
+                first_ = lf->next;
+            }
+            if (lf->next != nullptr) {
+                lf->next->prev = lf->prev;
+            }
+            delete lf;
+            return true;
+        }
+
+        auto* in = static_cast<inner_node*>(x);
+        std::uint16_t const i = child_index(in, k);
+        --in->count[i];
+        if (!erase_from(in->child[i], k)) {
+            return false;
+        }
+        std::copy(in->keys + i + 1, in->keys + in->n, in->keys + i);
+        std::copy(in->child + i + 1, in->child + in->n, in->child + i);
+        std::copy(in->count + i + 1, in->count + in->n, in->count + i);
+        --in->n;
+        if (in->n > 0) {
+            return false;
+        }
+        delete in;
+        return true;
+    }
+
+public:
+    rank_tree() = default;
+    rank_tree(const rank_tree&) = delete;
+    rank_tree& operator=(const rank_tree&) = delete;
+
+    ~rank_tree() {
+        clear();
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    void clear() {
+        if (root_ != nullptr) {
+            destroy(root_);
+        }
+        root_ = nullptr;
+        first_ = nullptr;
+        size_ = 0;
+    }
+
+    // Anahtar aata olmamaldr
+    void insert(const key& k) {
+        if (root_ == nullptr) {
+            first_ = new leaf_node();
+            root_ = first_;
+        }
+        if (node* right = insert_into(root_, k)) {
+            auto* top = new inner_node();
+            top->n = 2;
+            top->keys[0] = root_->keys[0];
+            top->child[0] = root_;
+            top->count[0] = subtree_count(root_);
+            top->keys[1] = right->keys[0];
+            top->child[1] = right;
+            top->count[1] = subtree_count(right);
+            root_ = top;
+        }
+        ++size_;
+    }
+
+    // Anahtar aata olmaldr
+    void erase(const key& k) {
+        if (erase_from(root_, k)) {
+            root_ = nullptr;
+            first_ = nullptr;
+        }
+        // Tek ocuklu kkleri kaldrarak ykseklii azalt
+        while (root_ != nullptr && !root_->leaf && root_->n == 1) {
+            auto* in = static_cast<inner_node*>(root_);
+            root_ = in->child[0];
+            delete in;
+        }
+        --size_;
+    }
+
+    // k'dan kk eleman says (0 tabanl sra)
+    std::size_t rank(const key& k) const {
+        std::size_t r = 0;
+        const node* x = root_;
+        if (x == nullptr) {
+            return 0;
+        }
+        while (!x->leaf) {
+            auto const* in = static_cast<const inner_node*>(x);
+            std::uint16_t const i = child_index(in, k);
+            for (std::uint16_t j = 0; j < i; ++j) {
+                r += in->count[j];
+            }
+            x = in->child[i];
+        }
+        return r + leaf_index(x, k);
+    }
+
+    // Sral anahtar listesinin sralar tek bir inite: her dm en fazla bir kez ziyaret edilir,
+    // m anahtar iin maliyet m ayr aramadan (m log n) deil, dolalan dm saysndan ibarettir
+    void rank_sorted(const std::vector<key>& sorted, std::vector<std::size_t>& ranks) const {
+        ranks.assign(sorted.size(), 0);
+        if (root_ != nullptr && !sorted.empty()) {
+            rank_sorted(root_, 0, sorted.data(), sorted.data() + sorted.size(), ranks.data());
+        }
+    }
+
+    // position. elemandan balayarak en fazla n eleman srayla fn'e ver
+    template <class Fn>
+    void visit(std::size_t position, std::size_t n, Fn&& fn) const {
+        if (position >= size_ || n == 0) {
+            return;
+        }
+        const node* x = root_;
+        while (!x->leaf) {
+            auto const* in = static_cast<const inner_node*>(x);
+            std::uint16_t i = 0;
+            while (position >= in->count[i]) {
+                position -= in->count[i];
+                ++i;
+            }
+            x = in->child[i];
+        }
+        auto const* lf = static_cast<const leaf_node*>(x);
+        for (std::size_t i = position; lf != nullptr && n > 0; lf = lf->next, i = 0) {
+            for (; i < lf->n && n > 0; ++i, --n) {
+                fn(lf->keys[i]);
+            }
+        }
+    }
+
+    // Sral ve tekrarsz anahtarlardan aac dorusal zamanda kur
+    void assign_sorted(const std::vector<key>& sorted) {
+        clear();
+        if (sorted.empty()) {
+            return;
+        }
+        std::vector<node*> level;
+        leaf_node* last = nullptr;
+        for (std::size_t i = 0; i < sorted.size(); i += bulk_fill) {
+            auto* lf = new leaf_node();
+            lf->n = static_cast<std::uint16_t>(std::min<std::size_t>(bulk_fill, sorted.size() - i));
+            std::copy(sorted.begin() + i, sorted.begin() + i + lf->n, lf->keys);
+            lf->prev = last;
+            if (last != nullptr) {
+                last->next = lf;
+            }
+            else {
+                first_ = lf;
+            }
+            last = lf;
+            level.push_back(lf);
+        }
+        while (level.size() > 1) {
+            std::vector<node*> parents;
+            parents.reserve(level.size() / bulk_fill + 1);
+            for (std::size_t i = 0; i < level.size(); i += bulk_fill) {
+                auto* in = new inner_node();
+                in->n = static_cast<std::uint16_t>(std::min<std::size_t>(bulk_fill, level.size() - i));
+                for (std::uint16_t j = 0; j < in->n; ++j) {
+                    in->child[j] = level[i + j];
+                    in->keys[j] = level[i + j]->keys[0];
+                    in->count[j] = subtree_count(level[i + j]);
+                }
+                parents.push_back(in);
+            }
+            level.swap(parents);
+        }
+        root_ = level.front();
+        size_ = sorted.size();
+    }
+};
+
+// Bir skor tablosu (thread-safe deildir; score_store'un kilidi altnda kullanlr).
+// Oyuncu kaytlar copy-on-write sayfalarda tutulur: snapshot sayfalarn iaretilerini
+// dondurur, yazarlar dondurulmu bir sayfay deitirmeden nce kopyalar.
+class leaderboard {
+public:
+    struct entry {
+        std::string player;
+        std::int64_t score;
+    };
+
+    // 0 tabanl srasyla birlikte bir oyuncu
+    struct ranked_entry {
+        std::string player;
+        std::int64_t score;
+        std::size_t rank;
+    };
+
+    static constexpr std::size_t page_size = 4096;
+
+    struct page {
+        std::vector<entry> slots;
+    };
+
+    struct frozen {
+        std::vector<std::shared_ptr<const page>> pages;
+        std::size_t count = 0;
+    };
+
+private:
+    static constexpr std::uint32_t no_slot = 0xffffffff;
+
+    std::vector<std::shared_ptr<page>> pages_;
+    std::size_t count_ = 0;
+    // Oyuncu ad -> slot: ak adresli hash tablosu, her hcre (hash'in st 32 biti, slot + 1).
+    // simler tabloda tekrar saklanmaz, eleme sayfadaki kaytla dorulanr.
+    std::vector<std::uint64_t> index_;
+    // (-skor, slot): yksek skor nce, eitlikte skoru nce alan nde
+    rank_tree ranking_;
+
+    page& writable_page(std::size_t index) {
+        auto& p = pages_[index];
+        if (p.use_count() > 1) {
+            p = std::make_shared<page>(*p);
+        }
+        return *p;
+    }
+
+    const entry& at(std::uint32_t slot) const {
+        return pages_[slot / page_size]->slots[slot % page_size];
+    }
+
+    std::uint32_t find_slot(std::string_view player) const {
+        if (index_.empty()) {
+            return no_slot;
+        }
+        std::uint64_t const h = player_hash(player);
+        std::size_t const mask = index_.size() - 1;
+        for (std::size_t i = h & mask;; i = (i + 1) & mask) {
+            std::uint64_t const cell = index_[i];
+            if (cell == 0) {
+                return no_slot;
+            }
+            std::uint32_t const slot = static_cast<std::uint32_t>(cell) - 1;
+            if ((cell >> 32) == (h >> 32) && at(slot).player == player) {
+                return slot;
+            }
+        }
+    }
+
+    void index_slot(std::uint64_t h, std::uint32_t slot) {
+        std::size_t const mask = index_.size() - 1;
+        std::size_t i = h & mask;
+        while (index_[i] != 0) {
+            i = (i + 1) & mask;
+        }
+        index_[i] = ((h >> 32) << 32) | (std::uint64_t(slot) + 1);
+    }
+
+    // Doluluk oran 1/2'nin altnda kalacak ekilde yeniden boyutlandr
+    void reserve_index(std::size_t players) {
+        std::size_t capacity = 16;
+        while (capacity < players * 2) {
+            capacity *= 2;
+        }
+        if (capacity <= index_.size()) {
+            return;
+        }
+        index_.assign(capacity, 0);
+        for (std::uint32_t slot = 0; slot < count_; ++slot) {
+            index_slot(player_hash(at(slot).player), slot);
+        }
+    }
+
+public:
+    std::size_t size() const {
+        return count_;
+    }
+
+    // Skor oyuncunun en iyisinden yksekse kabul edilir; best her durumda gncel en iyi skordur
+    bool submit(const std::string& player, std::int64_t score, std::int64_t& best) {
+        std::uint32_t const found = find_slot(player);
+        if (found != no_slot) {
+            std::uint32_t const slot = found;
+            entry& e = writable_page(slot / page_size).slots[slot % page_size];
+            if (score <= e.score) {
+                best = e.score;
+                return false;
+            }
+            ranking_.erase({ -e.score, slot });
+            e.score = score;
+            ranking_.insert({ -score, slot });
+            best = score;
+            return true;
+        }
+
+        std::uint32_t const slot = static_cast<std::uint32_t>(count_);
+        if (count_ % page_size == 0) {
+            pages_.push_back(std::make_shared<page>());
+            pages_.back()->slots.reserve(page_size);
+        }
+        writable_page(count_ / page_size).slots.push_back({ player, score });
+        ++count_;
+        reserve_index(count_);
+        index_slot(player_hash(player), slot);
+        ranking_.insert({ -score, slot });
+        best = score;
+        return true;
+    }
+
+    // first. sradan (0 tabanl) balayan en fazla n oyuncu
+    std::vector<entry> range(std::size_t first, std::size_t n) const {
+        std::vector<entry> result;
+        result.reserve(std::min(n, count_));
+        ranking_.visit(first, n, [&](const rank_tree::key& k) { result.push_back(at(k.second)); });
+        return result;
+    }
+
+    std::vector<entry> top(std::size_t k) const {
+        return range(0, k);
+    }
+
+    // Oyuncunun stndeki ve altndaki radius oyuncu (kendisi dahil): O(log n + radius)
+    bool around(std::string_view player, std::size_t radius, std::vector<ranked_entry>& out) const {
+        out.clear();
+        std::uint32_t const slot = find_slot(player);
+        if (slot == no_slot) {
+            return false;
+        }
+        std::size_t const rank = ranking_.rank({ -at(slot).score, slot });
+        std::size_t position = rank > radius ? rank - radius : 0;
+        out.reserve(rank - position + radius + 1);
+        ranking_.visit(position, rank - position + radius + 1, [&](const rank_tree::key& k) {
+            auto const& e = at(k.second);
+            out.push_back({ e.player, e.score, position++ });
+            });
+        return true;
+    }
+
+    // Oyuncu alt kmesinin (r. arkada listesi) sralar, sraya gre dizili. Oyuncular slot'laryla
+    // anahtara evrilip sralanr, aa tek geite dolalr. Tabloda olmayanlar ve tekrarlar atlanr.
+    std::vector<ranked_entry> ranks_of(const std::vector<std::string>& players) const {
+        std::vector<rank_tree::key> keys;
+        keys.reserve(players.size());
+        for (auto const& player : players) {
+            std::uint32_t const slot = find_slot(player);
+            if (slot != no_slot) {
+                keys.push_back({ -at(slot).score, slot });
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        std::vector<std::size_t> ranks;
+        ranking_.rank_sorted(keys, ranks);
+        std::vector<ranked_entry> result;
+        result.reserve(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            auto const& e = at(keys[i].second);
+            result.push_back({ e.player, e.score, ranks[i] });
+        }
+        return result;
+    }
+
+    // Her skor iin bu skordan kesin yksek skoru olan oyuncu says (girdi srasyla), tek aa geiiyle
+    std::vector<std::size_t> count_above(const std::vector<std::int64_t>& scores) const {
+        std::vector<std::pair<rank_tree::key, std::size_t>> order;
+        order.reserve(scores.size());
+        for (std::size_t i = 0; i < scores.size(); ++i) {
+            order.push_back({ { -scores[i], 0 }, i });
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<rank_tree::key> keys;
+        keys.reserve(order.size());
+        for (auto const& o : order) {
+            keys.push_back(o.first);
+        }
+        std::vector<std::size_t> ranks;
+        ranking_.rank_sorted(keys, ranks);
+        std::vector<std::size_t> counts(scores.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            counts[order[i].second] = ranks[i];
+        }
+        return counts;
+    }
+
+    // Oyuncunun 0 tabanl sras ve skoru; oyuncu bu tabloda yoksa false
+    bool rank_of(std::string_view player, std::size_t& rank, std::int64_t& score) const {
+        std::uint32_t const slot = find_slot(player);
+        if (slot == no_slot) {
+            return false;
+        }
+        score = at(slot).score;
+        rank = ranking_.rank({ -score, slot });
+        return true;
+    }
+
+    // O(sayfa says): sadece sayfa iaretileri kopyalanr
+    frozen freeze() const {
+        frozen view;
+        view.pages.assign(pages_.begin(), pages_.end());
+        view.count = count_;
+        return view;
+    }
+
+    // Kurtarma iin toplu ykleme: sralama indeksi, isim indeksiyle paralel olarak
+    // tek bir sort ile kurulur ve sral girdiden dorusal zamanda doldurulur
+    void bulk_load(std::vector<entry>&& entries) {
+        pages_.clear();
+        index_.clear();
+        ranking_.clear();
+        count_ = 0;
+
+        std::vector<rank_tree::key> order;
+        order.reserve(entries.size());
+        for (auto& e : entries) {
+            if (count_ % page_size == 0) {
+                pages_.push_back(std::make_shared<page>());
+                pages_.back()->slots.reserve(page_size);
+            }
+            order.emplace_back(-e.score, static_cast<std::uint32_t>(count_));
+            pages_.back()->slots.push_back(std::move(e));
+            ++count_;
+        }
+        entries = {};
+
+        std::thread ranking_builder([this, &order] {
+            std::sort(order.begin(), order.end());
+            ranking_.assign_sorted(order);
+        });
+        reserve_index(count_);
+        ranking_builder.join();
+    }
+};
+
+// Skor tablolarnn zaman pencereleri
+enum class score_window : std::uint8_t {
+    all_time = 0,
+    daily = 1,
+    weekly = 2,
+};
+
+inline const char* window_name(score_window window) {
+    return window == score_window::daily ? "daily" : window == score_window::weekly ? "weekly" : "all";
+}
+
+inline bool parse_window(std::string_view name, score_window& window) {
+    if (name.empty() || name == "all") {
+        window = score_window::all_time;
+    }
+    else if (name == "daily") {
+        window = score_window::daily;
+    }
+    else if (name == "weekly") {
+        window = score_window::weekly;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+// Zaman pencereli skor tablosu: son N dnemin tablolar bir halkada (ring) tutulur ve
+// p. dnem (p mod N). kovaya der. Dnem geii O(1)'dir: kovadaki eski dnemin tablosu
+// bo bir tabloyla deitirilir ve silinmek zere arana verilir, hibir ey yeniden kurulmaz.
+class windowed_board {
+public:
+    struct bucket {
+        std::int64_t period = -1;
+        std::unique_ptr<leaderboard> board;
+    };
+
+private:
+    std::int64_t length_;  // dnem uzunluu (saniye)
+    std::int64_t origin_;  // dnem snrlarnn Unix zaman 0'a gre kaymas
+    std::vector<bucket> ring_;
+    std::int64_t newest_ = std::numeric_limits<std::int64_t>::min();
+
+    std::size_t index_of(std::int64_t period) const {
+        std::int64_t const n = static_cast<std::int64_t>(ring_.size());
+        return static_cast<std::size_t>((period % n + n) % n);
+    }
+
+public:
+    windowed_board(std::int64_t length, std::int64_t origin, std::size_t history)
+        : length_(length), origin_(origin), ring_(history) {
+    }
+
+    std::int64_t period_of(std::int64_t time) const {
+        std::int64_t const t = time - origin_;
+        return t >= 0 ? t / length_ : (t - length_ + 1) / length_;
+    }
+
+    // Dnemin tablosu; dnem halkadan dmse nullptr. Kova daha eski bir dneme aitse
+    // yeni dnem iin boaltlr ve eski tablo retired'a eklenir.
+    leaderboard* board_for(std::int64_t period, std::vector<std::unique_ptr<leaderboard>>& retired) {
+        bucket& b = ring_[index_of(period)];
+        if (b.period == period) {
+            return b.board.get();
+        }
+        if (b.period > period || period + static_cast<std::int64_t>(ring_.size()) <= newest_) {
+            return nullptr;
+        }
+        newest_ = std::max(newest_, period);
+        if (b.board) {
+            retired.push_back(std::move(b.board));
+        }
+        b.period = period;
+        b.board = std::make_unique<leaderboard>();
+        return b.board.get();
+    }
+
+    // Sadece okuma: dnemin tablosu yoksa nullptr
+    const leaderboard* find(std::int64_t period) const {
+        const bucket& b = ring_[index_of(period)];
+        return b.period == period ? b.board.get() : nullptr;
+    }
+
+    const std::vector<bucket>& buckets() const {
+        return ring_;
+    }
+};
+
+// Kabul edilen skor deiikliklerinin yazld ekleme-only log. Kaytlar bellekte birikir;
+// tek bir yazc thread birikeni tek write + tek fsync ile yazar (group commit) ve bekleyenleri
+// (kalclk callback'lerini) arr.
+// Her snapshot yeni bir log neslini (generation) balatr: scores-<nesil>.log
+class score_log {
+private:
+    struct chunk {
+        std::uint64_t generation;
+        std::string bytes;
+    };
+
+    std::filesystem::path dir_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::deque<chunk> pending_;
+    std::uint64_t generation_ = 0;
+    std::uint64_t appended_ = 0;
+    std::uint64_t durable_ = 0;
+    bool failed_ = false;
+    bool stopping_ = false;
+    std::thread writer_;
+    // (sra no, callback): sra no kalc olunca (veya yazma baarsz olunca) arlr
+    std::deque<std::pair<std::uint64_t, std::function<void(bool)>>> waiters_;
+
+    std::FILE* file_ = nullptr;
+    std::uint64_t file_generation_ = 0;
+
+public:
+    static std::filesystem::path path_for(const std::filesystem::path& dir, std::uint64_t generation) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "scores-%08llu.log", static_cast<unsigned long long>(generation));
+        return dir / name;
+    }
+
+    // Dizindeki log nesillerini artan srada dndr
+    static std::vector<std::uint64_t> list_generations(const std::filesystem::path& dir) {
+        std::vector<std::uint64_t> generations;
+        std::error_code ec;
+        for (auto it = std::filesystem::directory_iterator(dir, ec); !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+            auto const name = it->path().filename().string();
+            if (name.size() == 19 && name.compare(0, 7, "scores-") == 0 && name.compare(15, 4, ".log") == 0) {
+                generations.push_back(std::strtoull(name.c_str() + 7, nullptr, 10));
+            }
+        }
+        std::sort(generations.begin(), generations.end());
+        return generations;
+    }
+
+    ~score_log() {
+        stop();
+    }
+
+    void start(const std::filesystem::path& dir, std::uint64_t generation) {
+        dir_ = dir;
+        generation_ = generation;
+        writer_ = std::thread([this] { run(); });
+    }
+
+    // nceden kodlanm kaytlar ekle, dnen sra no'yu on_durable'a ver. aran, kaytlarn
+    // uygulanma srasyla ayn srada eklenmesi iin score_store kilidini tutar.
+    std::uint64_t append(std::string_view encoded) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.empty() || pending_.back().generation != generation_) {
+            pending_.push_back({ generation_, {} });
+        }
+        pending_.back().bytes.append(encoded.data(), encoded.size());
+        work_cv_.notify_one();
+        return ++appended_;
+    }
+
+    // sequence kalc olduunda done(true), log yazlamyorsa done(false) yazc thread'inde arlr
+    void on_durable(std::uint64_t sequence, std::function<void(bool)> done) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (durable_ < sequence && !failed_) {
+                waiters_.emplace_back(sequence, std::move(done));
+                return;
+            }
+        }
+        done(!failed_);
+    }
+
+    // Yeni nesle ge; dnen nesilden nceki kaytlarn hepsi eski nesillerdedir
+    std::uint64_t rotate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ++generation_;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_one();
+        if (writer_.joinable()) {
+            writer_.join();
+        }
+        if (file_ != nullptr) {
+            sync_file(file_);
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+private:
+    bool write_chunk(const chunk& c) {
+        if (file_ == nullptr || c.generation != file_generation_) {
+            if (file_ != nullptr) {
+                sync_file(file_);
+                std::fclose(file_);
+            }
+            file_ = std::fopen(path_for(dir_, c.generation).string().c_str(), "ab");
+            file_generation_ = c.generation;
+            if (file_ == nullptr) {
+                return false;
+            }
+        }
+        return std::fwrite(c.bytes.data(), 1, c.bytes.size(), file_) == c.bytes.size();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            work_cv_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+            if (pending_.empty()) {
+                break;
+            }
+            std::deque<chunk> batch;
+            batch.swap(pending_);
+            std::uint64_t const target = appended_;
+            lock.unlock();
+
+            bool ok = true;
+            for (auto const& c : batch) {
+                ok = ok && write_chunk(c);
+            }
+            ok = ok && sync_file(file_);
+
+            lock.lock();
+            if (ok) {
+                durable_ = target;
+            }
+            else {
+                std::cerr << "Skor logu yazilamadi: " << path_for(dir_, file_generation_).string() << "\n";
+                failed_ = true;
+            }
+            std::vector<std::function<void(bool)>> done;
+            while (!waiters_.empty() && (failed_ || waiters_.front().first <= durable_)) {
+                done.push_back(std::move(waiters_.front().second));
+                waiters_.pop_front();
+            }
+            lock.unlock();
+            for (auto& fn : done) {
+                fn(ok);
+            }
+            lock.lock();
+        }
+    }
+};
+
+// Skor tablolarnn kalc hali: bellekteki tablolar (tm zamanlar, gnlk, haftalk) + group commit'li log
+// + arka planda periyodik snapshot. Snapshot yazarlar durdurmaz: kilit altnda sadece sayfa iaretileri
+// dondurulur ve log nesli deitirilir. Kurtarma: snapshot yklenir, ardndan snapshot'n nesli ve
+// sonrasndaki loglar srayla yeniden oynatlr; log kaytlarndaki zaman pencereli tablolarn dnemini belirler.
+//
+// Gnderimler toplu ilenir: her io thread'i gnderimi kendi tamponuna ekler ve beklemeden dner;
+// tek bir uygulayc thread tm tamponlar toplar, topluluu tek kilit altnda tablolara uygular ve
+// log'a tek para olarak ekler. Log fsync edildiinde topluluktaki tm istekler birlikte cevaplanr.
+class score_store {
+public:
+    struct submit_result {
+        bool durable;
+        bool accepted;
+        std::int64_t best;
+    };
+
+    using submit_callback = std::function<void(const submit_result&)>;
+
+private:
+    // Bir kilit almnda uygulanan en fazla gnderim; okuyucular bekletme sresini snrlar
+    static constexpr std::size_t max_batch = 4096;
+
+    struct pending_submit {
+        std::string player;
+        std::int64_t score;
+        submit_callback done;
+    };
+
+    // Bir io thread'inin gnderim tamponu. Kilidi sadece sahibi ve toplama srasnda uygulayc alr.
+    struct ingest_buffer {
+        std::mutex mutex;
+        std::vector<pending_submit> items;
+    };
+
+    static constexpr char snapshot_magic[4] = { 'N', 'R', 'L', 'B' };
+    static constexpr std::uint32_t snapshot_version = 2;
+
+    // Bir snapshot blm: pencere, dnem ve dondurulmu tablo
+    struct section {
+        score_window window;
+        std::int64_t period;
+        leaderboard::frozen view;
+    };
+
+    std::filesystem::path dir_;
+    mutable std::shared_mutex mutex_;
+    leaderboard board_;
+    // Gnler UTC gece yarsnda, haftalar Pazartesi 00:00 UTC'de (Unix zaman 0 Perembedir) balar
+    windowed_board daily_{ 86400, 0, 8 };
+    windowed_board weekly_{ 7 * 86400, 4 * 86400, 5 };
+    // Dnemi gemi tablolar; silme maliyeti istek yolunda deil snapshot thread'inde denir
+    std::vector<std::unique_ptr<leaderboard>> retired_;
+    score_log log_;
+
+    std::mutex ingest_mutex_;
+    std::condition_variable ingest_cv_;
+    std::vector<std::shared_ptr<ingest_buffer>> buffers_;
+    // Tamponlardaki gnderim says; ekleme ile sayma arasndaki yarta ksa sre eksiye debilir
+    std::atomic<std::int64_t> queued_{ 0 };
+    bool ingest_stopping_ = false;
+    std::thread applier_;
+
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_cv_;
+    std::thread snapshotter_;
+    bool stopping_ = false;
+    std::uint64_t snapshot_sequence_ = 0;
+    std::atomic<std::uint64_t> accepted_{ 0 };
+
+    std::filesystem::path snapshot_path() const {
+        return dir_ / "leaderboard.snap";
+    }
+
+    windowed_board* windowed(score_window window) {
+        return window == score_window::daily ? &daily_ : window == score_window::weekly ? &weekly_ : nullptr;
+    }
+
+    const windowed_board* windowed(score_window window) const {
+        return window == score_window::daily ? &daily_ : window == score_window::weekly ? &weekly_ : nullptr;
+    }
+
+    // Kilit altnda arlr; dnemin henz tablosu yoksa veya dnem halkadan dtyse nullptr
+    const leaderboard* find_board(score_window window, std::int64_t ago) const {
+        const windowed_board* w = windowed(window);
+        if (w == nullptr) {
+            return &board_;
+        }
+        return w->find(w->period_of(static_cast<std::int64_t>(std::time(nullptr))) - ago);
+    }
+    // Skoru tm zamanlar tablosuna ve zamann dt dnem tablolarna uygula (kilit altnda).
+    // Herhangi bir tabloda iyileme varsa true; best tm zamanlarn en iyisidir.
+    bool apply(const std::string& player, std::int64_t score, std::int64_t time, std::int64_t& best) {
+        bool changed = board_.submit(player, score, best);
+        for (windowed_board* w : { &daily_, &weekly_ }) {
+            if (leaderboard* board = w->board_for(w->period_of(time), retired_)) {
+                std::int64_t ignored;
+                changed = board->submit(player, score, ignored) || changed;
+            }
+        }
+        return changed;
+    }
+
+    // count kayd okuyup entries'e ekle
+    static bool read_records(chunked_reader& in, boost::crc_32_type& crc, std::uint64_t count, std::vector<leaderboard::entry>& entries) {
+        entries.reserve(static_cast<std::size_t>(count));
+        for (std::uint64_t i = 0; i < count; ++i) {
+            const char* p = in.peek(10);
+            std::uint16_t length = 0;
+            if (p != nullptr) {
+                std::memcpy(&length, p, 2);
+                p = in.peek(10 + length);
+            }
+            if (p == nullptr) {
+                return false;
+            }
+            crc.process_bytes(p, 10 + length);
+            std::int64_t score;
+            std::memcpy(&score, p + 2, 8);
+            entries.push_back({ std::string(p + 10, length), score });
+            in.consume(10 + length);
+        }
+        return true;
+    }
+
+    static bool write_records(std::FILE* file, boost::crc_32_type& crc, const leaderboard::frozen& view) {
+        std::string record;
+        std::size_t remaining = view.count;
+        for (auto const& p : view.pages) {
+            for (std::size_t i = 0; i < p->slots.size() && remaining > 0; ++i, --remaining) {
+                auto const& e = p->slots[i];
+                std::uint16_t const length = static_cast<std::uint16_t>(e.player.size());
+                record.resize(10);
+                std::memcpy(record.data(), &length, 2);
+                std::memcpy(record.data() + 2, &e.score, 8);
+                record += e.player;
+                crc.process_bytes(record.data(), record.size());
+                if (std::fwrite(record.data(), 1, record.size(), file) != record.size()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Snapshot' ykle; dnen deer yeniden oynatlacak ilk log neslidir.
+    // Biim: [balk: sihir, srm, nesil, oyuncu says][tm zamanlar kaytlar]
+    //        (srm 2+) [blm says u32]{[pencere u8][dnem i64][kayt says u64][kaytlar]}* [crc32]
+    bool load_snapshot(std::uint64_t& generation) {
+        generation = 0;
+        std::FILE* file = std::fopen(snapshot_path().string().c_str(), "rb");
+        if (file == nullptr) {
+            return true;
+        }
+        chunked_reader in(file);
+        bool ok = false;
+        std::vector<leaderboard::entry> entries;
+        std::vector<std::pair<section, std::vector<leaderboard::entry>>> windows;
+        if (const char* h = in.peek(24); h != nullptr && std::memcmp(h, snapshot_magic, 4) == 0) {
+            std::uint32_t version;
+            std::uint64_t count;
+            std::memcpy(&version, h + 4, 4);
+            std::memcpy(&generation, h + 8, 8);
+            std::memcpy(&count, h + 16, 8);
+            in.consume(24);
+
+            boost::crc_32_type crc;
+            ok = (version == 1 || version == snapshot_version) && read_records(in, crc, count, entries);
+
+            std::uint32_t sections = 0;
+            if (ok && version >= 2) {
+                const char* s = in.peek(4);
+                ok = s != nullptr;
+                if (ok) {
+                    crc.process_bytes(s, 4);
+                    std::memcpy(&sections, s, 4);
+                    in.consume(4);
+                }
+            }
+            for (std::uint32_t i = 0; ok && i < sections; ++i) {
+                const char* s = in.peek(17);
+                ok = s != nullptr && (s[0] == static_cast<char>(score_window::daily) || s[0] == static_cast<char>(score_window::weekly));
+                if (!ok) {
+                    break;
+                }
+                crc.process_bytes(s, 17);
+                section sec{ static_cast<score_window>(s[0]), 0, {} };
+                std::memcpy(&sec.period, s + 1, 8);
+                std::memcpy(&count, s + 9, 8);
+                in.consume(17);
+                windows.emplace_back(std::move(sec), std::vector<leaderboard::entry>());
+                ok = read_records(in, crc, count, windows.back().second);
+            }
+
+            const char* t = ok ? in.peek(4) : nullptr;
+            std::uint32_t stored = 0;
+            if (t != nullptr) {
+                std::memcpy(&stored, t, 4);
+            }
+            ok = t != nullptr && stored == crc.checksum();
+        }
+        std::fclose(file);
+        if (!ok) {
+            std::cerr << "Skor snapshot'i bozuk: " << snapshot_path().string() << "\n";
+            return false;
+        }
+        board_.bulk_load(std::move(entries));
+        for (auto& w : windows) {
+            if (leaderboard* board = windowed(w.first.window)->board_for(w.first.period, retired_)) {
+                board->bulk_load(std::move(w.second));
+            }
+        }
+        retired_.clear();
+        return true;
+    }
+
+    // Bir log dosyasn yeniden oynat; bozuk/yarm kuyruk kesilir
+    void replay_log(std::uint64_t generation) {
+        auto const path = score_log::path_for(dir_, generation);
+        std::FILE* file = std::fopen(path.string().c_str(), "rb");
+        if (file == nullptr) {
+            return;
+        }
+        chunked_reader in(file, 1024 * 1024);
+        score_record record;
+        std::int64_t best;
+        while (record.decode(in)) {
+            apply(record.player, record.score, record.time, best);
+        }
+        std::fclose(file);
+
+        std::error_code ec;
+        if (in.offset() < std::filesystem::file_size(path, ec) && !ec) {
+            std::cerr << path.string() << ": " << in.offset() << ". bayttan sonrasi yarim kalmis, kesiliyor\n";
+            std::filesystem::resize_file(path, in.offset(), ec);
+        }
+    }
+
+    bool write_snapshot() {
+        leaderboard::frozen view;
+        std::vector<section> sections;
+        std::uint64_t generation;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            view = board_.freeze();
+            for (score_window window : { score_window::daily, score_window::weekly }) {
+                for (auto const& b : windowed(window)->buckets()) {
+                    if (b.board) {
+                        sections.push_back({ window, b.period, b.board->freeze() });
+                    }
+                }
+            }
+            generation = log_.rotate();
+        }
+
+        auto const tmp = dir_ / "leaderboard.snap.tmp";
+        std::FILE* file = std::fopen(tmp.string().c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::vector<char> buffer(4 * 1024 * 1024);
+        std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+        char header[24];
+        std::uint64_t const count = view.count;
+        std::memcpy(header, snapshot_magic, 4);
+        std::memcpy(header + 4, &snapshot_version, 4);
+        std::memcpy(header + 8, &generation, 8);
+        std::memcpy(header + 16, &count, 8);
+        bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+        boost::crc_32_type crc;
+        ok = ok && write_records(file, crc, view);
+
+        std::uint32_t const section_count = static_cast<std::uint32_t>(sections.size());
+        crc.process_bytes(&section_count, 4);
+        ok = ok && std::fwrite(&section_count, 1, 4, file) == 4;
+        for (auto const& sec : sections) {
+            char head[17];
+            std::uint64_t const records = sec.view.count;
+            head[0] = static_cast<char>(sec.window);
+            std::memcpy(head + 1, &sec.period, 8);
+            std::memcpy(head + 9, &records, 8);
+            crc.process_bytes(head, sizeof(head));
+            ok = ok && std::fwrite(head, 1, sizeof(head), file) == sizeof(head);
+            ok = ok && write_records(file, crc, sec.view);
+        }
+        std::uint32_t const checksum = crc.checksum();
+        ok = ok && std::fwrite(&checksum, 1, 4, file) == 4;
+        ok = sync_file(file) && ok;
+        std::fclose(file);
+
+        std::error_code ec;
+        if (ok) {
+            std::filesystem::rename(tmp, snapshot_path(), ec);
+            ok = !ec;
+        }
+        if (!ok) {
+            std::cerr << "Skor snapshot'i yazilamadi: " << tmp.string() << "\n";
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        sync_directory(dir_);
+
+        // Snapshot'n kapsad eski log nesilleri artk gereksiz
+        for (std::uint64_t old : score_log::list_generations(dir_)) {
+            if (old < generation) {
+                std::filesystem::remove(score_log::path_for(dir_, old), ec);
+            }
+        }
+        return true;
+    }
+
+    // aran thread'in tamponu; ilk arda kaydedilir
+    ingest_buffer& local_buffer() {
+        thread_local std::pair<score_store*, std::shared_ptr<ingest_buffer>> local;
+        if (local.first != this) {
+            local = { this, std::make_shared<ingest_buffer>() };
+            std::lock_guard<std::mutex> lock(ingest_mutex_);
+            buffers_.push_back(local.second);
+        }
+        return *local.second;
+    }
+
+    // Tamponlar boalt; bekleyen gnderim yoksa ve durdurulduysa false
+    bool collect(std::vector<pending_submit>& batch) {
+        std::vector<std::shared_ptr<ingest_buffer>> buffers;
+        {
+            std::unique_lock<std::mutex> lock(ingest_mutex_);
+            ingest_cv_.wait(lock, [&] { return queued_.load() > 0 || ingest_stopping_; });
+            if (queued_.load() <= 0) {
+                return false;
+            }
+            buffers = buffers_;
+        }
+        for (auto const& buffer : buffers) {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            if (batch.empty()) {
+                batch.swap(buffer->items);
+            }
+            else {
+                std::move(buffer->items.begin(), buffer->items.end(), std::back_inserter(batch));
+                buffer->items.clear();
+            }
+        }
+        queued_.fetch_sub(static_cast<std::int64_t>(batch.size()));
+        return true;
+    }
+
+    // Topluluu tablolara uygula, kabul edilenleri log'a tek para ekle; cevaplar log kalc olunca verilir
+    void apply_batch(std::vector<pending_submit>& batch) {
+        std::int64_t const now = static_cast<std::int64_t>(std::time(nullptr));
+        std::string encoded;
+        for (std::size_t begin = 0; begin < batch.size(); begin += max_batch) {
+            std::size_t const end = std::min(batch.size(), begin + max_batch);
+            auto accepted = std::make_shared<std::vector<std::pair<submit_result, submit_callback>>>();
+            std::vector<std::pair<submit_result, submit_callback>> rejected;
+            std::uint64_t sequence = 0;
+            encoded.clear();
+            {
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                for (std::size_t i = begin; i < end; ++i) {
+                    auto& item = batch[i];
+                    submit_result result{ true, false, 0 };
+                    result.accepted = apply(item.player, item.score, now, result.best);
+                    if (!result.accepted) {
+                        rejected.emplace_back(result, std::move(item.done));
+                        continue;
+                    }
+                    score_record{ std::move(item.player), item.score, now }.encode(encoded);
+                    accepted->emplace_back(result, std::move(item.done));
+                }
+                if (!accepted->empty()) {
+                    sequence = log_.append(encoded);
+                }
+            }
+            // Deiiklik yapmayan gnderimlerin log'u beklemesine gerek yok
+            for (auto& r : rejected) {
+                r.second(r.first);
+            }
+            if (accepted->empty()) {
+                continue;
+            }
+            accepted_.fetch_add(accepted->size(), std::memory_order_relaxed);
+            log_.on_durable(sequence, [accepted](bool durable) {
+                for (auto& r : *accepted) {
+                    r.first.durable = durable;
+                    r.second(r.first);
+                }
+                });
+        }
+        batch.clear();
+    }
+
+    void apply_loop() {
+        std::vector<pending_submit> batch;
+        while (collect(batch)) {
+            apply_batch(batch);
+        }
+    }
+
+    void snapshot_loop(std::chrono::seconds interval) {
+        std::unique_lock<std::mutex> lock(snapshot_mutex_);
+        while (!stopping_) {
+            snapshot_cv_.wait_for(lock, interval, [&] { return stopping_; });
+            if (stopping_) {
+                break;
+            }
+            std::vector<std::unique_ptr<leaderboard>> retired;
+            {
+                std::unique_lock<std::shared_mutex> board_lock(mutex_);
+                retired.swap(retired_);
+            }
+            retired.clear();
+            // Son snapshot'tan beri deiiklik yoksa yazma
+            std::uint64_t const accepted = accepted_.load();
+            if (accepted == snapshot_sequence_) {
+                continue;
+            }
+            lock.unlock();
+            bool const ok = write_snapshot();
+            lock.lock();
+            if (ok) {
+                snapshot_sequence_ = accepted;
+            }
+        }
+    }
+
+public:
+    ~score_store() {
+        stop();
+    }
+
+    // Diskteki durumu ykle ve log yazcsn balat
+    bool open(const std::filesystem::path& dir, std::chrono::seconds snapshot_interval) {
+        dir_ = dir;
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+
+        auto const started = std::chrono::steady_clock::now();
+        std::uint64_t first_generation = 0;
+        if (!load_snapshot(first_generation)) {
+            return false;
+        }
+        std::uint64_t next_generation = first_generation;
+        for (std::uint64_t generation : score_log::list_generations(dir_)) {
+            if (generation >= first_generation) {
+                replay_log(generation);
+            }
+            next_generation = std::max(next_generation, generation + 1);
+        }
+        retired_.clear();
+        auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+        std::cout << "Skor tablosu yuklendi: " << board_.size() << " oyuncu, " << elapsed.count() << " ms\n";
+
+        // Yarm kalm olabilecek son dosyaya eklemek yerine her alta yeni nesil balatlr
+        log_.start(dir_, next_generation);
+        applier_ = std::thread([this] { apply_loop(); });
+        snapshotter_ = std::thread([this, snapshot_interval] { snapshot_loop(snapshot_interval); });
+        return true;
+    }
+
+    // Gnderimi aran thread'in tamponuna ekle ve hemen dn. done, skor uygulanp (kabul edildiyse)
+    // log'a kalc olarak yazldktan sonra uygulayc veya log yazc thread'inde arlr.
+    void submit(std::string player, std::int64_t score, submit_callback done) {
+        ingest_buffer& buffer = local_buffer();
+        {
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.items.push_back({ std::move(player), score, std::move(done) });
+        }
+        if (queued_.fetch_add(1) == 0) {
+            std::lock_guard<std::mutex> lock(ingest_mutex_);
+            ingest_cv_.notify_one();
+        }
+    }
+
+    // Pencerenin ago dnem nceki tablosunda ilk k oyuncu (ago=0: iinde bulunulan dnem)
+    std::vector<leaderboard::entry> top(score_window window, std::int64_t ago, std::size_t k) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const leaderboard* board = find_board(window, ago);
+        return board == nullptr ? std::vector<leaderboard::entry>() : board->top(k);
+    }
+
+    bool rank_of(score_window window, std::int64_t ago, std::string_view player, std::size_t& rank, std::int64_t& score) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const leaderboard* board = find_board(window, ago);
+        return board != nullptr && board->rank_of(player, rank, score);
+    }
+
+    bool around(score_window window, std::int64_t ago, std::string_view player, std::size_t radius,
+        std::vector<leaderboard::ranked_entry>& out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const leaderboard* board = find_board(window, ago);
+        return board != nullptr && board->around(player, radius, out);
+    }
+
+    std::vector<std::size_t> count_above(score_window window, std::int64_t ago, const std::vector<std::int64_t>& scores) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const leaderboard* board = find_board(window, ago);
+        return board == nullptr ? std::vector<std::size_t>(scores.size(), 0) : board->count_above(scores);
+    }
+
+    std::vector<leaderboard::ranked_entry> ranks_of(score_window window, std::int64_t ago, const std::vector<std::string>& players) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        const leaderboard* board = find_board(window, ago);
+        return board == nullptr ? std::vector<leaderboard::ranked_entry>() : board->ranks_of(players);
+    }
+
+    // Log'u boalt ve kapanta son bir snapshot al (bir sonraki al daha hzl olur)
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(snapshot_mutex_);
+            if (stopping_) {
+                return;
+            }
+            stopping_ = true;
+        }
+        // nce tamponlarda bekleyen gnderimler uygulanr, son snapshot onlar da ierir
+        {
+            std::lock_guard<std::mutex> lock(ingest_mutex_);
+            ingest_stopping_ = true;
+        }
+        ingest_cv_.notify_one();
+        if (applier_.joinable()) {
+            applier_.join();
+        }
+        snapshot_cv_.notify_one();
+        if (snapshotter_.joinable()) {
+            snapshotter_.join();
+            if (accepted_.load() != snapshot_sequence_) {
+                write_snapshot();
+            }
+        }
+        log_.stop();
+    }
+};
+
+// POST /scores gvdesi: {"user": "...", "score": 1500}
+struct score_submission {
+    std::string user;
+    std::int64_t score = 0;
+
+    template <class Reader>
+    bool read(Reader& reader) {
+        std::string key;
+        bool has_user = false, has_score = false;
+        while (reader.next_key(key)) {
+            if (key == "user") {
+                has_user = reader.read_string(user);
+            }
+            else if (key == "score") {
+                has_score = reader.read_int(score);
+            }
+            else {
+                reader.skip_value();
+            }
+        }
+        return reader.ok() && has_user && has_score;
+    }
+};
+
+// POST /scores. Cevap, skor log'a kalc olarak yazldktan sonra verilir.
+route_ptr post_score(score_store& scores, const shard_placement& shard, const api_request& req,
+    const std::function<router::responder()>& defer) {
+    auto const format = response_format(req);
+    score_submission submission;
+    if (!decode_body(req, submission) || submission.user.empty() || submission.user.size() > score_record::max_player) {
+        return error_result(format, http::status::bad_request, "Gecersiz skor");
+    }
+    if (!shard.owns(submission.user)) {
+        return error_result(format, http::status::misdirected_request, "Oyuncu bu parcada degil");
+    }
+
+    scores.submit(std::move(submission.user), submission.score, [format, done = defer()](const score_store::submit_result& result) {
+        if (!result.durable) {
+            return done(error_result(format, http::status::service_unavailable, "Skor kaydedilemedi"));
+        }
+        body_writer writer(format);
+        writer.begin_object(3);
+        writer.key("status");
+        writer.string_value("success");
+        writer.key("accepted");
+        writer.bool_value(result.accepted);
+        writer.key("best");
+        writer.int_value(result.best);
+        writer.end();
+        done(writer.result());
+        });
+    return nullptr;
+}
+
+// Sorgudaki saysal boyut parametresi (limit, radius); yoksa fallback, en fazla max
+inline std::size_t query_size(std::string_view target, std::string_view name, std::size_t fallback, std::size_t max) {
+    std::size_t value = fallback;
+    auto const param = query_param(target, name);
+    if (!param.empty()) {
+        std::from_chars(param.data(), param.data() + param.size(), value);
+    }
+    return std::min(value, max);
+}
+
+// Sorgudaki window (all|daily|weekly) ve ago (ka dnem nce, varsaylan 0) parametreleri
+inline bool parse_window_query(std::string_view target, score_window& window, std::int64_t& ago) {
+    ago = 0;
+    auto const param = query_param(target, "ago");
+    if (!param.empty()) {
+        auto const parsed = std::from_chars(param.data(), param.data() + param.size(), ago);
+        if (parsed.ec != std::errc() || ago < 0) {
+            return false;
+        }
+    }
+    return parse_window(query_param(target, "window"), window);
+}
+
+inline route_ptr bad_window(body_format format) {
+    return error_result(format, http::status::bad_request, "Gecersiz pencere");
+}
+
+// {"scores": [{"user": ..., "score": ...}, ...]}
+template <class Entries>
+route_ptr top_response(body_format format, const Entries& entries) {
+    body_writer writer(format);
+    writer.begin_object(1);
+    writer.key("scores");
+    writer.begin_array(entries.size());
+    for (auto const& e : entries) {
+        writer.begin_object(2);
+        writer.key("user");
+        writer.string_value(e.player);
+        writer.key("score");
+        writer.int_value(e.score);
+        writer.end();
+    }
+    writer.end();
+    writer.end();
+    return writer.result();
+}
+
+// GET /scores?limit=N&window=daily&ago=1: en iyi N oyuncu (varsaylan 10, en fazla 1000)
+route_ptr get_scores(score_store& scores, const api_request& req) {
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::size_t const limit = query_size(target, "limit", 10, 1000);
+    score_window window;
+    std::int64_t ago;
+    if (!parse_window_query(target, window, ago)) {
+        return bad_window(format);
+    }
+    return top_response(format, scores.top(window, ago, limit));
+}
+
+inline route_ptr player_not_found(body_format format) {
+    return error_result(format, http::status::not_found, "Oyuncu bulunamadi");
+}
+
+// {"user": ..., "score": ..., "rank": ...} (sra 1 tabanl); friend_rank verilirse o da eklenir
+inline void write_ranked(body_writer& writer, const leaderboard::ranked_entry& e, std::size_t friend_rank = 0) {
+    writer.begin_object(friend_rank == 0 ? 3 : 4);
+    writer.key("user");
+    writer.string_value(e.player);
+    writer.key("score");
+    writer.int_value(e.score);
+    writer.key("rank");
+    writer.int_value(static_cast<std::int64_t>(e.rank + 1));
+    if (friend_rank != 0) {
+        writer.key("friend_rank");
+        writer.int_value(static_cast<std::int64_t>(friend_rank));
+    }
+    writer.end();
+}
+
+// GET /scores/rank?user=X&window=daily: oyuncunun penceredeki sras (1 tabanl)
+route_ptr get_rank(score_store& scores, const api_request& req) {
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string user;
+    if (!percent_decode(query_param(target, "user"), user)) {
+        return player_not_found(format);
+    }
+    score_window window;
+    std::int64_t ago;
+    if (!parse_window_query(target, window, ago)) {
+        return bad_window(format);
+    }
+    std::size_t rank = 0;
+    std::int64_t score = 0;
+    if (user.empty() || !scores.rank_of(window, ago, user, rank, score)) {
+        return player_not_found(format);
+    }
+    body_writer writer(format);
+    write_ranked(writer, { user, score, rank });
+    return writer.result();
+}
+
+// GET /scores/around/<oyuncu>?radius=N&window=...: oyuncunun stndeki ve altndaki N oyuncu
+// (varsaylan 10, en fazla 100)
+route_ptr get_around(score_store& scores, const api_request& req) {
+    static constexpr std::string_view prefix = "/scores/around/";
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string user;
+    if (!percent_decode(target.substr(prefix.size(), target.find('?') - prefix.size()), user)) {
+        return player_not_found(format);
+    }
+    std::size_t const radius = query_size(target, "radius", 10, 100);
+    score_window window;
+    std::int64_t ago;
+    if (!parse_window_query(target, window, ago)) {
+        return bad_window(format);
+    }
+
+    std::vector<leaderboard::ranked_entry> around;
+    if (!scores.around(window, ago, user, radius, around)) {
+        return player_not_found(format);
+    }
+    body_writer writer(format);
+    writer.begin_object(2);
+    writer.key("user");
+    writer.string_value(user);
+    writer.key("scores");
+    writer.begin_array(around.size());
+    for (auto const& e : around) {
+        write_ranked(writer, e);
+    }
+    writer.end();
+    writer.end();
+    return writer.result();
+}
+
+// Sorgudaki "window" ve "ago" alanlarndan biri deilse false
+template <class Reader>
+bool read_window_field(Reader& reader, const std::string& key, std::string& name, std::int64_t& ago, bool& valid) {
+    if (key == "window") {
+        valid = reader.read_string(name) && valid;
+    }
+    else if (key == "ago") {
+        valid = reader.read_int(ago) && ago >= 0 && valid;
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+// POST /scores/ranks gvdesi: {"users": ["a", "b", ...], "window": "weekly", "ago": 0} (en fazla 1000 oyuncu)
+struct ranks_query {
+    std::vector<std::string> users;
+    score_window window = score_window::all_time;
+    std::int64_t ago = 0;
+
+    template <class Reader>
+    bool read(Reader& reader) {
+        std::string key, name;
+        bool valid = true;
+        while (reader.next_key(key)) {
+            if (key == "users") {
+                valid = reader.read_string_array(users, 1000) && valid;
+            }
+            else if (!read_window_field(reader, key, name, ago, valid)) {
+                reader.skip_value();
+            }
+        }
+        return reader.ok() && valid && parse_window(name, window);
+    }
+};
+
+// Sraya gre dizili oyuncular; friend_rank liste iindeki sradr
+inline route_ptr ranks_response(body_format format, const std::vector<leaderboard::ranked_entry>& ranked) {
+    body_writer writer(format);
+    writer.begin_object(1);
+    writer.key("scores");
+    writer.begin_array(ranked.size());
+    for (std::size_t i = 0; i < ranked.size(); ++i) {
+        write_ranked(writer, ranked[i], i + 1);
+    }
+    writer.end();
+    writer.end();
+    return writer.result();
+}
+
+// POST /scores/ranks: listedeki oyuncularn (r. arkadalar) sralar
+route_ptr post_ranks(score_store& scores, const api_request& req) {
+    auto const format = response_format(req);
+    ranks_query query;
+    if (!decode_body(req, query)) {
+        return error_result(format, http::status::bad_request, "Gecersiz istek");
+    }
+    return ranks_response(format, scores.ranks_of(query.window, query.ago, query.users));
+}
+
+// POST /scores/counts gvdesi: {"scores": [s1, s2, ...], "window": ..., "ago": ...}
+struct counts_query {
+    std::vector<std::int64_t> scores;
+    score_window window = score_window::all_time;
+    std::int64_t ago = 0;
+
+    template <class Reader>
+    bool read(Reader& reader) {
+        std::string key, name;
+        bool valid = true;
+        while (reader.next_key(key)) {
+            if (key == "scores") {
+                valid = reader.read_int_array(scores, 1000) && valid;
+            }
+            else if (!read_window_field(reader, key, name, ago, valid)) {
+                reader.skip_value();
+            }
+        }
+        return reader.ok() && valid && parse_window(name, window);
+    }
+};
+
+// POST /scores/counts: her skor iin bu skordan yksek skoru olan oyuncu says; n dm paralar
+// aras sray bu saylar toplayarak bulur.
+route_ptr post_counts(score_store& scores, const api_request& req) {
+    auto const format = response_format(req);
+    counts_query query;
+    if (!decode_body(req, query)) {
+        return error_result(format, http::status::bad_request, "Gecersiz istek");
+    }
+
+    auto const counts = scores.count_above(query.window, query.ago, query.scores);
+    body_writer writer(format);
+    writer.begin_object(1);
+    writer.key("counts");
+    writer.begin_array(counts.size());
+    for (auto const count : counts) {
+        writer.int_value(static_cast<std::int64_t>(count));
+    }
+    writer.end();
+    writer.end();
+    return writer.result();
+}
+
+// Oyun telemetrisi (lmler, bulmaca sreleri, blm ilerlemesi). Olaylar trlerine gre bellekte stun
+// stun biriktirilir ve periyodik olarak sktrlm stunlu segment dosyalarna yazlr.
+
+// POST /telemetry'deki bir olay; tre gre alanlarn bir ksm kullanlr
+struct telemetry_event {
+    std::string type;
+    std::int64_t time = 0;
+    std::string user;
+    std::string chapter;
+    std::string cause;
+    std::string puzzle;
+    std::int64_t duration_ms = 0;
+    std::int64_t hints = 0;
+    std::int64_t progress = 0;
+};
+
+// Olay alan; text doluysa string, deilse tam say alandr
+struct telemetry_field {
+    const char* name;
+    std::string telemetry_event::* text;
+    std::int64_t telemetry_event::* number;
+};
+
+inline const std::vector<telemetry_field>& telemetry_fields() {
+    static const std::vector<telemetry_field> fields = {
+        { "time", nullptr, &telemetry_event::time },
+        { "user", &telemetry_event::user, nullptr },
+        { "chapter", &telemetry_event::chapter, nullptr },
+        { "cause", &telemetry_event::cause, nullptr },
+        { "puzzle", &telemetry_event::puzzle, nullptr },
+        { "duration_ms", nullptr, &telemetry_event::duration_ms },
+        { "hints", nullptr, &telemetry_event::hints },
+        { "progress", nullptr, &telemetry_event::progress },
+    };
+    return fields;
+}
+
+inline const telemetry_field* find_telemetry_field(std::string_view name) {
+    for (auto const& field : telemetry_fields()) {
+        if (name == field.name) {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+// Olay trleri ve segment stunlar. lk stun her trde time'dr (segment bu stuna gre sralanr).
+struct telemetry_type {
+    const char* name;
+    std::vector<const char*> columns;
+};
+
+inline const std::vector<telemetry_type>& telemetry_types() {
+    static const std::vector<telemetry_type> types = {
+        { "death", { "time", "user", "chapter", "cause" } },
+        { "puzzle", { "time", "user", "puzzle", "duration_ms", "hints" } },
+        { "chapter", { "time", "user", "chapter", "progress" } },
+    };
+    return types;
+}
+
+inline int find_telemetry_type(std::string_view name) {
+    auto const& types = telemetry_types();
+    for (std::size_t i = 0; i < types.size(); ++i) {
+        if (name == types[i].name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// {"type": "puzzle", "time": <Unix ms>, "user": "...", "puzzle": "...", "duration_ms": 41250, ...}.
+// time yoksa sunucunun al zaman kullanlr.
+template <class Reader>
+bool read_telemetry_event(Reader& reader, telemetry_event& event) {
+    std::string key;
+    bool valid = true, has_time = false;
+    while (reader.next_key(key)) {
+        if (key == "type") {
+            valid = reader.read_string(event.type) && valid;
+            continue;
+        }
+        const telemetry_field* field = find_telemetry_field(key);
+        if (field == nullptr) {
+            reader.skip_value();
+        }
+        else if (field->text != nullptr) {
+            valid = reader.read_string(event.*field->text) && valid;
+        }
+        else {
+            valid = reader.read_int(event.*field->number) && valid;
+            has_time = has_time || field->number == &telemetry_event::time;
+        }
+    }
+    if (!has_time) {
+        event.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    return reader.ok() && valid && !event.user.empty() && find_telemetry_type(event.type) >= 0;
+}
+
+// POST /telemetry gvdesi: {"events": [...]} (en fazla 10000 olay)
+struct telemetry_batch {
+    static constexpr std::size_t max_events = 10000;
+
+    std::vector<telemetry_event> events;
+
+    template <class Reader>
+    bool read(Reader& reader) {
+        std::string key;
+        bool has_events = false;
+        while (reader.next_key(key)) {
+            if (key == "events") {
+                has_events = reader.read_object_array(max_events, [this](auto& item) {
+                    events.emplace_back();
+                    return read_telemetry_event(item, events.back());
+                    });
+            }
+            else {
+                reader.skip_value();
+            }
+        }
+        return reader.ok() && has_events;
+    }
+};
+
+// Deerleri width bitlik alanlar halinde 64 bitlik kelimelere paketle (ilk bayt width)
+inline void bit_pack(const std::vector<std::uint64_t>& values, unsigned width, std::string& out) {
+    out.push_back(static_cast<char>(width));
+    std::vector<std::uint64_t> words((values.size() * width + 63) / 64, 0);
+    for (std::size_t i = 0; width != 0 && i < values.size(); ++i) {
+        std::size_t const bit = i * width;
+        unsigned const offset = bit & 63;
+        words[bit >> 6] |= values[i] << offset;
+        if (offset + width > 64) {
+            words[(bit >> 6) + 1] |= values[i] >> (64 - offset);
+        }
+    }
+    out.append(reinterpret_cast<const char*>(words.data()), words.size() * 8);
+}
+
+inline unsigned bit_width(std::uint64_t max) {
+    unsigned width = 0;
+    while (max != 0) {
+        ++width;
+        max >>= 1;
+    }
+    return width;
+}
+
+// bit_pack ktsn okuyan zc. Paketin ardndan en az 8 bayt okunabilir olmaldr: 56 bite kadar
+// geniliklerde her deer tek bir hizasz 8 baytlk okumayla (kk endian) dallanmadan karlr.
+class bit_unpacker {
+private:
+    const char* words_ = nullptr;
+    unsigned width_ = 0;
+    std::uint64_t mask_ = 0;
+
+public:
+    // data'nn bandaki count deerlik paketi a; data paketin sonuna ilerletilir
+    bool open(std::string_view& data, std::size_t count) {
+        if (data.empty()) {
+            return false;
+        }
+        width_ = static_cast<unsigned char>(data[0]);
+        std::size_t const bytes = (count * width_ + 63) / 64 * 8;
+        if (width_ > 64 || data.size() - 1 < bytes) {
+            return false;
+        }
+        mask_ = width_ == 64 ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << width_) - 1;
+        words_ = data.data() + 1;
+        data.remove_prefix(1 + bytes);
+        return true;
+    }
+
+    std::uint64_t get(std::size_t i) const {
+        std::size_t const bit = i * width_;
+        std::uint64_t value;
+        if (width_ <= 56) {
+            std::memcpy(&value, words_ + (bit >> 3), 8);
+            return (value >> (bit & 7)) & mask_;
+        }
+        unsigned const offset = bit & 63;
+        std::memcpy(&value, words_ + (bit >> 6) * 8, 8);
+        value >>= offset;
+        if (offset + width_ > 64) {
+            std::uint64_t high;
+            std::memcpy(&high, words_ + (bit >> 6) * 8 + 8, 8);
+            value |= high << (64 - offset);
+        }
+        return value & mask_;
+    }
+
+    // [first, first + count) deerlerini out'a z
+    void unpack(std::size_t first, std::size_t count, std::uint64_t* out) const {
+        if (width_ > 56) {
+            for (std::size_t j = 0; j < count; ++j) {
+                out[j] = get(first + j);
+            }
+            return;
+        }
+        std::size_t bit = first * width_;
+        for (std::size_t j = 0; j < count; ++j, bit += width_) {
+            std::uint64_t value;
+            std::memcpy(&value, words_ + (bit >> 3), 8);
+            out[j] = (value >> (bit & 7)) & mask_;
+        }
+    }
+};
+
+// Segment stun kodlamalar. Hepsi bit paketlidir:
+//   delta: ilk deer + ardk farklar (sral time stunu)
+//   frame: en kk deer + her deerin ondan fark (frame of reference)
+//   dictionary: farkl string'lerin szl + her satrn szlk kodu
+enum class column_encoding : std::uint8_t { delta = 1, frame = 2, dictionary = 3 };
+
+// Diskteki bir segmentin bal; stun verileri sorguda sadece gerektiinde okunur
+struct telemetry_segment {
+    struct column {
+        std::string name;
+        column_encoding encoding;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint32_t crc;
+    };
+
+    std::filesystem::path path;
+    std::uint64_t rows = 0;
+    std::int64_t min_time = 0;
+    std::int64_t max_time = 0;
+    std::vector<column> columns;
+    // Stunun CRC'si doruland m; her stun ilk okunuunda bir kez dorulanr
+    std::unique_ptr<std::atomic<bool>[]> verified;
+
+    const column* find(std::string_view name) const {
+        for (auto const& c : columns) {
+            if (c.name == name) {
+                return &c;
+            }
+        }
+        return nullptr;
+    }
+};
+
+// Segmentten okunmu bir stun. unpack() paketli deerleri verir: frame stununda base()'e gre farklar,
+// dictionary stununda szlk kodlar; delta stunu decode_deltas() ile btn olarak zlr.
+class column_reader {
+private:
+    std::string data_;
+    column_encoding encoding_ = column_encoding::frame;
+    std::int64_t base_ = 0;
+    bit_unpacker packed_;
+
+public:
+    std::vector<std::string_view> dictionary;
+
+    // Stun verisini dosyadan oku ve dorula (sona bit_unpacker iin 8 bayt dolgu eklenir)
+    bool load(std::FILE* file, const telemetry_segment& segment, const telemetry_segment::column& column) {
+        std::size_t const size = static_cast<std::size_t>(column.size);
+        std::atomic<bool>& verified = segment.verified[static_cast<std::size_t>(&column - segment.columns.data())];
+        data_.assign(size + 8, '\0');
+        if (std::fseek(file, static_cast<long>(column.offset), SEEK_SET) != 0
+            || std::fread(data_.data(), 1, size, file) != size
+            || (!verified.load(std::memory_order_relaxed) && crc32(data_.data(), size) != column.crc)) {
+            return false;
+        }
+        verified.store(true, std::memory_order_relaxed);
+        encoding_ = column.encoding;
+        std::string_view in(data_.data(), size);
+        std::size_t const rows = static_cast<std::size_t>(segment.rows);
+        if (encoding_ == column_encoding::dictionary) {
+            std::uint32_t count;
+            if (in.size() < 4) {
+                return false;
+            }
+            std::memcpy(&count, in.data(), 4);
+            in.remove_prefix(4);
+            dictionary.clear();
+            for (std::uint32_t i = 0; i < count; ++i) {
+                std::uint32_t length;
+                if (in.size() < 4) {
+                    return false;
+                }
+                std::memcpy(&length, in.data(), 4);
+                if (in.size() - 4 < length) {
+                    return false;
+                }
+                dictionary.push_back(in.substr(4, length));
+                in.remove_prefix(4 + length);
+            }
+        }
+        else {
+            if (in.size() < 8) {
+                return false;
+            }
+            std::memcpy(&base_, in.data(), 8);
+            in.remove_prefix(8);
+        }
+        return packed_.open(in, rows) && in.empty();
+    }
+
+    column_encoding encoding() const {
+        return encoding_;
+    }
+
+    // [first, first + count) satrlarnn ham (paketli) deerleri: szlk kodlar veya base'e gre farklar
+    void unpack(std::size_t first, std::size_t count, std::uint64_t* out) const {
+        packed_.unpack(first, count, out);
+    }
+
+    std::int64_t base() const {
+        return base_;
+    }
+
+    // delta kodlu stunun tm deerleri (n toplam)
+    void decode_deltas(std::size_t rows, std::vector<std::int64_t>& out) const {
+        out.resize(rows);
+        std::int64_t value = base_;
+        for (std::size_t i = 0; i < rows; ++i) {
+            value += static_cast<std::int64_t>(packed_.get(i));
+            out[i] = value;
+        }
+    }
+};
+
+class telemetry_store {
+public:
+    // GET /telemetry/stats sorgusu: [from, to) zaman aralnda value stununun by stununa gre zeti
+    struct query {
+        int type = -1;
+        std::string value;
+        std::string by;
+        std::int64_t from = INT64_MIN;
+        std::int64_t to = INT64_MAX;
+    };
+
+    struct group_stats {
+        std::string key;
+        std::uint64_t count = 0;
+        std::int64_t sum = 0;
+        std::int64_t min = INT64_MAX;
+        std::int64_t max = INT64_MIN;
+    };
+
+    struct query_result {
+        std::uint64_t segments = 0;
+        std::uint64_t rows = 0;
+        std::vector<group_stats> groups;
+    };
+
+private:
+    static constexpr char segment_magic[4] = { 'N', 'R', 'T', 'M' };
+    static constexpr std::uint32_t segment_version = 1;
+    // Bir trn tamponu bu kadar satra ulanca aralk beklenmeden segment yazlr
+    static constexpr std::size_t segment_rows = 65536;
+    // Tm tamponlardaki satr snr; alrsa yeni olaylar reddedilir
+    static constexpr std::int64_t max_buffered = 1 << 20;
+
+    // Bir trn bellekteki stunlar (emadaki srayla)
+    struct type_buffer {
+        std::mutex mutex;
+        std::vector<std::vector<std::int64_t>> numbers;
+        std::vector<std::vector<std::string>> texts;
+        std::size_t rows = 0;
+    };
+
+    std::filesystem::path dir_;
+    std::vector<std::unique_ptr<type_buffer>> buffers_;
+    std::atomic<std::int64_t> buffered_{ 0 };
+
+    mutable std::shared_mutex segments_mutex_;
+    // Tr bana segmentler, yazlma srasyla
+    std::vector<std::vector<std::shared_ptr<const telemetry_segment>>> segments_;
+    std::uint64_t next_segment_ = 0;
+
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    bool flush_requested_ = false;
+    bool stopping_ = true;
+    std::thread flusher_;
+
+    static const telemetry_field& field_of(const char* name) {
+        return *find_telemetry_field(name);
+    }
+
+    std::filesystem::path segment_path(const telemetry_type& type, std::uint64_t sequence) const {
+        char name[64];
+        std::snprintf(name, sizeof(name), "%s-%08llu.seg", type.name, static_cast<unsigned long long>(sequence));
+        return dir_ / name;
+    }
+
+    // Segment baln oku (stun verileri okunmaz)
+    static bool read_header(const std::filesystem::path& path, std::string& type, telemetry_segment& segment) {
+        std::FILE* file = std::fopen(path.string().c_str(), "rb");
+        if (file == nullptr) {
+            return false;
+        }
+        std::string header;
+        auto const read = [&](std::size_t n) {
+            std::size_t const old = header.size();
+            header.resize(old + n);
+            return std::fread(header.data() + old, 1, n, file) == n;
+        };
+        auto const field = [&](std::size_t at, auto& out) {
+            std::memcpy(&out, header.data() + at, sizeof(out));
+        };
+
+        bool ok = read(9) && std::memcmp(header.data(), segment_magic, 4) == 0;
+        std::uint32_t version = 0, columns = 0;
+        if (ok) {
+            field(4, version);
+            std::size_t const type_length = static_cast<unsigned char>(header[8]);
+            ok = version == segment_version && read(type_length + 28);
+            if (ok) {
+                type = header.substr(9, type_length);
+                std::size_t const at = 9 + type_length;
+                field(at, segment.rows);
+                field(at + 8, segment.min_time);
+                field(at + 16, segment.max_time);
+                field(at + 24, columns);
+            }
+        }
+        for (std::uint32_t i = 0; ok && i < columns; ++i) {
+            ok = read(1);
+            std::size_t const name_length = ok ? static_cast<unsigned char>(header.back()) : 0;
+            std::size_t const at = header.size();
+            ok = ok && read(name_length + 21);
+            if (ok) {
+                telemetry_segment::column c;
+                c.name = header.substr(at, name_length);
+                c.encoding = static_cast<column_encoding>(header[at + name_length]);
+                field(at + name_length + 1, c.offset);
+                field(at + name_length + 9, c.size);
+                field(at + name_length + 17, c.crc);
+                segment.columns.push_back(std::move(c));
+            }
+        }
+        std::uint32_t checksum = 0;
+        ok = ok && std::fread(&checksum, 1, 4, file) == 4 && checksum == crc32(header.data(), header.size());
+        std::fclose(file);
+        segment.path = path;
+        segment.verified = std::make_unique<std::atomic<bool>[]>(segment.columns.size());
+        return ok;
+    }
+
+    // Saysal stunu satrlar order srasyla kodla. delta: farklar bir nceki satra (order zamana gre
+    // sral olduundan negatif olmaz), frame: en kk deere gredir.
+    static void encode_numbers(const std::vector<std::int64_t>& values, const std::vector<std::uint32_t>& order,
+        column_encoding encoding, std::string& out) {
+        std::int64_t base = order.empty() ? 0 : values[order[0]];
+        if (encoding == column_encoding::frame) {
+            for (std::uint32_t row : order) {
+                base = std::min(base, values[row]);
+            }
+        }
+        std::vector<std::uint64_t> packed(order.size());
+        std::uint64_t max = 0;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            std::int64_t const reference = encoding == column_encoding::delta ? values[order[i == 0 ? 0 : i - 1]] : base;
+            packed[i] = static_cast<std::uint64_t>(values[order[i]]) - static_cast<std::uint64_t>(reference);
+            max = std::max(max, packed[i]);
+        }
+        out.append(reinterpret_cast<const char*>(&base), 8);
+        bit_pack(packed, bit_width(max), out);
+    }
+
+    static void encode_texts(const std::vector<std::string>& values, const std::vector<std::uint32_t>& order, std::string& out) {
+        std::unordered_map<std::string_view, std::uint32_t> codes;
+        std::vector<std::string_view> dictionary;
+        std::vector<std::uint64_t> packed(order.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            std::string_view const value = values[order[i]];
+            auto const inserted = codes.emplace(value, static_cast<std::uint32_t>(dictionary.size()));
+            if (inserted.second) {
+                dictionary.push_back(value);
+            }
+            packed[i] = inserted.first->second;
+        }
+        std::uint32_t const count = static_cast<std::uint32_t>(dictionary.size());
+        out.append(reinterpret_cast<const char*>(&count), 4);
+        for (auto const entry : dictionary) {
+            std::uint32_t const length = static_cast<std::uint32_t>(entry.size());
+            out.append(reinterpret_cast<const char*>(&length), 4);
+            out.append(entry.data(), entry.size());
+        }
+        bit_pack(packed, bit_width(count == 0 ? 0 : count - 1), out);
+    }
+
+    // Tamponun ieriini zamana gre sral tek bir segment dosyas olarak yaz
+    bool write_segment(std::size_t type_index, const type_buffer& buffer) {
+        telemetry_type const& type = telemetry_types()[type_index];
+        auto const& times = buffer.numbers[0];
+        std::vector<std::uint32_t> order(buffer.rows);
+        for (std::uint32_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&times](std::uint32_t a, std::uint32_t b) {
+            return times[a] < times[b];
+        });
+
+        auto segment = std::make_shared<telemetry_segment>();
+        segment->rows = buffer.rows;
+        segment->min_time = times[order.front()];
+        segment->max_time = times[order.back()];
+        std::vector<std::string> payloads(type.columns.size());
+        std::size_t header_size = 4 + 4 + 1 + std::strlen(type.name) + 28;
+        for (std::size_t c = 0; c < type.columns.size(); ++c) {
+            telemetry_segment::column column;
+            column.name = type.columns[c];
+            if (field_of(type.columns[c]).text != nullptr) {
+                column.encoding = column_encoding::dictionary;
+                encode_texts(buffer.texts[c], order, payloads[c]);
+            }
+            else {
+                column.encoding = c == 0 ? column_encoding::delta : column_encoding::frame;
+                encode_numbers(buffer.numbers[c], order, column.encoding, payloads[c]);
+            }
+            column.size = payloads[c].size();
+            column.crc = crc32(payloads[c].data(), payloads[c].size());
+            header_size += 1 + column.name.size() + 21;
+            segment->columns.push_back(std::move(column));
+        }
+
+        std::string header(segment_magic, 4);
+        auto const append = [&header](const auto& value) {
+            header.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        append(segment_version);
+        header.push_back(static_cast<char>(std::strlen(type.name)));
+        header += type.name;
+        append(segment->rows);
+        append(segment->min_time);
+        append(segment->max_time);
+        append(static_cast<std::uint32_t>(segment->columns.size()));
+        std::uint64_t offset = header_size + 4;
+        for (auto& column : segment->columns) {
+            column.offset = offset;
+            offset += column.size;
+            header.push_back(static_cast<char>(column.name.size()));
+            header += column.name;
+            header.push_back(static_cast<char>(column.encoding));
+            append(column.offset);
+            append(column.size);
+            append(column.crc);
+        }
+        append(crc32(header.data(), header.size()));
+
+        std::uint64_t sequence;
+        {
+            std::unique_lock<std::shared_mutex> lock(segments_mutex_);
+            sequence = next_segment_++;
+        }
+        segment->path = segment_path(type, sequence);
+        auto const tmp = segment->path.string() + ".tmp";
+        std::FILE* file = std::fopen(tmp.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+        for (auto const& payload : payloads) {
+            ok = ok && std::fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+        }
+        ok = sync_file(file) && ok;
+        std::fclose(file);
+
+        std::error_code ec;
+        if (ok) {
+            std::filesystem::rename(tmp, segment->path, ec);
+            ok = !ec;
+        }
+        if (!ok) {
+            std::cerr << "Telemetri segmenti yazilamadi: " << tmp << "\n";
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        sync_directory(dir_);
+
+        // Yeni yazlan stunlarn CRC'si yeniden dorulanmaz
+        segment->verified = std::make_unique<std::atomic<bool>[]>(segment->columns.size());
+        for (std::size_t c = 0; c < segment->columns.size(); ++c) {
+            segment->verified[c].store(true);
+        }
+        std::unique_lock<std::shared_mutex> lock(segments_mutex_);
+        segments_[type_index].push_back(std::move(segment));
+        return true;
+    }
+
+    // En az min_rows satr olan trlerin tamponlarn segment olarak yaz
+    void flush(std::size_t min_rows) {
+        auto const& types = telemetry_types();
+        for (std::size_t t = 0; t < types.size(); ++t) {
+            type_buffer taken;
+            {
+                type_buffer& buffer = *buffers_[t];
+                std::lock_guard<std::mutex> lock(buffer.mutex);
+                if (buffer.rows == 0 || buffer.rows < min_rows) {
+                    continue;
+                }
+                taken.numbers.swap(buffer.numbers);
+                taken.texts.swap(buffer.texts);
+                taken.rows = buffer.rows;
+                buffer.numbers.resize(types[t].columns.size());
+                buffer.texts.resize(types[t].columns.size());
+                buffer.rows = 0;
+            }
+            write_segment(t, taken);
+            buffered_.fetch_sub(static_cast<std::int64_t>(taken.rows));
+        }
+    }
+
+    // Segmentin [first, last) satrlarn bloklar halinde zerek zetle. Gruplar segment iinde szlk
+    // koduyla dorudan dizilerde toplanr, sonra genel gruplara eklenir.
+    static void aggregate(const query& q, std::size_t first, std::size_t last, const std::vector<std::size_t>& local_groups,
+        const column_reader& groups, const column_reader& values, const std::vector<std::int64_t>& decoded_values,
+        query_result& result) {
+        constexpr std::size_t block = 1024;
+        bool const grouped = !q.by.empty();
+        bool const has_value = !q.value.empty();
+        std::size_t const group_count = grouped ? local_groups.size() : 1;
+        std::vector<std::uint64_t> counts(group_count, 0);
+        std::vector<std::int64_t> sums(group_count, 0), mins(group_count, INT64_MAX), maxs(group_count, INT64_MIN);
+        std::uint64_t codes[block];
+        std::uint64_t raw[block];
+        std::int64_t const base = values.base();
+
+        for (std::size_t i = first; i < last; i += block) {
+            std::size_t const n = std::min(block, last - i);
+            if (grouped) {
+                groups.unpack(i, n, codes);
+            }
+            if (!has_value) {
+                if (!grouped) {
+                    counts[0] += n;
+                    continue;
+                }
+                for (std::size_t j = 0; j < n; ++j) {
+                    ++counts[codes[j]];
+                }
+                continue;
+            }
+            // Deerler base'e gre farklar olarak toplanr; base en sonda count * base olarak eklenir
+            if (decoded_values.empty()) {
+                values.unpack(i, n, raw);
+            }
+            else {
+                for (std::size_t j = 0; j < n; ++j) {
+                    raw[j] = static_cast<std::uint64_t>(decoded_values[i + j]) - static_cast<std::uint64_t>(base);
+                }
+            }
+            if (!grouped) {
+                std::uint64_t sum = 0, low = UINT64_MAX, high = 0;
+                for (std::size_t j = 0; j < n; ++j) {
+                    sum += raw[j];
+                    low = std::min(low, raw[j]);
+                    high = std::max(high, raw[j]);
+                }
+                counts[0] += n;
+                sums[0] += static_cast<std::int64_t>(sum);
+                mins[0] = std::min(mins[0], base + static_cast<std::int64_t>(low));
+                maxs[0] = std::max(maxs[0], base + static_cast<std::int64_t>(high));
+                continue;
+            }
+            for (std::size_t j = 0; j < n; ++j) {
+                std::size_t const g = static_cast<std::size_t>(codes[j]);
+                std::int64_t const v = base + static_cast<std::int64_t>(raw[j]);
+                ++counts[g];
+                sums[g] += static_cast<std::int64_t>(raw[j]);
+                mins[g] = std::min(mins[g], v);
+                maxs[g] = std::max(maxs[g], v);
+            }
+        }
+
+        for (std::size_t g = 0; g < group_count; ++g) {
+            if (counts[g] == 0) {
+                continue;
+            }
+            group_stats& out = result.groups[grouped ? local_groups[g] : 0];
+            out.count += counts[g];
+            if (has_value) {
+                out.sum += sums[g] + base * static_cast<std::int64_t>(counts[g]);
+                out.min = std::min(out.min, mins[g]);
+                out.max = std::max(out.max, maxs[g]);
+            }
+        }
+    }
+
+    void flush_loop(std::chrono::seconds interval) {
+        std::unique_lock<std::mutex> lock(flush_mutex_);
+        while (!stopping_) {
+            flush_cv_.wait_for(lock, interval, [this] { return stopping_ || flush_requested_; });
+            std::size_t const min_rows = flush_requested_ && !stopping_ ? segment_rows : 1;
+            flush_requested_ = false;
+            lock.unlock();
+            flush(min_rows);
+            lock.lock();
+        }
+    }
+
+public:
+    telemetry_store() {
+        for (auto const& type : telemetry_types()) {
+            auto buffer = std::make_unique<type_buffer>();
+            buffer->numbers.resize(type.columns.size());
+            buffer->texts.resize(type.columns.size());
+            buffers_.push_back(std::move(buffer));
+        }
+        segments_.resize(telemetry_types().size());
+    }
+
+    ~telemetry_store() {
+        stop();
+    }
+
+    // Mevcut segmentlerin balklarn ykle ve flush thread'ini balat
+    bool open(const std::filesystem::path& dir, std::chrono::seconds flush_interval) {
+        dir_ = dir;
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+        if (ec) {
+            std::cerr << "Telemetri dizini olusturulamadi: " << dir_.string() << "\n";
+            return false;
+        }
+
+        std::vector<std::pair<std::uint64_t, std::filesystem::path>> files;
+        for (auto const& entry : std::filesystem::directory_iterator(dir_, ec)) {
+            auto const name = entry.path().filename().string();
+            if (entry.path().extension() == ".tmp") {
+                std::filesystem::remove(entry.path(), ec);
+                continue;
+            }
+            auto const dash = name.rfind('-');
+            std::uint64_t sequence = 0;
+            if (entry.path().extension() == ".seg" && dash != std::string::npos
+                && std::from_chars(name.data() + dash + 1, name.data() + name.size() - 4, sequence).ec == std::errc()) {
+                files.emplace_back(sequence, entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+        for (auto const& file : files) {
+            std::string type;
+            auto segment = std::make_shared<telemetry_segment>();
+            int const index = read_header(file.second, type, *segment) ? find_telemetry_type(type) : -1;
+            if (index < 0) {
+                std::cerr << file.second.string() << ": okunamadi, atlaniyor\n";
+                continue;
+            }
+            segments_[static_cast<std::size_t>(index)].push_back(std::move(segment));
+            next_segment_ = file.first + 1;
+        }
+
+        stopping_ = false;
+        flusher_ = std::thread([this, flush_interval] { flush_loop(flush_interval); });
+        return true;
+    }
+
+    // Olaylar tamponlara ekle; tampon snr alacaksa hibirini eklemeden false dner
+    bool ingest(const std::vector<telemetry_event>& events) {
+        std::int64_t const n = static_cast<std::int64_t>(events.size());
+        if (buffered_.fetch_add(n) + n > max_buffered) {
+            buffered_.fetch_sub(n);
+            return false;
+        }
+        auto const& types = telemetry_types();
+        bool full = false;
+        for (std::size_t t = 0; t < types.size(); ++t) {
+            type_buffer& buffer = *buffers_[t];
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            for (auto const& event : events) {
+                if (event.type != types[t].name) {
+                    continue;
+                }
+                for (std::size_t c = 0; c < types[t].columns.size(); ++c) {
+                    telemetry_field const& field = field_of(types[t].columns[c]);
+                    if (field.text != nullptr) {
+                        buffer.texts[c].push_back(event.*field.text);
+                    }
+                    else {
+                        buffer.numbers[c].push_back(event.*field.number);
+                    }
+                }
+                ++buffer.rows;
+            }
+            full = full || buffer.rows >= segment_rows;
+        }
+        if (full) {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            flush_requested_ = true;
+            flush_cv_.notify_one();
+        }
+        return true;
+    }
+
+    // Segmentleri tara; her segmentten sadece sorgunun gerektirdii stunlar okunur. Tamponda
+    // bekleyen (henz segmente yazlmam) olaylar sonuca girmez.
+    query_result run(const query& q) const {
+        std::vector<std::shared_ptr<const telemetry_segment>> segments;
+        {
+            std::shared_lock<std::shared_mutex> lock(segments_mutex_);
+            segments = segments_[static_cast<std::size_t>(q.type)];
+        }
+
+        query_result result;
+        std::unordered_map<std::string, std::size_t> group_index;
+        if (q.by.empty()) {
+            result.groups.emplace_back();
+        }
+        column_reader times, groups, values;
+        std::vector<std::int64_t> decoded_times;
+        std::vector<std::size_t> local_groups;
+        for (auto const& segment : segments) {
+            if (segment->max_time < q.from || segment->min_time >= q.to || segment->rows == 0) {
+                continue;
+            }
+            std::FILE* file = std::fopen(segment->path.string().c_str(), "rb");
+            if (file == nullptr) {
+                continue;
+            }
+            std::size_t first = 0, last = static_cast<std::size_t>(segment->rows);
+            bool ok = true;
+            // Segment arala tamamen girmiyorsa: satrlar zamana gre sral, snrlar ikili aramayla bulunur
+            if (segment->min_time < q.from || segment->max_time >= q.to) {
+                auto const* column = segment->find("time");
+                ok = column != nullptr && times.load(file, *segment, *column);
+                if (ok) {
+                    times.decode_deltas(last, decoded_times);
+                    first = static_cast<std::size_t>(std::lower_bound(decoded_times.begin(), decoded_times.end(), q.from) - decoded_times.begin());
+                    last = static_cast<std::size_t>(std::lower_bound(decoded_times.begin(), decoded_times.end(), q.to) - decoded_times.begin());
+                }
+            }
+            if (ok && !q.by.empty()) {
+                auto const* column = segment->find(q.by);
+                ok = column != nullptr && groups.load(file, *segment, *column) && groups.encoding() == column_encoding::dictionary;
+                local_groups.clear();
+                for (std::size_t i = 0; ok && i < groups.dictionary.size(); ++i) {
+                    auto const inserted = group_index.emplace(std::string(groups.dictionary[i]), result.groups.size());
+                    if (inserted.second) {
+                        result.groups.emplace_back();
+                        result.groups.back().key = inserted.first->first;
+                    }
+                    local_groups.push_back(inserted.first->second);
+                }
+            }
+            bool const has_value = !q.value.empty();
+            std::vector<std::int64_t> decoded_values;
+            if (ok && has_value) {
+                auto const* column = segment->find(q.value);
+                ok = column != nullptr && values.load(file, *segment, *column) && values.encoding() != column_encoding::dictionary;
+                if (ok && values.encoding() == column_encoding::delta) {
+                    values.decode_deltas(static_cast<std::size_t>(segment->rows), decoded_values);
+                }
+            }
+            std::fclose(file);
+            if (!ok) {
+                std::cerr << segment->path.string() << ": sutun okunamadi\n";
+                continue;
+            }
+
+            ++result.segments;
+            result.rows += last - first;
+            aggregate(q, first, last, local_groups, groups, values, decoded_values, result);
+        }
+        std::sort(result.groups.begin(), result.groups.end(), [](const group_stats& a, const group_stats& b) {
+            return a.key < b.key;
+        });
+        return result;
+    }
+
+    // Kapanta tamponda kalan olaylar segmentlere yaz
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            if (stopping_) {
+                return;
+            }
+            stopping_ = true;
+        }
+        flush_cv_.notify_one();
+        if (flusher_.joinable()) {
+            flusher_.join();
+        }
+    }
+};
+
+// POST /telemetry: olaylar tampona alnr ve hemen 202 dner; kalclk flush aral kadar gecikebilir
+route_ptr post_telemetry(telemetry_store& telemetry, const api_request& req) {
+    auto const format = response_format(req);
+    telemetry_batch batch;
+    if (!decode_body(req, batch)) {
+        return error_result(format, http::status::bad_request, "Gecersiz telemetri");
+    }
+    if (!telemetry.ingest(batch.events)) {
+        return error_result(format, http::status::service_unavailable, "Telemetri tamponu dolu");
+    }
+    body_writer writer(format);
+    writer.begin_object(2);
+    writer.key("status");
+    writer.string_value("success");
+    writer.key("accepted");
+    writer.int_value(static_cast<std::int64_t>(batch.events.size()));
+    writer.end();
+    return writer.result(http::status::accepted);
+}
+
+// GET /telemetry/stats?type=puzzle&value=duration_ms&by=puzzle&from=<ms>&to=<ms>: olay says ve
+// value verildiyse toplam/en kk/en byk. by bir string stunu, value bir say stunu olmaldr.
+route_ptr get_telemetry_stats(const telemetry_store& telemetry, const api_request& req) {
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    telemetry_store::query q;
+    q.type = find_telemetry_type(query_param(target, "type"));
+    q.value = std::string(query_param(target, "value"));
+    q.by = std::string(query_param(target, "by"));
+
+    bool valid = q.type >= 0;
+    for (auto const& bound : { std::make_pair("from", &q.from), std::make_pair("to", &q.to) }) {
+        auto const param = query_param(target, bound.first);
+        if (!param.empty()) {
+            valid = std::from_chars(param.data(), param.data() + param.size(), *bound.second).ec == std::errc() && valid;
+        }
+    }
+    // Stunlar trn emasnda ve doru tipte olmal
+    auto const has_column = [&q](const std::string& name, bool text) {
+        auto const& columns = telemetry_types()[static_cast<std::size_t>(q.type)].columns;
+        const telemetry_field* field = find_telemetry_field(name);
+        return field != nullptr && (field->text != nullptr) == text
+            && std::find_if(columns.begin(), columns.end(), [&name](const char* c) { return name == c; }) != columns.end();
+    };
+    valid = valid && (q.value.empty() || has_column(q.value, false)) && (q.by.empty() || has_column(q.by, true));
+    if (!valid) {
+        return error_result(format, http::status::bad_request, "Gecersiz sorgu");
+    }
+
+    auto const result = telemetry.run(q);
+    bool const has_value = !q.value.empty();
+    body_writer writer(format);
+    writer.begin_object(4);
+    writer.key("type");
+    writer.string_value(telemetry_types()[static_cast<std::size_t>(q.type)].name);
+    writer.key("segments");
+    writer.int_value(static_cast<std::int64_t>(result.segments));
+    writer.key("rows");
+    writer.int_value(static_cast<std::int64_t>(result.rows));
+    writer.key("groups");
+    writer.begin_array(result.groups.size());
+    for (auto const& g : result.groups) {
+        writer.begin_object(has_value && g.count > 0 ? 5 : 2);
+        writer.key("key");
+        writer.string_value(g.key);
+        writer.key("count");
+        writer.int_value(static_cast<std::int64_t>(g.count));
+        if (has_value && g.count > 0) {
+            writer.key("sum");
+            writer.int_value(g.sum);
+            writer.key("min");
+            writer.int_value(g.min);
+            writer.key("max");
+            writer.int_value(g.max);
+        }
+        writer.end();
+    }
+    writer.end();
+    writer.end();
+    return writer.result();
+}
+
+// Skor tablosundan bamsz route'lar (n dmde de bulunur)
+void register_common_routes(router& routes) {
+    routes.add("/login", [](const api_request&) {
+        return make_result(http::status::ok, "application/json",
+            R"({"status": "success", "message": "Giris basarili!"})");
+        }, true);
+
+    // Aama izleme dkm; BACKEND_ADMIN_TOKEN tanmlysa X-Admin-Token bal elemelidir
+    routes.add("/admin/trace", [](const api_request& req) {
+        char const* token = std::getenv("BACKEND_ADMIN_TOKEN");
+        if (token != nullptr && req["X-Admin-Token"] != token) {
+            return make_result(http::status::forbidden, "text/plain", "403 Yetkisiz");
+        }
+        return make_result(http::status::ok, "application/json", trace::registry::instance().dump_chrome_json());
+        });
+}
+
+// Sitenin API route'larn tanmla; paral kurulumda sadece bu parann oyuncularnn skorlar kabul edilir
+void register_routes(router& routes, score_store& scores, const shard_placement& shard) {
+    register_common_routes(routes);
+
+    routes.add_async("/scores", [&scores, shard](const api_request& req, const std::function<router::responder()>& defer) {
+        if (req.method() == http::verb::post) {
+            return post_score(scores, shard, req, defer);
+        }
+        return get_scores(scores, req);
+        });
+
+    routes.add("/scores/rank", [&scores](const api_request& req) {
+        return get_rank(scores, req);
+        });
+
+    routes.add("/scores/ranks", [&scores](const api_request& req) {
+        return post_ranks(scores, req);
+        });
+
+    routes.add("/scores/counts", [&scores](const api_request& req) {
+        return post_counts(scores, req);
+        });
+
+    routes.add_prefix("/scores/around/", [&scores](const api_request& req) {
+        return get_around(scores, req);
+        });
+}
+
+// Paralara (shard) HTTP/1.1 ile istek gnderen istemci. Kendi io thread'inde alr ve her para
+// iin ak (keep-alive) balantlar havuzda tutar; tm callback'ler bu thread'de arlr.
+// Her istein (yeniden deneme dahil) bir sre snr vardr: balanty kabul edip cevap vermeyen
+// bir para n dmdeki istei sonsuza kadar bekletmez, istek 504 ile biter.
+class shard_client {
+public:
+    struct reply {
+        bool ok = false;
+        http::status status = http::status::bad_gateway;
+        std::string content_type;
+        std::string body;
+    };
+
+    using callback = std::function<void(reply)>;
+
+    static constexpr std::chrono::seconds call_timeout{ 3 };
+    static constexpr std::size_t max_idle_per_shard = 64; // fazlas cevaptan sonra kapatlr
+
+private:
+    struct call {
+        std::size_t shard = 0;
+        std::optional<tcp::socket> socket;
+        std::optional<net::steady_timer> deadline;
+        bool reused = false;
+        bool timed_out = false;
+        beast::flat_buffer buffer;
+        http::request<http::string_body> request;
+        http::response<http::string_body> response;
+        callback done;
+    };
+
+    net::io_context ioc_{ 1 };
+    net::executor_work_guard<net::io_context::executor_type> work_ = net::make_work_guard(ioc_);
+    std::vector<tcp::endpoint> shards_;
+    std::vector<std::vector<tcp::socket>> idle_;
+    std::thread thread_;
+
+    void start(std::shared_ptr<call> c) {
+        // Sre dolunca soket kapatlr; bekleyen ilem hatayla dner ve istek oradan biter
+        c->deadline.emplace(ioc_, call_timeout);
+        c->deadline->async_wait([c](beast::error_code ec) {
+            if (ec || !c->socket) {
+                return;
+            }
+            c->timed_out = true;
+            c->socket->close(ec);
+            });
+        auto& idle = idle_[c->shard];
+        if (idle.empty()) {
+            return connect(std::move(c));
+        }
+        c->socket.emplace(std::move(idle.back()));
+        idle.pop_back();
+        c->reused = true;
+        send(std::move(c));
+    }
+
+    void connect(std::shared_ptr<call> c) {
+        c->reused = false;
+        c->socket.emplace(ioc_);
+        tcp::socket& socket = *c->socket;
+        socket.async_connect(shards_[c->shard], [this, c](beast::error_code ec) {
+            if (ec) {
+                return finish(c, false);
+            }
+            c->socket->set_option(tcp::no_delay(true), ec);
+            send(c);
+            });
+    }
+
+    void send(std::shared_ptr<call> c) {
+        http::async_write(*c->socket, c->request, [this, c](beast::error_code ec, std::size_t) {
+            if (ec) {
+                return retry(c);
+            }
+            http::async_read(*c->socket, c->buffer, c->response, [this, c](beast::error_code ec, std::size_t) {
+                if (ec) {
+                    return retry(c);
+                }
+                finish(c, true);
+                });
+            });
+    }
+
+    // Havuzdaki balanty para bu arada kapatm olabilir: bir kez yeni balantyla dene.
+    // Para route'larnn hepsi tekrarlanabilir (skor gnderimi en iyi skoru tutar).
+    void retry(std::shared_ptr<call> c) {
+        if (!c->reused || c->timed_out) {
+            return finish(c, false);
+        }
+        c->buffer.clear();
+        c->response = {};
+        connect(std::move(c));
+    }
+
+    void finish(const std::shared_ptr<call>& c, bool ok) {
+        c->deadline->cancel();
+        reply r;
+        r.ok = ok;
+        if (ok) {
+            r.status = c->response.result();
+            r.content_type = std::string(c->response[http::field::content_type]);
+            r.body = std::move(c->response.body());
+            if (c->response.keep_alive() && !c->timed_out && idle_[c->shard].size() < max_idle_per_shard) {
+                idle_[c->shard].push_back(std::move(*c->socket));
+            }
+        }
+        else if (c->timed_out) {
+            r.status = http::status::gateway_timeout;
+        }
+        c->socket.reset();
+        c->done(std::move(r));
+    }
+
+public:
+    explicit shard_client(std::vector<tcp::endpoint> shards)
+        : shards_(std::move(shards)), idle_(shards_.size()) {
+        thread_ = std::thread([this] { ioc_.run(); });
+    }
+
+    ~shard_client() {
+        stop();
+    }
+
+    std::size_t size() const {
+        return shards_.size();
+    }
+
+    // Herhangi bir thread'den arlabilir. Paralar aras istek ve cevaplar JSON'dur.
+    void request(std::size_t shard, http::verb method, std::string target, std::string body, callback done) {
+        auto c = std::make_shared<call>();
+        c->shard = shard;
+        c->request.method(method);
+        c->request.target(target);
+        c->request.version(11);
+        c->request.set(http::field::host, "localhost");
+        if (!body.empty()) {
+            c->request.set(http::field::content_type, "application/json");
+        }
+        c->request.body() = std::move(body);
+        c->request.prepare_payload();
+        c->done = std::move(done);
+        net::post(ioc_, [this, c] { start(c); });
+    }
+
+    // stemcinin isteini gvdesi ve biim balklaryla (Content-Type, Accept) aynen ilet
+    void forward(std::size_t shard, const api_request& req, callback done) {
+        auto c = std::make_shared<call>();
+        c->shard = shard;
+        c->request.method(req.method());
+        c->request.target(req.target());
+        c->request.version(11);
+        c->request.set(http::field::host, "localhost");
+        for (auto const field : { http::field::content_type, http::field::accept }) {
+            if (req.count(field) != 0) {
+                c->request.set(field, req[field]);
+            }
+        }
+        c->request.body() = req.body();
+        c->request.prepare_payload();
+        c->done = std::move(done);
+        net::post(ioc_, [this, c] { start(c); });
+    }
+
+    // Ayn istei tm paralara gnder; hepsi cevaplannca done(cevaplar) para srasyla arlr
+    void broadcast(http::verb method, const std::string& target, const std::string& body, std::function<void(std::vector<reply>)> done) {
+        struct gather {
+            std::vector<reply> replies;
+            std::size_t remaining;
+            std::function<void(std::vector<reply>)> done;
+        };
+        auto g = std::make_shared<gather>(gather{ std::vector<reply>(size()), size(), std::move(done) });
+        for (std::size_t i = 0; i < size(); ++i) {
+            request(i, method, target, body, [g, i](reply r) {
+                g->replies[i] = std::move(r);
+                if (--g->remaining == 0) {
+                    g->done(std::move(g->replies));
+                }
+                });
+        }
+    }
+
+    void stop() {
+        work_.reset();
+        ioc_.stop();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+};
+
+// Para cevabn aynen ilet; paraya ulalamadysa 502, sresinde cevap vermediyse 504
+inline route_ptr relay(body_format format, const shard_client::reply& r) {
+    if (!r.ok && r.status == http::status::gateway_timeout) {
+        return error_result(format, r.status, "Parca zamaninda cevap vermedi");
+    }
+    if (!r.ok) {
+        return error_result(format, http::status::bad_gateway, "Parca cevap vermedi");
+    }
+    return make_result(r.status, r.content_type, r.body);
+}
+
+inline bool shard_failed(const shard_client::reply& r) {
+    return !r.ok || r.status != http::status::ok;
+}
+
+inline route_ptr bad_shard_reply(body_format format) {
+    return error_result(format, http::status::bad_gateway, "Parca cevabi okunamadi");
+}
+
+// Para cevabndaki {"scores": [{"user": ..., "score": ..., "rank": ...}, ...]} listesini oku
+// (rank 1 tabanl gelir, 0 tabanl saklanr; yoksa 0)
+inline bool parse_score_list(std::string_view body, std::vector<leaderboard::ranked_entry>& out) {
+    out.clear();
+    json_object_reader reader(body);
+    std::string key;
+    std::vector<std::string_view> items;
+    while (reader.next_key(key)) {
+        if (key == "scores") {
+            reader.read_array_items(items);
+        }
+        else {
+            reader.skip_value();
+        }
+    }
+    if (!reader.ok()) {
+        return false;
+    }
+    for (auto item : items) {
+        json_object_reader fields(item);
+        leaderboard::ranked_entry e{ {}, 0, 0 };
+        std::int64_t rank = 0;
+        while (fields.next_key(key)) {
+            if (key == "user") {
+                fields.read_string(e.player);
+            }
+            else if (key == "score") {
+                fields.read_int(e.score);
+            }
+            else if (key == "rank") {
+                fields.read_int(rank);
+            }
+            else {
+                fields.skip_value();
+            }
+        }
+        if (!fields.ok()) {
+            return false;
+        }
+        e.rank = rank > 0 ? static_cast<std::size_t>(rank - 1) : 0;
+        out.push_back(std::move(e));
+    }
+    return true;
+}
+
+// Paralara giden sorgulardaki "window" ve "ago" alanlar
+inline void write_window_fields(body_writer& writer, score_window window, std::int64_t ago) {
+    writer.key("window");
+    writer.string_value(window_name(window));
+    writer.key("ago");
+    writer.int_value(ago);
+}
+
+// POST /scores/counts istei ve cevab
+inline std::string counts_request(const std::vector<std::int64_t>& values, score_window window, std::int64_t ago) {
+    body_writer writer(body_format::json);
+    writer.begin_object(3);
+    writer.key("scores");
+    writer.begin_array(values.size());
+    for (auto const value : values) {
+        writer.int_value(value);
+    }
+    writer.end();
+    write_window_fields(writer, window, ago);
+    writer.end();
+    return writer.take();
+}
+
+inline bool parse_counts(std::string_view body, std::size_t expected, std::vector<std::int64_t>& counts) {
+    json_object_reader reader(body);
+    std::string key;
+    while (reader.next_key(key)) {
+        if (key == "counts") {
+            reader.read_int_array(counts, expected);
+        }
+        else {
+            reader.skip_value();
+        }
+    }
+    return reader.ok() && counts.size() == expected;
+}
+
+// GET /scores (n dm): her paradan ilk K alnr ve skorlara gre k-yollu birletirilir.
+// Eit skorlarda dk numaral para nce gelir.
+route_ptr front_top(shard_client& shards, const api_request& req, const std::function<router::responder()>& defer) {
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::size_t const limit = query_size(target, "limit", 10, 1000);
+    score_window window;
+    std::int64_t ago;
+    if (!parse_window_query(target, window, ago)) {
+        return bad_window(format);
+    }
+    shards.broadcast(http::verb::get, std::string(target), {}, [format, limit, done = defer()](std::vector<shard_client::reply> replies) {
+        std::vector<std::vector<leaderboard::ranked_entry>> lists(replies.size());
+        for (std::size_t i = 0; i < replies.size(); ++i) {
+            if (shard_failed(replies[i])) {
+                return done(relay(format, replies[i]));
+            }
+            if (!parse_score_list(replies[i].body, lists[i])) {
+                return done(bad_shard_reply(format));
+            }
+        }
+
+        struct cursor {
+            std::int64_t score;
+            std::size_t shard;
+            std::size_t index;
+        };
+        auto const worse = [](const cursor& a, const cursor& b) {
+            return a.score != b.score ? a.score < b.score : a.shard > b.shard;
+        };
+        std::priority_queue<cursor, std::vector<cursor>, decltype(worse)> heads(worse);
+        for (std::size_t i = 0; i < lists.size(); ++i) {
+            if (!lists[i].empty()) {
+                heads.push({ lists[i][0].score, i, 0 });
+            }
+        }
+
+        std::vector<leaderboard::ranked_entry> merged;
+        while (merged.size() < limit && !heads.empty()) {
+            cursor const c = heads.top();
+            heads.pop();
+            merged.push_back(std::move(lists[c.shard][c.index]));
+            if (c.index + 1 < lists[c.shard].size()) {
+                heads.push({ lists[c.shard][c.index + 1].score, c.shard, c.index + 1 });
+            }
+        }
+        done(top_response(format, merged));
+        });
+    return nullptr;
+}
+
+// GET /scores/rank (n dm): oyuncunun parasndaki sraya dier paralarda ondan yksek skorlu
+// oyuncu saylar eklenir. Paralar aras eit skorlar oyuncunun arkasnda saylr.
+route_ptr front_rank(shard_client& shards, const api_request& req, const std::function<router::responder()>& defer) {
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string user;
+    score_window window;
+    std::int64_t ago;
+    if (!percent_decode(query_param(target, "user"), user) || user.empty()) {
+        return player_not_found(format);
+    }
+    if (!parse_window_query(target, window, ago)) {
+        return bad_window(format);
+    }
+    std::size_t const owner = shard_placement::owner(user, shards.size());
+    shards.request(owner, http::verb::get, std::string(target), {},
+        [&shards, format, owner, window, ago, done = defer()](shard_client::reply r) {
+        if (shard_failed(r)) {
+            return done(relay(format, r));
+        }
+        json_object_reader reader(r.body);
+        std::string key;
+        leaderboard::ranked_entry e{ {}, 0, 0 };
+        std::int64_t rank = 0;
+        while (reader.next_key(key)) {
+            if (key == "user") {
+                reader.read_string(e.player);
+            }
+            else if (key == "score") {
+                reader.read_int(e.score);
+            }
+            else if (key == "rank") {
+                reader.read_int(rank);
+            }
+            else {
+                reader.skip_value();
+            }
+        }
+        if (!reader.ok() || rank < 1) {
+            return done(bad_shard_reply(format));
+        }
+        e.rank = static_cast<std::size_t>(rank - 1);
+
+        shards.broadcast(http::verb::post, "/scores/counts", counts_request({ e.score }, window, ago),
+            [format, owner, e, done](std::vector<shard_client::reply> replies) mutable {
+            for (std::size_t i = 0; i < replies.size(); ++i) {
+                if (i == owner) {
+                    continue;
+                }
+                std::vector<std::int64_t> counts;
+                if (shard_failed(replies[i])) {
+                    return done(relay(format, replies[i]));
+                }
+                if (!parse_counts(replies[i].body, 1, counts)) {
+                    return done(bad_shard_reply(format));
+                }
+                e.rank += static_cast<std::size_t>(counts[0]);
+            }
+            body_writer writer(format);
+            write_ranked(writer, e);
+            done(writer.result());
+            });
+        });
+    return nullptr;
+}
+
+// POST /scores/ranks (n dm): oyuncular paralarna gre gruplanr, her para kendi alt kmesini
+// tek geite sralar; ardndan tm farkl skorlar iin paralardan stteki oyuncu saylar tek
+// istekte alnr ve her oyuncunun para ii srasna dier paralarn saylar eklenir.
+route_ptr front_ranks(shard_client& shards, const api_request& req, const std::function<router::responder()>& defer) {
+    auto const format = response_format(req);
+    ranks_query query;
+    if (!decode_body(req, query)) {
+        return error_result(format, http::status::bad_request, "Gecersiz istek");
+    }
+    score_window const window = query.window;
+    std::int64_t const ago = query.ago;
+
+    struct gather {
+        std::vector<std::vector<leaderboard::ranked_entry>> found;
+        std::size_t remaining = 0;
+        bool failed = false;
+        router::responder done;
+    };
+    auto g = std::make_shared<gather>();
+    g->found.resize(shards.size());
+    g->done = defer();
+
+    std::vector<std::vector<std::string>> groups(shards.size());
+    for (auto& user : query.users) {
+        groups[shard_placement::owner(user, shards.size())].push_back(std::move(user));
+    }
+    for (auto const& group : groups) {
+        g->remaining += group.empty() ? 0 : 1;
+    }
+    if (g->remaining == 0) {
+        g->done(ranks_response(format, {}));
+        return nullptr;
+    }
+
+    // Tm paralarn alt kme cevaplar gelince: skorlarn stndeki oyuncu saylarn topla
+    auto const merge = [&shards, format, window, ago](std::shared_ptr<gather> g) {
+        std::vector<std::int64_t> values;
+        for (auto const& list : g->found) {
+            for (auto const& e : list) {
+                values.push_back(e.score);
+            }
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+
+        shards.broadcast(http::verb::post, "/scores/counts", counts_request(values, window, ago),
+            [g, format, values](std::vector<shard_client::reply> replies) {
+            std::vector<std::vector<std::int64_t>> counts(replies.size());
+            for (std::size_t i = 0; i < replies.size(); ++i) {
+                if (shard_failed(replies[i])) {
+                    return g->done(relay(format, replies[i]));
+                }
+                if (!parse_counts(replies[i].body, values.size(), counts[i])) {
+                    return g->done(bad_shard_reply(format));
+                }
+            }
+            std::vector<leaderboard::ranked_entry> all;
+            for (std::size_t shard = 0; shard < g->found.size(); ++shard) {
+                for (auto& e : g->found[shard]) {
+                    std::size_t const v = static_cast<std::size_t>(std::lower_bound(values.begin(), values.end(), e.score) - values.begin());
+                    for (std::size_t i = 0; i < counts.size(); ++i) {
+                        if (i != shard) {
+                            e.rank += static_cast<std::size_t>(counts[i][v]);
+                        }
+                    }
+                    all.push_back(std::move(e));
+                }
+            }
+            std::sort(all.begin(), all.end(), [](const leaderboard::ranked_entry& a, const leaderboard::ranked_entry& b) {
+                return a.rank < b.rank;
+                });
+            g->done(ranks_response(format, all));
+            });
+    };
+
+    for (std::size_t shard = 0; shard < groups.size(); ++shard) {
+        if (groups[shard].empty()) {
+            continue;
+        }
+        body_writer writer(body_format::json);
+        writer.begin_object(3);
+        writer.key("users");
+        writer.begin_array(groups[shard].size());
+        for (auto const& user : groups[shard]) {
+            writer.string_value(user);
+        }
+        writer.end();
+        write_window_fields(writer, window, ago);
+        writer.end();
+        shards.request(shard, http::verb::post, "/scores/ranks", writer.take(), [g, format, shard, merge](shard_client::reply r) {
+            if (g->failed) {
+                return;
+            }
+            if (shard_failed(r) || !parse_score_list(r.body, g->found[shard])) {
+                g->failed = true;
+                return g->done(shard_failed(r) ? relay(format, r) : bad_shard_reply(format));
+            }
+            if (--g->remaining == 0) {
+                merge(g);
+            }
+            });
+    }
+    return nullptr;
+}
+
+// POST /scores (n dm): gnderim, oyuncunun hash'ine gre sahibi olan paraya biimi
+// deitirilmeden iletilir
+route_ptr front_submit(shard_client& shards, const api_request& req, const std::function<router::responder()>& defer) {
+    auto const format = response_format(req);
+    score_submission submission;
+    if (!decode_body(req, submission) || submission.user.empty()) {
+        return error_result(format, http::status::bad_request, "Gecersiz skor");
+    }
+    shards.forward(shard_placement::owner(submission.user, shards.size()), req,
+        [format, done = defer()](shard_client::reply r) { done(relay(format, r)); });
+    return nullptr;
+}
+
+// Telemetri route'lar (para ve tek sunucu modunda; her sre kendi telemetrisini tutar)
+void register_telemetry_routes(router& routes, telemetry_store& telemetry) {
+    routes.add("/telemetry", [&telemetry](const api_request& req) {
+        return post_telemetry(telemetry, req);
+        });
+
+    routes.add("/telemetry/stats", [&telemetry](const api_request& req) {
+        return get_telemetry_stats(telemetry, req);
+        });
+}
+
+// n dmn route'lar: skor tablosu tutulmaz, skor istekleri paralara datlr
+void register_front_routes(router& routes, shard_client& shards) {
+    register_common_routes(routes);
+
+    routes.add_async("/scores", [&shards](const api_request& req, const std::function<router::responder()>& defer) {
+        if (req.method() == http::verb::post) {
+            return front_submit(shards, req, defer);
+        }
+        return front_top(shards, req, defer);
+        });
+
+    routes.add_async("/scores/rank", [&shards](const api_request& req, const std::function<router::responder()>& defer) {
+        return front_rank(shards, req, defer);
+        });
+
+    routes.add_async("/scores/ranks", [&shards](const api_request& req, const std::function<router::responder()>& defer) {
+        return front_ranks(shards, req, defer);
+        });
+
+    routes.add_prefix("/scores/around/", [](const api_request& req) {
+        return error_result(response_format(req), http::status::not_implemented, "Parcali kurulumda desteklenmiyor");
+        });
+}
+
+// ndirmelerin toplam bant geniliini balantlar arasnda adil paylatran zamanlayc.
+// Her 10 ms'de rate/100 baytlk bte nce istemciler (IP) arasnda, sonra her istemcinin
+// bekleyen balantlar arasnda max-min adil datlr: payndan az isteyen istediini alr,
+// artan bte dierlerine kalr. ok balant aan istemci dierlerinin payn yiyemez.
+class bandwidth_scheduler {
+public:
+    // zin verilen bayt saysyla (> 0) arlr
+    using grant_fn = std::function<void(std::size_t)>;
+
+private:
+    struct waiter {
+        std::string client;
+        std::size_t want;
+        std::size_t granted;
+        grant_fn grant;
+    };
+
+    static constexpr auto tick = std::chrono::milliseconds(10);
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<waiter> waiting_;
+    std::uint64_t rate_ = 0; // bayt/saniye; 0 = snrsz
+    bool stopping_ = false;
+    std::thread thread_;
+
+    bandwidth_scheduler() = default;
+
+public:
+    static bandwidth_scheduler& instance() {
+        static bandwidth_scheduler scheduler;
+        return scheduler;
+    }
+
+    ~bandwidth_scheduler() {
+        stop();
+    }
+
+    // Toplam indirme hzn ayarla; sunucu balamadan nce arlr
+    void set_rate(std::uint64_t bytes_per_second) {
+        rate_ = bytes_per_second;
+        if (rate_ != 0 && !thread_.joinable()) {
+            thread_ = std::thread([this] { run(); });
+        }
+    }
+
+    std::uint64_t rate() const {
+        return rate_;
+    }
+
+    // want bayta kadar gnderme izni iste. Snr yoksa grant hemen arlr; varsa
+    // zamanlayc thread'inden, sradaki datmda (ksmi izin olabilir)
+    void acquire(std::string client, std::size_t want, grant_fn grant) {
+        if (rate_ == 0) {
+            return grant(want);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            waiting_.push_back({ std::move(client), want, 0, std::move(grant) });
+        }
+    }
+
+    void stop() {
+        std::vector<waiter> dropped;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            dropped.swap(waiting_);
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    void run() {
+        std::vector<waiter> ready;
+        auto next = std::chrono::steady_clock::now() + tick;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!wake_.wait_until(lock, next, [this] { return stopping_; })) {
+            // Geride kalndysa karlan turlarn btesi biriktirilmez (ani patlama olmasn)
+            next = std::max(next + tick, std::chrono::steady_clock::now());
+            distribute(std::max<std::uint64_t>(1, rate_ / 100), ready);
+            lock.unlock();
+            for (auto& w : ready) {
+                w.grant(w.granted);
+            }
+            ready.clear();
+            lock.lock();
+        }
+    }
+
+    // Bteyi su doldurarak dat; izin alan bekleyenler ready'ye tanr
+    void distribute(std::uint64_t budget, std::vector<waiter>& ready) {
+        std::map<std::string_view, std::vector<std::size_t>> clients;
+        for (std::size_t i = 0; i < waiting_.size(); ++i) {
+            clients[waiting_[i].client].push_back(i);
+        }
+        while (budget > 0 && !clients.empty()) {
+            std::uint64_t const client_share = std::max<std::uint64_t>(1, budget / clients.size());
+            for (auto it = clients.begin(); it != clients.end() && budget > 0;) {
+                auto& members = it->second;
+                std::uint64_t client_budget = std::min(client_share, budget);
+                std::uint64_t const share = std::max<std::uint64_t>(1, client_budget / members.size());
+                for (std::size_t k = 0; k < members.size() && client_budget > 0;) {
+                    waiter& w = waiting_[members[k]];
+                    std::uint64_t const give = std::min<std::uint64_t>({ share, client_budget, w.want - w.granted });
+                    w.granted += static_cast<std::size_t>(give);
+                    client_budget -= give;
+                    budget -= give;
+                    if (w.granted == w.want) {
+                        members[k] = members.back();
+                        members.pop_back();
+                    }
+                    else {
+                        ++k;
+                    }
+                }
+                it = members.empty() ? clients.erase(it) : std::next(it);
+            }
+        }
+        auto const split = std::stable_partition(waiting_.begin(), waiting_.end(),
+            [](const waiter& w) { return w.granted == 0; });
+        std::move(split, waiting_.end(), std::back_inserter(ready));
+        waiting_.erase(split, waiting_.end());
+    }
+};
+
+// ndirme dizinindeki dosyalar iin dosya bana ezamanl indirme snr ve bekleme sras.
+// Snr doluysa istemci sraya bir biletle (ticket) girer ve 503 + Retry-After alr; bileti ile
+// tekrar sorduunda nndeki bilet says bo yuvalardan azsa yuvay alr.
+// ticket_timeout boyunca tekrar sormayan biletler sradan der.
+class download_manager {
+private:
+    struct queued {
+        std::uint64_t ticket;
+        std::chrono::steady_clock::time_point last_seen;
+    };
+
+    struct file_state {
+        unsigned active = 0;
+        std::deque<queued> queue;
+    };
+
+    static constexpr std::chrono::seconds ticket_timeout{ 15 };
+    static constexpr std::size_t max_queue = 100000;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, file_state> files_;
+    std::uint64_t next_ticket_ = 1;
+    std::filesystem::path directory_;
+    unsigned slots_;
+
+public:
+    download_manager(std::filesystem::path directory, unsigned slots)
+        : directory_(std::move(directory)), slots_(std::max(1u, slots)) {
+    }
+
+    const std::filesystem::path& directory() const {
+        return directory_;
+    }
+
+    // Yuva alndysa true. Alnamadysa ticket (verilen geersizse yenisi) ve sradaki konum
+    // (1'den balar) doldurulur; sra da doluysa ticket 0 olur.
+    bool try_enter(const std::string& name, std::uint64_t& ticket, std::size_t& position) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file_state& f = files_[name];
+        auto const now = std::chrono::steady_clock::now();
+        f.queue.erase(std::remove_if(f.queue.begin(), f.queue.end(),
+            [now](const queued& q) { return now - q.last_seen > ticket_timeout; }), f.queue.end());
+
+        std::size_t const free = f.active < slots_ ? slots_ - f.active : 0;
+        auto it = std::find_if(f.queue.begin(), f.queue.end(),
+            [ticket](const queued& q) { return q.ticket == ticket; });
+        if (it == f.queue.end()) {
+            if (f.queue.size() < free) {
+                ++f.active;
+                return true;
+            }
+            if (f.queue.size() >= max_queue) {
+                ticket = 0;
+                position = f.queue.size();
+                return false;
+            }
+            f.queue.push_back({ next_ticket_++, now });
+            it = std::prev(f.queue.end());
+        }
+
+        std::size_t const index = static_cast<std::size_t>(it - f.queue.begin());
+        if (index < free) {
+            f.queue.erase(it);
+            ++f.active;
+            return true;
+        }
+        it->last_seen = now;
+        ticket = it->ticket;
+        position = index + 1;
+        return false;
+    }
+
+    void leave(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(name);
+        if (it == files_.end()) {
+            return;
+        }
+        --it->second.active;
+        if (it->second.active == 0 && it->second.queue.empty()) {
+            files_.erase(it);
+        }
+    }
+};
+
+// ndirilebilir dosya ad: dizin ayrcs, ".." ve gizli dosya iermez. Ad Content-Disposition'a
+// trnak iinde aynen yazldndan kontrol karakteri ve trnak da kabul edilmez (balk blnmesin)
+inline bool valid_download_name(std::string_view name) {
+    return !name.empty() && name.size() <= 255 && name.front() != '.'
+        && name.find_first_of(std::string_view("/\\\0", 3)) == std::string_view::npos
+        && name.find("..") == std::string_view::npos
+        && std::none_of(name.begin(), name.end(), [](char ch) {
+            auto const c = static_cast<unsigned char>(ch);
+            return c < 0x20 || c == 0x7f || c == '"';
+            });
+}
+
+// Ak dosyann boyutu ve son deiiklik zaman; normal dosya deilse false
+inline bool stat_file(std::FILE* file, std::uint64_t& size, std::time_t& modified) {
+#if defined(_WIN32)
+    struct _stat64 st;
+    if (_fstat64(_fileno(file), &st) != 0 || (st.st_mode & _S_IFREG) == 0) {
+        return false;
+    }
+#else
+    struct stat st;
+    if (::fstat(fileno(file), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+#endif
+    size = static_cast<std::uint64_t>(st.st_size);
+    modified = st.st_mtime;
+    return true;
+}
+
+// Zaman HTTP tarih biiminde (IMF-fixdate) yaz
+inline std::string imf_date(std::time_t t) {
+    std::tm utc{};
+#if defined(_WIN32)
+    gmtime_s(&utc, &t);
+#else
+    gmtime_r(&t, &utc);
+#endif
+    char text[32];
+    return std::string(text, std::strftime(text, sizeof(text), "%a, %d %b %Y %H:%M:%S GMT", &utc));
+}
+
+enum class byte_range { none, satisfiable, unsatisfiable };
+
+// Range balndaki tek aral ("bytes=a-b", "bytes=a-", "bytes=-n") [first, last] olarak z.
+// Balk yoksa, anlalmazsa veya birden ok aralk ieriyorsa none: tm dosya gnderilir.
+inline byte_range parse_byte_range(std::string_view header, std::uint64_t size, std::uint64_t& first, std::uint64_t& last) {
+    static constexpr std::string_view unit = "bytes=";
+    if (header.substr(0, unit.size()) != unit || header.find(',') != std::string_view::npos) {
+        return byte_range::none;
+    }
+    std::string_view spec = header.substr(unit.size());
+    while (!spec.empty() && spec.front() == ' ') {
+        spec.remove_prefix(1);
+    }
+    while (!spec.empty() && spec.back() == ' ') {
+        spec.remove_suffix(1);
+    }
+    auto const dash = spec.find('-');
+    if (dash == std::string_view::npos) {
+        return byte_range::none;
+    }
+    auto const parse = [](std::string_view text, std::uint64_t& value) {
+        auto const r = std::from_chars(text.data(), text.data() + text.size(), value);
+        return !text.empty() && r.ec == std::errc() && r.ptr == text.data() + text.size();
+    };
+
+    if (dash == 0) {
+        std::uint64_t suffix = 0;
+        if (!parse(spec.substr(1), suffix)) {
+            return byte_range::none;
+        }
+        if (suffix == 0 || size == 0) {
+            return byte_range::unsatisfiable;
+        }
+        first = size - std::min(suffix, size);
+        last = size - 1;
+        return byte_range::satisfiable;
+    }
+
+    std::uint64_t end = 0;
+    if (!parse(spec.substr(0, dash), first)
+        || (dash + 1 < spec.size() && (!parse(spec.substr(dash + 1), end) || end < first))) {
+        return byte_range::none;
+    }
+    if (first >= size) {
+        return byte_range::unsatisfiable;
+    }
+    last = dash + 1 < spec.size() ? std::min(end, size - 1) : size - 1;
+    return byte_range::satisfiable;
+}
+
+// Dosyay okumak iin a; boyutu ve deiiklik zaman da dner. Normal dosya deilse nullptr.
+inline std::shared_ptr<file_body> open_file_body(const std::filesystem::path& path, std::uint64_t& size, std::time_t& modified) {
+    auto file = std::make_shared<file_body>();
+#if defined(_WIN32)
+    file->file = _wfopen(path.c_str(), L"rb");
+#else
+    file->file = std::fopen(path.c_str(), "rb");
+#endif
+    if (file->file == nullptr || !stat_file(file->file, size, modified)) {
+        return nullptr;
+    }
+    return file;
+}
+
+// Ak dosyann 200/206/416 cevab. Tek aralkl Range ve If-Range (gl ETag veya tarih)
+// desteklenir; 416 dnda dosya cevaba balanr ve gvde sendfile ile gider.
+std::shared_ptr<route_result> file_result(const api_request& req, std::shared_ptr<file_body> file,
+    std::uint64_t size, const std::string& etag, std::time_t modified) {
+    std::string const last_modified = imf_date(modified);
+    auto result = std::make_shared<route_result>();
+    result->content_type = "application/octet-stream";
+    result->headers = {
+        { "Accept-Ranges", "bytes" },
+        { "ETag", etag },
+        { "Last-Modified", last_modified },
+    };
+
+    // If-Range (gl ETag veya tarih) elemiyorsa dosya deimitir: aralk yok saylr
+    std::uint64_t first = 0, last = size == 0 ? 0 : size - 1;
+    auto const range_header = req[http::field::range];
+    auto range = parse_byte_range({ range_header.data(), range_header.size() }, size, first, last);
+    auto const if_range = std::string_view(req[http::field::if_range].data(), req[http::field::if_range].size());
+    if (!if_range.empty() && if_range != etag && if_range != last_modified) {
+        range = byte_range::none;
+        first = 0;
+        last = size == 0 ? 0 : size - 1;
+    }
+    if (range == byte_range::unsatisfiable) {
+        result->status = http::status::range_not_satisfiable;
+        result->content_type = "text/plain";
+        result->body = std::make_shared<const std::string>("416 Aralik karsilanamiyor");
+        result->headers.emplace_back("Content-Range", "bytes */" + std::to_string(size));
+        return result;
+    }
+    if (range == byte_range::satisfiable) {
+        result->status = http::status::partial_content;
+        result->headers.emplace_back("Content-Range",
+            "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(size));
+    }
+    file->offset = first;
+    file->length = size == 0 ? 0 : last - first + 1;
+    result->file = std::move(file);
+    return result;
+}
+
+// GET/HEAD /download/<dosya>[?ticket=N]: indirme dizinindeki bir dosyay gnderir.
+// Dosya bana ezamanl indirme snr doluysa 503 ile sradaki konum dner.
+route_ptr get_download(const std::shared_ptr<download_manager>& downloads, const api_request& req) {
+    static constexpr std::string_view prefix = "/download/";
+    auto const format = response_format(req);
+    if (req.method() != http::verb::get && req.method() != http::verb::head) {
+        return error_result(format, http::status::method_not_allowed, "Sadece GET ve HEAD");
+    }
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string name;
+    if (!percent_decode(target.substr(prefix.size(), target.find('?') - prefix.size()), name) || !valid_download_name(name)) {
+        return error_result(format, http::status::bad_request, "Gecersiz dosya adi");
+    }
+
+    std::uint64_t size = 0;
+    std::time_t modified = 0;
+    auto file = open_file_body(downloads->directory() / name, size, modified);
+    if (!file) {
+        return error_result(format, http::status::not_found, "Dosya bulunamadi");
+    }
+    char etag[48];
+    std::snprintf(etag, sizeof(etag), "\"%llx-%llx\"",
+        static_cast<unsigned long long>(size), static_cast<unsigned long long>(modified));
+    auto result = file_result(req, std::move(file), size, etag, modified);
+    if (result->status == http::status::ok) {
+        result->headers.emplace_back("Content-Disposition", "attachment; filename=\"" + name + "\"");
+    }
+
+    // HEAD gvde gndermez, yuva almaz
+    if (req.method() == http::verb::get && result->file && result->file->length != 0) {
+        std::uint64_t ticket = 0;
+        auto const param = query_param(target, "ticket");
+        std::from_chars(param.data(), param.data() + param.size(), ticket);
+        std::size_t position = 0;
+        if (!downloads->try_enter(name, ticket, position)) {
+            body_writer writer(format);
+            writer.begin_object(3);
+            writer.key("status");
+            writer.string_value(ticket == 0 ? "full" : "queued");
+            writer.key("ticket");
+            writer.int_value(static_cast<std::int64_t>(ticket));
+            writer.key("position");
+            writer.int_value(static_cast<std::int64_t>(position));
+            writer.end();
+            auto queued = std::make_shared<route_result>();
+            queued->status = http::status::service_unavailable;
+            queued->content_type = content_type_of(format);
+            queued->body = std::make_shared<const std::string>(writer.take());
+            queued->headers.emplace_back("Retry-After", ticket == 0 ? "30" : "5");
+            return queued;
+        }
+        result->file->release = [downloads, name] { downloads->leave(name); };
+    }
+    return result;
+}
+
+void register_download_routes(router& routes, const std::shared_ptr<download_manager>& downloads) {
+    routes.add_prefix("/download/", [downloads](const api_request& req) {
+        return get_download(downloads, req);
+        });
+}
+
+// kili fark (delta) yamas: yeni srm, eski srmden kopyalanan aralklar ve yeni baytlarla tarif edilir.
+// Dosya: "NRPD" u32 srm, eski SHA-256 [32], yeni SHA-256 [32], eski boyut u64, yeni boyut u64,
+// ardndan ilemler: 'C' u64 eski konum u64 uzunluk | 'A' u32 uzunluk + bayt | 'E' (son).
+// Saylar little-endian; istemci sonucu yeni SHA-256 ile dorular.
+namespace delta {
+
+constexpr char magic[4] = { 'N', 'R', 'P', 'D' };
+constexpr std::uint32_t version = 1;
+constexpr std::size_t header_size = 4 + 4 + 32 + 32 + 8 + 8;
+// Eski srm bu boyutta bloklarla indekslenir; yeni srmde her bayt konumunda aranr
+constexpr std::size_t block = 4096;
+constexpr std::size_t max_literal = 64 * 1024;
+constexpr std::uint64_t prime = 0x100000001b3ULL;
+
+// Blok zerinde kaydrlabilir polinom hash (mod 2^64)
+inline std::uint64_t hash_block(const char* p) {
+    std::uint64_t h = 0;
+    for (std::size_t i = 0; i < block; ++i) {
+        h = h * prime + static_cast<unsigned char>(p[i]);
+    }
+    return h;
+}
+
+// prime^(block-1): pencereden kan baytn katsays
+inline std::uint64_t leading_factor() {
+    std::uint64_t f = 1;
+    for (std::size_t i = 1; i < block; ++i) {
+        f *= prime;
+    }
+    return f;
+}
+
+// Eski srmn blok hash'lerinden blok numarasna ak adresli tablo (ayn hash'te ilk blok kalr)
+class block_index {
+private:
+    static constexpr std::uint32_t empty = UINT32_MAX;
+    std::vector<std::uint64_t> keys_;
+    std::vector<std::uint32_t> blocks_;
+    int shift_ = 64;
+
+    std::size_t slot(std::uint64_t h) const {
+        return static_cast<std::size_t>(((h ^ (h >> 29)) * 0xbf58476d1ce4e5b9ULL) >> shift_);
+    }
+
+public:
+    static constexpr std::uint32_t npos = empty;
+
+    explicit block_index(const std::vector<std::uint64_t>& hashes) {
+        std::size_t capacity = 16;
+        shift_ = 60;
+        while (capacity < hashes.size() * 2) {
+            capacity *= 2;
+            --shift_;
+        }
+        keys_.assign(capacity, 0);
+        blocks_.assign(capacity, empty);
+        for (std::size_t b = 0; b < hashes.size(); ++b) {
+            std::size_t i = slot(hashes[b]);
+            while (blocks_[i] != empty && keys_[i] != hashes[b]) {
+                i = (i + 1) & (capacity - 1);
+            }
+            if (blocks_[i] == empty) {
+                keys_[i] = hashes[b];
+                blocks_[i] = static_cast<std::uint32_t>(b);
+            }
+        }
+    }
+
+    std::uint32_t find(std::uint64_t h) const {
+        for (std::size_t i = slot(h);; i = (i + 1) & (keys_.size() - 1)) {
+            if (blocks_[i] == empty || keys_[i] == h) {
+                return blocks_[i];
+            }
+        }
+    }
+};
+
+// Konumunu hatrlayan okuyucu: ardk okumalarda seek (ve stdio tamponunun atlmas) yaplmaz
+class positioned_file {
+private:
+    std::FILE* file_;
+    std::uint64_t position_ = UINT64_MAX;
+
+public:
+    explicit positioned_file(std::FILE* file) : file_(file) {
+    }
+
+    bool read(std::uint64_t at, char* out, std::size_t n) {
+        if (at != position_ && !seek_file(file_, at)) {
+            position_ = UINT64_MAX;
+            return false;
+        }
+        bool const ok = std::fread(out, 1, n, file_) == n;
+        position_ = ok ? at + n : UINT64_MAX;
+        return ok;
+    }
+};
+
+// lemleri kodlayp 1 MB'lk paralar halinde dosyaya yazar; bitiik kopyalar birletirilir
+class op_writer {
+private:
+    std::FILE* out_;
+    std::string pending_;
+    std::string literal_;
+    std::uint64_t copy_offset_ = 0;
+    std::uint64_t copy_length_ = 0;
+    bool ok_ = true;
+
+    template <class T>
+    void put(T value) {
+        pending_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void flush_literal() {
+        if (!literal_.empty()) {
+            pending_.push_back('A');
+            put(static_cast<std::uint32_t>(literal_.size()));
+            pending_ += literal_;
+            literal_.clear();
+            drain(false);
+        }
+    }
+
+    void flush_copy() {
+        if (copy_length_ != 0) {
+            pending_.push_back('C');
+            put(copy_offset_);
+            put(copy_length_);
+            copy_length_ = 0;
+            drain(false);
+        }
+    }
+
+    void drain(bool force) {
+        if (pending_.size() >= (force ? 1 : 1 << 20)) {
+            ok_ = ok_ && std::fwrite(pending_.data(), 1, pending_.size(), out_) == pending_.size();
+            pending_.clear();
+        }
+    }
+
+public:
+    explicit op_writer(std::FILE* out) : out_(out) {
+    }
+
+    void literal(const char* p, std::size_t n) {
+        flush_copy();
+        while (n > 0) {
+            std::size_t const take = std::min(n, max_literal - literal_.size());
+            literal_.append(p, take);
+            p += take;
+            n -= take;
+            if (literal_.size() == max_literal) {
+                flush_literal();
+            }
+        }
+    }
+
+    void copy(std::uint64_t offset, std::uint64_t length) {
+        flush_literal();
+        if (copy_length_ != 0 && copy_offset_ + copy_length_ == offset) {
+            copy_length_ += length;
+            return;
+        }
+        flush_copy();
+        copy_offset_ = offset;
+        copy_length_ = length;
+    }
+
+    bool finish() {
+        flush_literal();
+        flush_copy();
+        drain(true);
+        return ok_;
+    }
+};
+
+// Dosyann [first_block, last_block) bloklarnn hash'lerini hesapla
+inline bool hash_blocks(const std::filesystem::path& path, std::uint64_t first_block, std::uint64_t last_block,
+    std::vector<std::uint64_t>& hashes, const std::atomic<bool>& cancel) {
+    std::FILE* file = std::fopen(path.string().c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = seek_file(file, first_block * block);
+    chunked_reader reader(file, 1 << 20);
+    for (std::uint64_t b = first_block; ok && b < last_block; ++b) {
+        const char* p = cancel.load(std::memory_order_relaxed) ? nullptr : reader.peek(block);
+        ok = p != nullptr;
+        if (ok) {
+            hashes[static_cast<std::size_t>(b)] = hash_block(p);
+            reader.consume(block);
+        }
+    }
+    std::fclose(file);
+    return ok;
+}
+
+// Yeni srmn [begin, end) araln eski srme gre ilemlere evir. Her konumda pencerenin
+// hash'i indekste aranr; blok baytlaryla dorulanan eleme ileriye doru bayt bayt uzatlr.
+// cancel kurulursa yarda brakp false dner.
+inline bool encode_range(const std::filesystem::path& old_path, std::uint64_t old_size, const block_index& index,
+    const std::filesystem::path& new_path, std::uint64_t begin, std::uint64_t end, std::FILE* out,
+    const std::atomic<bool>& cancel) {
+    std::FILE* old_file = std::fopen(old_path.string().c_str(), "rb");
+    std::FILE* new_file = std::fopen(new_path.string().c_str(), "rb");
+    bool ok = old_file != nullptr && new_file != nullptr && seek_file(new_file, begin);
+    if (ok) {
+        positioned_file old(old_file);
+        chunked_reader reader(new_file, 1 << 20);
+        op_writer writer(out);
+        std::vector<char> old_bytes(max_literal);
+        std::uint64_t const factor = leading_factor();
+        std::uint64_t pos = begin;
+        std::uint64_t hash = 0;
+        bool hashed = false;
+        while (ok && end - pos >= block) {
+            bool const more = end - pos > block;
+            const char* window = reader.peek(block + (more ? 1 : 0));
+            if (window == nullptr || cancel.load(std::memory_order_relaxed)) {
+                ok = false;
+                break;
+            }
+            if (!hashed) {
+                hash = hash_block(window);
+                hashed = true;
+            }
+            std::uint32_t const b = index.find(hash);
+            std::uint64_t old_pos = static_cast<std::uint64_t>(b) * block;
+            if (b != block_index::npos && old.read(old_pos, old_bytes.data(), block)
+                && std::memcmp(old_bytes.data(), window, block) == 0) {
+                std::uint64_t length = block;
+                reader.consume(block);
+                pos += block;
+                old_pos += block;
+                while (pos < end && old_pos < old_size) {
+                    std::size_t const n = static_cast<std::size_t>(std::min<std::uint64_t>({ max_literal, end - pos, old_size - old_pos }));
+                    const char* next = reader.peek(n);
+                    if (next == nullptr || !old.read(old_pos, old_bytes.data(), n)) {
+                        ok = false;
+                        break;
+                    }
+                    std::size_t const same = static_cast<std::size_t>(
+                        std::mismatch(next, next + n, old_bytes.data()).first - next);
+                    reader.consume(same);
+                    pos += same;
+                    old_pos += same;
+                    length += same;
+                    if (same < n) {
+                        break;
+                    }
+                }
+                writer.copy(static_cast<std::uint64_t>(b) * block, length);
+                hashed = false;
+                continue;
+            }
+            writer.literal(window, 1);
+            if (more) {
+                hash = (hash - static_cast<unsigned char>(window[0]) * factor) * prime + static_cast<unsigned char>(window[block]);
+            }
+            reader.consume(1);
+            ++pos;
+        }
+        if (ok && pos < end) {
+            const char* tail = reader.peek(static_cast<std::size_t>(end - pos));
+            ok = tail != nullptr;
+            if (ok) {
+                writer.literal(tail, static_cast<std::size_t>(end - pos));
+            }
+        }
+        ok = writer.finish() && ok;
+    }
+    if (old_file != nullptr) {
+        std::fclose(old_file);
+    }
+    if (new_file != nullptr) {
+        std::fclose(new_file);
+    }
+    return ok;
+}
+
+} // namespace delta
+
+// Oyun gncellemeleri iin yama deposu. ndirme dizinindeki versions.txt srm dosyalarn eskiden
+// yeniye sralar; arka plan ii ardk srmler arasndaki ve son srme son birka srmden dorudan
+// yamalar hesaplar. Yamalar SHA-256'laryla adlandrlr (<zet>.patch); katalog dosyas srmlerin ve
+// yamalarn zetlerini tutar, bylece yeniden balatmada sadece deien srmler yeniden zetlenir.
+class patch_store {
+public:
+    struct build {
+        std::string name;
+        std::string hash;
+        std::uint64_t size = 0;
+        std::int64_t modified = 0;
+    };
+
+    // hash bosa yama hesaplanm ama yeni srmden kk kmad iin saklanmamtr
+    struct patch {
+        std::string from;
+        std::string to;
+        std::string hash;
+        std::uint64_t size = 0;
+    };
+
+    // stemcinin srmnden son srme en az bayt indirilecek yama zinciri
+    struct plan {
+        build latest;
+        std::vector<patch> chain;
+        std::uint64_t bytes = 0;
+        bool found = false;
+    };
+
+private:
+    // Son srme dorudan yamas hesaplanan nceki srm says
+    static constexpr std::size_t direct_patches = 4;
+    // Bir i paracnn ileyecei en kk aralk
+    static constexpr std::uint64_t min_range = 16ULL << 20;
+
+    std::filesystem::path builds_dir_;
+    std::filesystem::path dir_;
+    unsigned threads_ = 1;
+
+    mutable std::shared_mutex mutex_;
+    std::vector<build> versions_;                // versions.txt srasyla
+    std::unordered_map<std::string, build> known_; // ad -> zeti bilinen srm (katalog)
+    std::vector<patch> patches_;
+
+    std::mutex refresh_mutex_;
+    std::condition_variable refresh_cv_;
+    bool stopping_ = true;
+    // Kapanta sren hesaplamay yarda keser
+    std::atomic<bool> cancel_{ false };
+    std::thread worker_;
+
+    std::filesystem::path catalog_path() const {
+        return dir_ / "catalog.txt";
+    }
+
+    // Katalog satrlar: "build <zet> <boyut> <zaman> <ad>", "patch <eski> <yeni> <zet> <boyut>"
+    // ve saklanmayan yamalar iin "nopatch <eski> <yeni>"
+    void load_catalog() {
+        std::ifstream in(catalog_path());
+        std::string kind;
+        while (in >> kind) {
+            if (kind == "build") {
+                build b;
+                in >> b.hash >> b.size >> b.modified;
+                std::getline(in >> std::ws, b.name);
+                if (in && is_sha256_hex(b.hash) && valid_download_name(b.name)) {
+                    known_[b.name] = b;
+                }
+            }
+            else if (kind == "patch") {
+                patch p;
+                in >> p.from >> p.to >> p.hash >> p.size;
+                std::error_code ec;
+                if (in && std::filesystem::exists(patch_path(p.hash), ec)) {
+                    patches_.push_back(std::move(p));
+                }
+            }
+            else if (kind == "nopatch") {
+                patch p;
+                in >> p.from >> p.to;
+                if (in) {
+                    patches_.push_back(std::move(p));
+                }
+            }
+            else {
+                std::string rest;
+                std::getline(in, rest);
+            }
+        }
+    }
+
+    bool save_catalog() const {
+        std::string text;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            for (auto const& [name, b] : known_) {
+                text += "build " + b.hash + " " + std::to_string(b.size) + " " + std::to_string(b.modified) + " " + name + "\n";
+            }
+            for (auto const& p : patches_) {
+                text += p.hash.empty() ? "nopatch " + p.from + " " + p.to + "\n"
+                    : "patch " + p.from + " " + p.to + " " + p.hash + " " + std::to_string(p.size) + "\n";
+            }
+        }
+        auto const tmp = catalog_path().string() + ".tmp";
+        std::FILE* file = std::fopen(tmp.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        ok = sync_file(file) && ok;
+        std::fclose(file);
+        std::error_code ec;
+        if (ok) {
+            std::filesystem::rename(tmp, catalog_path(), ec);
+            ok = !ec;
+        }
+        if (!ok) {
+            std::cerr << "Yama katalogu yazilamadi: " << tmp << "\n";
+            return false;
+        }
+        sync_directory(dir_);
+        return true;
+    }
+
+    // versions.txt'yi oku; boyutu veya zaman deien srmleri yeniden zetle
+    bool scan_versions(std::vector<build>& versions) {
+        std::ifstream in(builds_dir_ / "versions.txt");
+        if (!in) {
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+                line.pop_back();
+            }
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            if (!valid_download_name(line)) {
+                std::cerr << "versions.txt: gecersiz surum adi atlaniyor: " << line << "\n";
+                continue;
+            }
+            std::uint64_t size = 0;
+            std::time_t modified = 0;
+            auto body = open_file_body(builds_dir_ / line, size, modified);
+            if (!body) {
+                std::cerr << "versions.txt: " << line << " bulunamadi, atlaniyor\n";
+                continue;
+            }
+            build b;
+            {
+                std::shared_lock<std::shared_mutex> lock(mutex_);
+                auto it = known_.find(line);
+                if (it != known_.end()) {
+                    b = it->second;
+                }
+            }
+            if (b.hash.empty() || b.size != size || b.modified != static_cast<std::int64_t>(modified)) {
+                sha256 digest;
+                std::vector<char> buffer(1 << 20);
+                std::size_t n;
+                while ((n = std::fread(buffer.data(), 1, buffer.size(), body->file)) > 0) {
+                    digest.update(buffer.data(), n);
+                }
+                auto const d = digest.finish();
+                b = { line, to_hex(d.data(), d.size()), size, static_cast<std::int64_t>(modified) };
+                std::unique_lock<std::shared_mutex> lock(mutex_);
+                known_[line] = b;
+            }
+            versions.push_back(std::move(b));
+        }
+        return true;
+    }
+
+    bool has_patch(const std::string& from, const std::string& to) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return std::any_of(patches_.begin(), patches_.end(),
+            [&](const patch& p) { return p.from == from && p.to == to; });
+    }
+
+    // Eski srmn blok hash'lerini i paracklar arasnda blerek hesapla
+    bool index_build(const build& from, std::vector<std::uint64_t>& hashes) const {
+        std::uint64_t const blocks = from.size / delta::block;
+        hashes.assign(static_cast<std::size_t>(blocks), 0);
+        std::uint64_t const parts = std::max<std::uint64_t>(1, std::min<std::uint64_t>(threads_, from.size / min_range));
+        std::vector<std::thread> workers;
+        std::vector<char> ok(parts, 0);
+        for (std::uint64_t i = 0; i < parts; ++i) {
+            workers.emplace_back([&, i] {
+                ok[i] = delta::hash_blocks(builds_dir_ / from.name, blocks * i / parts, blocks * (i + 1) / parts, hashes, cancel_);
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        return std::all_of(ok.begin(), ok.end(), [](char c) { return c != 0; });
+    }
+
+    // from -> to yamasn hesapla: yeni srm aralklara blnr, her aralk ayr bir geici dosyaya
+    // akla kodlanr, sonra balkla birletirilip zetlenir. Bellekte sadece eski srmn indeksi durur.
+    bool make_patch(const build& from, const delta::block_index& index, const build& to) {
+        std::uint64_t const parts = std::max<std::uint64_t>(1, std::min<std::uint64_t>(threads_, to.size / min_range));
+        std::vector<std::filesystem::path> pieces;
+        std::vector<std::thread> workers;
+        std::vector<char> ok(parts, 0);
+        for (std::uint64_t i = 0; i < parts; ++i) {
+            pieces.push_back(dir_ / (to.hash.substr(0, 16) + "-" + std::to_string(i) + ".tmp"));
+        }
+        for (std::uint64_t i = 0; i < parts; ++i) {
+            workers.emplace_back([&, i] {
+                std::FILE* out = std::fopen(pieces[i].string().c_str(), "wb");
+                if (out != nullptr) {
+                    ok[i] = delta::encode_range(builds_dir_ / from.name, from.size, index, builds_dir_ / to.name,
+                        to.size * i / parts, to.size * (i + 1) / parts, out, cancel_);
+                    ok[i] = std::fclose(out) == 0 && ok[i];
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        std::string header(delta::magic, 4);
+        auto const append = [&header](const auto& value) {
+            header.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        auto const append_hash = [&header](const std::string& hex) {
+            for (std::size_t i = 0; i < hex.size(); i += 2) {
+                unsigned value = 0;
+                std::from_chars(hex.data() + i, hex.data() + i + 2, value, 16);
+                header.push_back(static_cast<char>(value));
+            }
+        };
+        append(delta::version);
+        append_hash(from.hash);
+        append_hash(to.hash);
+        append(from.size);
+        append(to.size);
+
+        auto const tmp = dir_ / (to.hash.substr(0, 16) + ".patch.tmp");
+        std::FILE* out = std::fopen(tmp.string().c_str(), "wb");
+        bool good = out != nullptr && std::all_of(ok.begin(), ok.end(), [](char c) { return c != 0; });
+        sha256 digest;
+        std::uint64_t size = 0;
+        auto const write = [&](const char* data, std::size_t n) {
+            digest.update(data, n);
+            size += n;
+            good = good && std::fwrite(data, 1, n, out) == n;
+        };
+        if (good) {
+            write(header.data(), header.size());
+            std::vector<char> buffer(1 << 20);
+            for (auto const& piece : pieces) {
+                std::FILE* in = std::fopen(piece.string().c_str(), "rb");
+                good = good && in != nullptr;
+                std::size_t n;
+                while (good && (n = std::fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+                    write(buffer.data(), n);
+                }
+                if (in != nullptr) {
+                    std::fclose(in);
+                }
+            }
+            write("E", 1);
+            good = sync_file(out) && good;
+        }
+        if (out != nullptr) {
+            std::fclose(out);
+        }
+        std::error_code ec;
+        for (auto const& piece : pieces) {
+            std::filesystem::remove(piece, ec);
+        }
+
+        auto const d = digest.finish();
+        patch p{ from.hash, to.hash, to_hex(d.data(), d.size()), size };
+        if (good && size >= to.size) {
+            // Srmler birbirine benzemiyor: tam srm indirmek daha ucuz
+            std::filesystem::remove(tmp, ec);
+            std::cout << "Yama atlandi: " << from.name << " -> " << to.name << " (" << size << " bayt, surum "
+                << to.size << " bayt)\n";
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            patches_.push_back({ from.hash, to.hash, {}, 0 });
+            return true;
+        }
+        if (good) {
+            std::filesystem::rename(tmp, patch_path(p.hash), ec);
+            good = !ec;
+        }
+        if (!good) {
+            if (!cancel_) {
+                std::cerr << "Yama yazilamadi: " << from.name << " -> " << to.name << "\n";
+            }
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        sync_directory(dir_);
+        std::cout << "Yama hazir: " << from.name << " -> " << to.name << " (" << p.size << " bayt, surum "
+            << to.size << " bayt)\n";
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        patches_.push_back(std::move(p));
+        return true;
+    }
+
+    // Eksik yamalar hesapla: her i iin (i-1 -> i) ve son srme son direct_patches srmden.
+    // Ayn eski srmden kan yamalar tek indeksi paylar.
+    void refresh() {
+        std::vector<build> versions;
+        if (!scan_versions(versions)) {
+            return;
+        }
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            versions_ = versions;
+        }
+        save_catalog();
+
+        std::vector<std::vector<std::size_t>> targets(versions.size());
+        for (std::size_t i = 1; i < versions.size(); ++i) {
+            targets[i - 1].push_back(i);
+        }
+        std::size_t const last = versions.empty() ? 0 : versions.size() - 1;
+        for (std::size_t j = last >= direct_patches ? last - direct_patches : 0; j + 1 < last; ++j) {
+            targets[j].push_back(last);
+        }
+
+        for (std::size_t from = 0; from < versions.size(); ++from) {
+            std::vector<std::size_t> missing;
+            for (std::size_t to : targets[from]) {
+                if (versions[from].hash != versions[to].hash && !has_patch(versions[from].hash, versions[to].hash)) {
+                    missing.push_back(to);
+                }
+            }
+            if (missing.empty()) {
+                continue;
+            }
+            std::vector<std::uint64_t> hashes;
+            if (!index_build(versions[from], hashes)) {
+                if (!cancel_) {
+                    std::cerr << versions[from].name << ": indekslenemedi\n";
+                }
+                continue;
+            }
+            delta::block_index const index(hashes);
+            hashes = {};
+            for (std::size_t to : missing) {
+                if (cancel_) {
+                    return;
+                }
+                if (make_patch(versions[from], index, versions[to])) {
+                    save_catalog();
+                }
+            }
+        }
+    }
+
+    void refresh_loop(std::chrono::seconds interval) {
+        std::unique_lock<std::mutex> lock(refresh_mutex_);
+        while (!stopping_) {
+            lock.unlock();
+            refresh();
+            lock.lock();
+            refresh_cv_.wait_for(lock, interval, [this] { return stopping_; });
+        }
+    }
+
+public:
+    ~patch_store() {
+        stop();
+    }
+
+    std::filesystem::path patch_path(const std::string& hash) const {
+        return dir_ / (hash + ".patch");
+    }
+
+    bool open(const std::filesystem::path& builds_dir, const std::filesystem::path& dir, std::chrono::seconds interval, unsigned threads) {
+        builds_dir_ = builds_dir;
+        dir_ = dir;
+        threads_ = std::max(1u, threads);
+        std::error_code ec;
+        std::filesystem::create_directories(dir_, ec);
+        if (ec) {
+            std::cerr << "Yama dizini olusturulamadi: " << dir_.string() << "\n";
+            return false;
+        }
+        for (auto const& entry : std::filesystem::directory_iterator(dir_, ec)) {
+            if (entry.path().extension() == ".tmp") {
+                std::filesystem::remove(entry.path(), ec);
+            }
+        }
+        load_catalog();
+
+        stopping_ = false;
+        worker_ = std::thread([this, interval] { refresh_loop(interval); });
+        return true;
+    }
+
+    // from srmnden son srme toplam boyutu en kk yama zinciri (Dijkstra). Zincir yoksa veya
+    // son srmn kendisinden bykse found=false: istemci tam srm indirmelidir.
+    bool find_plan(const std::string& from, plan& out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (versions_.empty()) {
+            return false;
+        }
+        out.latest = versions_.back();
+        if (from == out.latest.hash) {
+            out.found = true;
+            return true;
+        }
+
+        std::unordered_map<std::string, std::pair<std::uint64_t, const patch*>> best;
+        using item = std::pair<std::uint64_t, const std::string*>;
+        std::priority_queue<item, std::vector<item>, std::greater<item>> queue;
+        best[from] = { 0, nullptr };
+        queue.push({ 0, &from });
+        while (!queue.empty()) {
+            auto const [cost, node] = queue.top();
+            queue.pop();
+            if (*node == out.latest.hash) {
+                break;
+            }
+            if (cost != best[*node].first) {
+                continue;
+            }
+            for (auto const& p : patches_) {
+                if (p.from != *node || p.hash.empty()) {
+                    continue;
+                }
+                auto it = best.find(p.to);
+                if (it == best.end() || cost + p.size < it->second.first) {
+                    best[p.to] = { cost + p.size, &p };
+                    queue.push({ cost + p.size, &p.to });
+                }
+            }
+        }
+
+        auto it = best.find(out.latest.hash);
+        if (it == best.end() || it->second.first >= out.latest.size) {
+            return true;
+        }
+        out.bytes = it->second.first;
+        for (const patch* p = it->second.second; p != nullptr; p = best[p->from].second) {
+            out.chain.push_back(*p);
+        }
+        std::reverse(out.chain.begin(), out.chain.end());
+        out.found = true;
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(refresh_mutex_);
+            if (stopping_) {
+                return;
+            }
+            stopping_ = true;
+        }
+        cancel_ = true;
+        refresh_cv_.notify_one();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+    }
+};
+
+// GET /patches?from=<sha256>: istemcinin srmnden son srme yama plan.
+// status: "current" (gncel), "patch" (chain srayla uygulanr) veya "full" (tam srm indirilmeli)
+route_ptr get_patch_plan(const patch_store& patches, const api_request& req) {
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string const from(query_param(target, "from"));
+    if (!is_sha256_hex(from)) {
+        return error_result(format, http::status::bad_request, "Gecersiz surum ozeti");
+    }
+    patch_store::plan plan;
+    if (!patches.find_plan(from, plan)) {
+        return error_result(format, http::status::not_found, "Surum yok");
+    }
+
+    body_writer writer(format);
+    writer.begin_object(7);
+    writer.key("status");
+    writer.string_value(!plan.found ? "full" : plan.chain.empty() ? "current" : "patch");
+    writer.key("latest");
+    writer.string_value(plan.latest.hash);
+    writer.key("version");
+    writer.string_value(plan.latest.name);
+    writer.key("size");
+    writer.int_value(static_cast<std::int64_t>(plan.latest.size));
+    writer.key("full");
+    writer.string_value("/download/" + plan.latest.name);
+    writer.key("bytes");
+    writer.int_value(static_cast<std::int64_t>(plan.found ? plan.bytes : plan.latest.size));
+    writer.key("chain");
+    writer.begin_array(plan.chain.size());
+    for (auto const& p : plan.chain) {
+        writer.begin_object(4);
+        writer.key("from");
+        writer.string_value(p.from);
+        writer.key("to");
+        writer.string_value(p.to);
+        writer.key("url");
+        writer.string_value("/patches/" + p.hash + ".patch");
+        writer.key("size");
+        writer.int_value(static_cast<std::int64_t>(p.size));
+        writer.end();
+    }
+    writer.end();
+    writer.end();
+    return writer.result();
+}
+
+// GET/HEAD /patches/<zet>.patch: ierik adresli olduu iin deimez; uzun sre nbellee alnabilir
+route_ptr get_patch_file(const patch_store& patches, const api_request& req) {
+    static constexpr std::string_view prefix = "/patches/";
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string_view const name = target.substr(prefix.size(), target.find('?') - prefix.size());
+    if (name.size() != 64 + 6 || name.substr(64) != ".patch" || !is_sha256_hex(name.substr(0, 64))) {
+        return error_result(format, http::status::not_found, "Yama bulunamadi");
+    }
+    std::string const hash(name.substr(0, 64));
+    std::uint64_t size = 0;
+    std::time_t modified = 0;
+    auto file = open_file_body(patches.patch_path(hash), size, modified);
+    if (!file) {
+        return error_result(format, http::status::not_found, "Yama bulunamadi");
+    }
+    auto result = file_result(req, std::move(file), size, "\"" + hash + "\"", modified);
+    result->headers.emplace_back("Cache-Control", "public, max-age=31536000, immutable");
+    return result;
+}
+
+void register_patch_routes(router& routes, patch_store& patches) {
+    routes.add("/patches", [&patches](const api_request& req) {
+        return get_patch_plan(patches, req);
+        });
+
+    routes.add_prefix("/patches/", [&patches](const api_request& req) {
+        return get_patch_file(patches, req);
+        });
+}
+
+// erik tanml paralama (normalize edilmi FastCDC). Para snr, son 64 baytn "gear" hash'inin
+// maskeyle sfr olduu yerdir; kayt dosyasna eklenen/silinen baytlar sadece komu paralar deitirir.
+// stemci ayn parametrelerle paralar (GET /saves/params).
+namespace cdc {
+
+constexpr std::size_t min_size = 2 * 1024;
+constexpr std::size_t avg_size = 8 * 1024;
+constexpr std::size_t max_size = 64 * 1024;
+// Gear tablosu bu tohumla balayan splitmix64 dizisinin ilk 256 deeridir
+constexpr std::uint64_t gear_seed = 0x4b4f524b55ULL;
+// Ortalama boyuta kadar daha zor (15 bit), sonra daha kolay (11 bit) kesilir; para boylar ortalamada toplanr
+constexpr std::uint64_t mask_small = 0x7fffULL << 48;
+constexpr std::uint64_t mask_large = 0x7ffULL << 52;
+
+inline const std::array<std::uint64_t, 256>& gear() {
+    static const auto table = [] {
+        std::array<std::uint64_t, 256> out{};
+        std::uint64_t x = gear_seed;
+        for (auto& g : out) {
+            x += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            g = z ^ (z >> 31);
+        }
+        return out;
+    }();
+    return table;
+}
+
+// p[0, n) bandan kesilecek parann boyutu
+inline std::size_t next_cut(const unsigned char* p, std::size_t n) {
+    if (n <= min_size) {
+        return n;
+    }
+    auto const& g = gear();
+    std::size_t const limit = std::min(n, max_size);
+    std::size_t const normal = std::min(limit, avg_size);
+    std::uint64_t h = 0;
+    std::size_t i = min_size;
+    for (; i < normal; ++i) {
+        h = (h << 1) + g[p[i]];
+        if ((h & mask_small) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < limit; ++i) {
+        h = (h << 1) + g[p[i]];
+        if ((h & mask_large) == 0) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
+
+} // namespace cdc
+
+// Bulut kaytlar: kayt dosyalar ierik tanml paralara blnr, paralar SHA-256'laryla
+// (chunks/<ilk 2>/<zet>) bir kez saklanr; bir kayt sadece para listesidir (manifests/<oyuncu>/<yuva>).
+// Yeni bir kaytta sadece deien paralar yklenir ve saklanr. Hibir kaydn gstermedii paralar
+// gc_interval'de bir, grace'ten eskiyse silinir.
+class save_store {
+public:
+    struct chunk_ref {
+        std::string hash;
+        std::uint32_t size = 0;
+    };
+
+    enum class put_result { created, exists, mismatch, failed };
+
+    // Bir kayt en fazla bu kadar para ierir (ortalama 8 KB ile ~94 MB). Listedeki her zet JSON'da
+    // ~67, MessagePack'te ~66 bayt tutar; 12000 zet ~800 KB ile 1 MB'lk istek gvdesi snrnn
+    // (Beast ayrtrcsnn varsaylan ve h2::max_request_body) payla altnda kalr
+    static constexpr std::size_t max_chunks = 12000;
+
+private:
+    static constexpr char manifest_magic[4] = { 'N', 'R', 'S', 'V' };
+    static constexpr std::uint32_t manifest_version = 1;
+    static constexpr auto gc_interval = std::chrono::hours(1);
+    static constexpr auto grace = std::chrono::hours(1);
+
+    std::filesystem::path dir_;
+    std::atomic<std::uint64_t> next_tmp_{ 0 };
+
+    std::mutex gc_mutex_;
+    std::condition_variable gc_cv_;
+    bool stopping_ = true;
+    std::thread collector_;
+
+    std::filesystem::path chunk_path(const std::string& hash) const {
+        return dir_ / "chunks" / hash.substr(0, 2) / hash;
+    }
+
+    std::filesystem::path manifest_path(const std::string& user, const std::string& slot) const {
+        return dir_ / "manifests" / to_hex(reinterpret_cast<const unsigned char*>(user.data()), user.size()) / slot;
+    }
+
+    // Veriyi geici dosyaya yaz, fsync et ve yerine ta
+    bool write_atomically(const std::filesystem::path& path, const char* data, std::size_t n) {
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        auto const tmp = path.string() + "." + std::to_string(next_tmp_++) + ".tmp";
+        std::FILE* file = std::fopen(tmp.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool ok = std::fwrite(data, 1, n, file) == n;
+        ok = sync_file(file) && ok;
+        std::fclose(file);
+        if (ok) {
+            std::filesystem::rename(tmp, path, ec);
+            ok = !ec;
+        }
+        if (!ok) {
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+        sync_directory(path.parent_path());
+        return true;
+    }
+
+    // Kaytlarn gsterdii paralar topla, gerisini (grace'ten eskiyse) sil
+    void collect_garbage() {
+        std::unordered_set<std::string> live;
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(dir_ / "manifests", ec);
+            !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            std::vector<chunk_ref> chunks;
+            if (it->is_regular_file(ec) && it->path().extension() != ".tmp" && read_manifest(it->path(), chunks)) {
+                for (auto& c : chunks) {
+                    live.insert(std::move(c.hash));
+                }
+            }
+        }
+        if (ec) {
+            return;
+        }
+
+        auto const cutoff = std::filesystem::file_time_type::clock::now() - grace;
+        std::size_t removed = 0;
+        for (auto it = std::filesystem::recursive_directory_iterator(dir_ / "chunks", ec);
+            !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            std::error_code file_ec;
+            if (!it->is_regular_file(file_ec) || live.count(it->path().filename().string()) != 0) {
+                continue;
+            }
+            auto const modified = std::filesystem::last_write_time(it->path(), file_ec);
+            if (!file_ec && modified < cutoff && std::filesystem::remove(it->path(), file_ec)) {
+                ++removed;
+            }
+        }
+        if (removed != 0) {
+            std::cout << "Kayit parcalari: " << removed << " kullanilmayan parca silindi\n";
+        }
+    }
+
+    void gc_loop() {
+        std::unique_lock<std::mutex> lock(gc_mutex_);
+        while (!gc_cv_.wait_for(lock, gc_interval, [this] { return stopping_; })) {
+            lock.unlock();
+            collect_garbage();
+            lock.lock();
+        }
+    }
+
+public:
+    ~save_store() {
+        stop();
+    }
+
+    bool open(const std::filesystem::path& dir) {
+        dir_ = dir;
+        std::error_code ec;
+        std::filesystem::create_directories(dir_ / "chunks", ec);
+        std::filesystem::create_directories(dir_ / "manifests", ec);
+        if (ec) {
+            std::cerr << "Kayit dizini olusturulamadi: " << dir_.string() << "\n";
+            return false;
+        }
+        // Yarm kalm yazmalar
+        for (auto it = std::filesystem::recursive_directory_iterator(dir_, ec);
+            !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->path().extension() == ".tmp") {
+                std::error_code remove_ec;
+                std::filesystem::remove(it->path(), remove_ec);
+            }
+        }
+
+        stopping_ = false;
+        collector_ = std::thread([this] { gc_loop(); });
+        return true;
+    }
+
+    static bool valid_slot(std::string_view slot) {
+        return !slot.empty() && slot.size() <= 32 && std::all_of(slot.begin(), slot.end(), [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
+        });
+    }
+
+    // Sunucuda olmayan paralar. Bulunanlarn zaman yenilenir; bylece istemci yklemeyi atlayp
+    // kayd onaylayana kadar p toplayc onlar silmez.
+    std::vector<std::string> missing(const std::vector<std::string>& hashes) const {
+        std::vector<std::string> out;
+        auto const now = std::filesystem::file_time_type::clock::now();
+        for (auto const& hash : hashes) {
+            std::error_code ec;
+            std::filesystem::last_write_time(chunk_path(hash), now, ec);
+            if (ec) {
+                out.push_back(hash);
+            }
+        }
+        return out;
+    }
+
+    // Paray sakla; ierik zetle elemelidir
+    put_result put_chunk(const std::string& hash, std::string_view data) {
+        sha256 digest;
+        digest.update(data.data(), data.size());
+        auto const d = digest.finish();
+        if (to_hex(d.data(), d.size()) != hash) {
+            return put_result::mismatch;
+        }
+        auto const path = chunk_path(hash);
+        std::error_code ec;
+        if (std::filesystem::exists(path, ec)) {
+            std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+            return put_result::exists;
+        }
+        return write_atomically(path, data.data(), data.size()) ? put_result::created : put_result::failed;
+    }
+
+    std::shared_ptr<file_body> open_chunk(const std::string& hash, std::uint64_t& size, std::time_t& modified) const {
+        return open_file_body(chunk_path(hash), size, modified);
+    }
+
+    // Kayd verilen para listesiyle deitir. Eksik para varsa missing doldurulur ve kayt deimez.
+    bool commit(const std::string& user, const std::string& slot, const std::vector<std::string>& hashes,
+        std::vector<std::string>& missing_out, std::uint64_t& size) {
+        std::string manifest(manifest_magic, 4);
+        auto const append = [&manifest](const auto& value) {
+            manifest.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        append(manifest_version);
+        append(static_cast<std::uint32_t>(hashes.size()));
+        size = 0;
+        for (auto const& hash : hashes) {
+            std::error_code ec;
+            auto const chunk_size = std::filesystem::file_size(chunk_path(hash), ec);
+            if (ec) {
+                missing_out.push_back(hash);
+                continue;
+            }
+            size += chunk_size;
+            for (std::size_t i = 0; i < hash.size(); i += 2) {
+                unsigned value = 0;
+                std::from_chars(hash.data() + i, hash.data() + i + 2, value, 16);
+                manifest.push_back(static_cast<char>(value));
+            }
+            append(static_cast<std::uint32_t>(chunk_size));
+        }
+        if (!missing_out.empty()) {
+            return false;
+        }
+        append(crc32(manifest.data(), manifest.size()));
+        return write_atomically(manifest_path(user, slot), manifest.data(), manifest.size());
+    }
+
+    static bool read_manifest(const std::filesystem::path& path, std::vector<chunk_ref>& out) {
+        std::ifstream in(path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (data.size() < 16 || std::memcmp(data.data(), manifest_magic, 4) != 0) {
+            return false;
+        }
+        std::uint32_t version = 0, count = 0, crc = 0;
+        std::memcpy(&version, data.data() + 4, 4);
+        std::memcpy(&count, data.data() + 8, 4);
+        std::memcpy(&crc, data.data() + data.size() - 4, 4);
+        if (version != manifest_version || data.size() != 12 + std::size_t(count) * 36 + 4
+            || crc32(data.data(), data.size() - 4) != crc) {
+            return false;
+        }
+        out.resize(count);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            const char* p = data.data() + 12 + std::size_t(i) * 36;
+            out[i].hash = to_hex(reinterpret_cast<const unsigned char*>(p), 32);
+            std::memcpy(&out[i].size, p + 32, 4);
+        }
+        return true;
+    }
+
+    bool load(const std::string& user, const std::string& slot, std::vector<chunk_ref>& out) const {
+        return read_manifest(manifest_path(user, slot), out);
+    }
+
+    // Kaydn tamam tek istekte geldiinde sunucu tarafnda parala; sadece yeni paralar yazlr
+    bool store_whole(const std::string& user, const std::string& slot, std::string_view data,
+        std::vector<std::string>& hashes, std::size_t& created, std::uint64_t& created_bytes) {
+        auto const* p = reinterpret_cast<const unsigned char*>(data.data());
+        std::size_t offset = 0;
+        while (offset < data.size()) {
+            std::size_t const n = cdc::next_cut(p + offset, data.size() - offset);
+            std::string_view const piece = data.substr(offset, n);
+            sha256 digest;
+            digest.update(piece.data(), piece.size());
+            auto const d = digest.finish();
+            hashes.push_back(to_hex(d.data(), d.size()));
+            auto const result = put_chunk(hashes.back(), piece);
+            if (result == put_result::failed) {
+                return false;
+            }
+            if (result == put_result::created) {
+                ++created;
+                created_bytes += n;
+            }
+            offset += n;
+        }
+        std::vector<std::string> missing_out;
+        std::uint64_t size = 0;
+        return hashes.size() <= max_chunks && commit(user, slot, hashes, missing_out, size);
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(gc_mutex_);
+            if (stopping_) {
+                return;
+            }
+            stopping_ = true;
+        }
+        gc_cv_.notify_one();
+        if (collector_.joinable()) {
+            collector_.join();
+        }
+    }
+};
+
+// {"chunks": ["<zet>", ...]} gvdesi
+struct chunk_list {
+    std::vector<std::string> chunks;
+
+    template <class Reader>
+    bool read(Reader& reader) {
+        std::string key;
+        bool valid = true;
+        while (reader.next_key(key)) {
+            if (key == "chunks") {
+                valid = reader.read_string_array(chunks, save_store::max_chunks) && valid;
+            }
+            else {
+                reader.skip_value();
+            }
+        }
+        return reader.ok() && valid && std::all_of(chunks.begin(), chunks.end(), [](const std::string& h) {
+            return is_sha256_hex(h);
+        });
+    }
+};
+
+inline void write_hash_array(body_writer& writer, const std::vector<std::string>& hashes) {
+    writer.begin_array(hashes.size());
+    for (auto const& hash : hashes) {
+        writer.string_value(hash);
+    }
+    writer.end();
+}
+
+// GET /saves/params: istemcinin ayn snrlar bulmas iin paralama parametreleri
+route_ptr get_save_params(const api_request& req) {
+    body_writer writer(response_format(req));
+    writer.begin_object(7);
+    writer.key("min");
+    writer.int_value(static_cast<std::int64_t>(cdc::min_size));
+    writer.key("avg");
+    writer.int_value(static_cast<std::int64_t>(cdc::avg_size));
+    writer.key("max");
+    writer.int_value(static_cast<std::int64_t>(cdc::max_size));
+    writer.key("gear_seed");
+    writer.int_value(static_cast<std::int64_t>(cdc::gear_seed));
+    writer.key("mask_small");
+    writer.int_value(static_cast<std::int64_t>(cdc::mask_small));
+    writer.key("mask_large");
+    writer.int_value(static_cast<std::int64_t>(cdc::mask_large));
+    writer.key("max_chunks");
+    writer.int_value(static_cast<std::int64_t>(save_store::max_chunks));
+    writer.end();
+    return writer.result();
+}
+
+// POST /saves/have {"chunks": [...]}: listedeki paralardan sunucuda olmayanlar; istemci sadece
+// bunlar ykler
+route_ptr post_saves_have(const save_store& saves, const api_request& req) {
+    auto const format = response_format(req);
+    chunk_list query;
+    if (!decode_body(req, query)) {
+        return error_result(format, http::status::bad_request, "Gecersiz parca listesi");
+    }
+    body_writer writer(format);
+    writer.begin_object(1);
+    writer.key("missing");
+    write_hash_array(writer, saves.missing(query.chunks));
+    writer.end();
+    return writer.result();
+}
+
+// PUT /saves/chunks/<zet> (gvde: parann baytlar) ve GET/HEAD /saves/chunks/<zet>
+route_ptr saves_chunk(save_store& saves, const api_request& req) {
+    static constexpr std::string_view prefix = "/saves/chunks/";
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string const hash(target.substr(prefix.size(), target.find('?') - prefix.size()));
+    if (!is_sha256_hex(hash)) {
+        return error_result(format, http::status::not_found, "Parca bulunamadi");
+    }
+
+    if (req.method() == http::verb::put) {
+        if (req.body().size() > cdc::max_size) {
+            return error_result(format, http::status::payload_too_large, "Parca cok buyuk");
+        }
+        auto const stored = [format](http::status status, std::string_view state) {
+            body_writer writer(format);
+            writer.begin_object(1);
+            writer.key("status");
+            writer.string_value(state);
+            writer.end();
+            return writer.result(status);
+        };
+        switch (saves.put_chunk(hash, req.body())) {
+        case save_store::put_result::created:
+            return stored(http::status::created, "created");
+        case save_store::put_result::exists:
+            return stored(http::status::ok, "exists");
+        case save_store::put_result::mismatch:
+            return error_result(format, http::status::bad_request, "Parca ozeti tutmuyor");
+        default:
+            return error_result(format, http::status::internal_server_error, "Parca yazilamadi");
+        }
+    }
+    if (req.method() != http::verb::get && req.method() != http::verb::head) {
+        return error_result(format, http::status::method_not_allowed, "Sadece GET, HEAD ve PUT");
+    }
+    std::uint64_t size = 0;
+    std::time_t modified = 0;
+    auto file = saves.open_chunk(hash, size, modified);
+    if (!file) {
+        return error_result(format, http::status::not_found, "Parca bulunamadi");
+    }
+    auto result = file_result(req, std::move(file), size, "\"" + hash + "\"", modified);
+    result->headers.emplace_back("Cache-Control", "public, max-age=31536000, immutable");
+    return result;
+}
+
+// /saves/<oyuncu>/<yuva>:
+//   GET  kaydn para listesi ({"size", "chunks": [{"hash", "size"}]})
+//   PUT  {"chunks": [...]} ile kayd onayla; eksik para varsa 409 ve "missing"
+//   POST gvde kaydn kendisi (application/octet-stream); sunucu paralar, tek istekle yklenir
+route_ptr saves_slot(save_store& saves, const api_request& req) {
+    static constexpr std::string_view prefix = "/saves/";
+    auto const format = response_format(req);
+    auto const target = std::string_view(req.target().data(), req.target().size());
+    std::string_view const rest = target.substr(prefix.size(), target.find('?') - prefix.size());
+    auto const slash = rest.rfind('/');
+    std::string user;
+    if (slash == std::string_view::npos || !percent_decode(rest.substr(0, slash), user)
+        || user.empty() || user.size() > score_record::max_player || !save_store::valid_slot(rest.substr(slash + 1))) {
+        return error_result(format, http::status::not_found, "Kayit bulunamadi");
+    }
+    std::string const slot(rest.substr(slash + 1));
+
+    if (req.method() == http::verb::get || req.method() == http::verb::head) {
+        std::vector<save_store::chunk_ref> chunks;
+        if (!saves.load(user, slot, chunks)) {
+            return error_result(format, http::status::not_found, "Kayit bulunamadi");
+        }
+        std::uint64_t size = 0;
+        for (auto const& c : chunks) {
+            size += c.size;
+        }
+        body_writer writer(format);
+        writer.begin_object(2);
+        writer.key("size");
+        writer.int_value(static_cast<std::int64_t>(size));
+        writer.key("chunks");
+        writer.begin_array(chunks.size());
+        for (auto const& c : chunks) {
+            writer.begin_object(2);
+            writer.key("hash");
+            writer.string_value(c.hash);
+            writer.key("size");
+            writer.int_value(c.size);
+            writer.end();
+        }
+        writer.end();
+        writer.end();
+        return writer.result();
+    }
+
+    if (req.method() == http::verb::put) {
+        chunk_list list;
+        if (!decode_body(req, list)) {
+            return error_result(format, http::status::bad_request, "Gecersiz parca listesi");
+        }
+        std::vector<std::string> missing;
+        std::uint64_t size = 0;
+        if (!saves.commit(user, slot, list.chunks, missing, size)) {
+            if (missing.empty()) {
+                return error_result(format, http::status::internal_server_error, "Kayit yazilamadi");
+            }
+            body_writer writer(format);
+            writer.begin_object(3);
+            writer.key("status");
+            writer.string_value("error");
+            writer.key("message");
+            writer.string_value("Eksik parcalar");
+            writer.key("missing");
+            write_hash_array(writer, missing);
+            writer.end();
+            return writer.result(http::status::conflict);
+        }
+        body_writer writer(format);
+        writer.begin_object(2);
+        writer.key("size");
+        writer.int_value(static_cast<std::int64_t>(size));
+        writer.key("chunks");
+        writer.int_value(static_cast<std::int64_t>(list.chunks.size()));
+        writer.end();
+        return writer.result();
+    }
+
+    if (req.method() == http::verb::post) {
+        std::vector<std::string> hashes;
+        std::size_t created = 0;
+        std::uint64_t created_bytes = 0;
+        if (!saves.store_whole(user, slot, req.body(), hashes, created, created_bytes)) {
+            return error_result(format, http::status::internal_server_error, "Kayit yazilamadi");
+        }
+        body_writer writer(format);
+        writer.begin_object(4);
+        writer.key("size");
+        writer.int_value(static_cast<std::int64_t>(req.body().size()));
+        writer.key("chunks");
+        writer.int_value(static_cast<std::int64_t>(hashes.size()));
+        writer.key("new_chunks");
+        writer.int_value(static_cast<std::int64_t>(created));
+        writer.key("new_bytes");
+        writer.int_value(static_cast<std::int64_t>(created_bytes));
+        writer.end();
+        return writer.result();
+    }
+    return error_result(format, http::status::method_not_allowed, "Sadece GET, HEAD, PUT ve POST");
+}
+
+void register_save_routes(router& routes, save_store& saves) {
+    routes.add("/saves/params", [](const api_request& req) {
+        return get_save_params(req);
+        });
+
+    routes.add("/saves/have", [&saves](const api_request& req) {
+        return post_saves_have(saves, req);
+        });
+
+    routes.add_prefix("/saves/chunks/", [&saves](const api_request& req) {
+        return saves_chunk(saves, req);
+        });
+
+    routes.add_prefix("/saves/", [&saves](const api_request& req) {
+        return saves_slot(saves, req);
+        });
+}
+
+// HTTP/2 (RFC 7540) ve HPACK (RFC 7541) sabitleri ve yardmclar
+namespace h2 {
+
+const std::string_view preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+enum frame_type : std::uint8_t {
+    frame_data = 0x0,
+    frame_headers = 0x1,
+    frame_priority = 0x2,
+    frame_rst_stream = 0x3,
+    frame_settings = 0x4,
+    frame_push_promise = 0x5,
+    frame_ping = 0x6,
+    frame_goaway = 0x7,
+    frame_window_update = 0x8,
+    frame_continuation = 0x9
+};
+
+enum frame_flag : std::uint8_t {
+    flag_end_stream = 0x1,
+    flag_ack = 0x1,
+    flag_end_headers = 0x4,
+    flag_padded = 0x8,
+    flag_priority = 0x20
+};
+
+enum setting_id : std::uint16_t {
+    settings_header_table_size = 0x1,
+    settings_enable_push = 0x2,
+    settings_max_concurrent_streams = 0x3,
+    settings_initial_window_size = 0x4,
+    settings_max_frame_size = 0x5,
+    settings_max_header_list_size = 0x6
+};
+
+enum error_code : std::uint32_t {
+    no_error = 0x0,
+    protocol_error = 0x1,
+    internal_error = 0x2,
+    flow_control_error = 0x3,
+    stream_closed = 0x5,
+    frame_size_error = 0x6,
+    refused_stream = 0x7,
+    cancel = 0x8,
+    compression_error = 0x9
+};
+
+constexpr std::uint32_t default_window = 65535;
+constexpr std::uint32_t max_window = 0x7fffffff;
+constexpr std::uint32_t default_frame_size = 16384;
+constexpr std::uint32_t max_concurrent_streams = 100;
+constexpr std::size_t max_header_block = 64 * 1024;
+constexpr std::size_t max_request_body = 1024 * 1024;
+
+inline std::uint32_t read_u32(const std::uint8_t* p) {
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | p[3];
+}
+
+inline void put_u32(std::string& out, std::uint32_t v) {
+    out.push_back(static_cast<char>(v >> 24));
+    out.push_back(static_cast<char>(v >> 16));
+    out.push_back(static_cast<char>(v >> 8));
+    out.push_back(static_cast<char>(v));
+}
+
+// 9 baytlk ereve baln yaz
+inline void put_frame_header(std::string& out, std::size_t length, std::uint8_t type, std::uint8_t flags, std::uint32_t stream_id) {
+    out.push_back(static_cast<char>(length >> 16));
+    out.push_back(static_cast<char>(length >> 8));
+    out.push_back(static_cast<char>(length));
+    out.push_back(static_cast<char>(type));
+    out.push_back(static_cast<char>(flags));
+    put_u32(out, stream_id & max_window);
+}
+
+// RFC 7541 Ek B: Huffman kodlar (256 = EOS)
+static const std::uint32_t huffman_codes[257] = {
+    0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+    0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+    0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+    0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+    0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+    0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+    0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+    0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+    0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+    0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+    0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+    0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+    0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+    0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+    0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+    0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+    0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+    0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+    0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+    0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+    0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+    0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+    0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+    0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+    0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+    0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+    0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+    0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+    0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+    0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+    0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+    0x3fffffff,
+};
+static const std::uint8_t huffman_lengths[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+
+// RFC 7541 Ek A: statik tablo (indeks 1'den balar)
+static const std::pair<const char*, const char*> static_table[61] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+};
+
+// Huffman zm iin kodlardan bir kez kurulan ikili aa
+struct huffman_tree {
+    struct node {
+        std::int16_t child[2] = { -1, -1 };
+        std::int16_t symbol = -1;
+    };
+    std::vector<node> nodes;
+
+    huffman_tree() {
+        nodes.reserve(513);
+        nodes.emplace_back();
+        for (int sym = 0; sym < 257; ++sym) {
+            std::size_t current = 0;
+            for (int bit = huffman_lengths[sym] - 1; bit >= 0; --bit) {
+                int b = (huffman_codes[sym] >> bit) & 1;
+                if (nodes[current].child[b] < 0) {
+                    nodes[current].child[b] = static_cast<std::int16_t>(nodes.size());
+                    nodes.emplace_back();
+                }
+                current = static_cast<std::size_t>(nodes[current].child[b]);
+            }
+            nodes[current].symbol = static_cast<std::int16_t>(sym);
+        }
+    }
+};
+
+inline bool huffman_decode(const std::uint8_t* p, std::size_t n, std::string& out) {
+    static const huffman_tree tree;
+    std::size_t current = 0;
+    int depth = 0;
+    bool all_ones = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (int bit = 7; bit >= 0; --bit) {
+            int b = (p[i] >> bit) & 1;
+            current = static_cast<std::size_t>(tree.nodes[current].child[b]);
+            ++depth;
+            all_ones = all_ones && b == 1;
+            int sym = tree.nodes[current].symbol;
+            if (sym >= 0) {
+                if (sym == 256) {
+                    return false;
+                }
+                out.push_back(static_cast<char>(sym));
+                current = 0;
+                depth = 0;
+                all_ones = true;
+            }
+        }
+    }
+    // Dolgu en fazla 7 bit olmal ve EOS'un n eki (hepsi 1) olmal
+    return depth < 8 && all_ones;
+}
+
+inline std::size_t huffman_length(std::string_view s) {
+    std::size_t bits = 0;
+    for (unsigned char c : s) {
+        bits += huffman_lengths[c];
+    }
+    return (bits + 7) / 8;
+}
+
+inline void huffman_encode(std::string_view s, std::string& out) {
+    std::uint64_t acc = 0;
+    int nbits = 0;
+    for (unsigned char c : s) {
+        acc = (acc << huffman_lengths[c]) | huffman_codes[c];
+        nbits += huffman_lengths[c];
+        while (nbits >= 8) {
+            nbits -= 8;
+            out.push_back(static_cast<char>(acc >> nbits));
+        }
+        acc &= (std::uint64_t(1) << nbits) - 1;
+    }
+    if (nbits > 0) {
+        out.push_back(static_cast<char>((acc << (8 - nbits)) | (0xffu >> nbits)));
+    }
+}
+
+inline bool decode_int(const std::uint8_t*& p, const std::uint8_t* end, int prefix, std::uint64_t& value) {
+    if (p == end) {
+        return false;
+    }
+    std::uint64_t const limit = (1u << prefix) - 1;
+    value = *p++ & limit;
+    if (value < limit) {
+        return true;
+    }
+    for (unsigned shift = 0; p != end && shift <= 28; shift += 7) {
+        std::uint8_t b = *p++;
+        value += std::uint64_t(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            return value <= max_window;
+        }
+    }
+    return false;
+}
+
+inline void encode_int(std::string& out, std::uint8_t first, int prefix, std::uint64_t value) {
+    std::uint64_t const limit = (1u << prefix) - 1;
+    if (value < limit) {
+        out.push_back(static_cast<char>(first | value));
+        return;
+    }
+    out.push_back(static_cast<char>(first | limit));
+    value -= limit;
+    while (value >= 128) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void encode_string(std::string& out, std::string_view s) {
+    std::size_t const huffman = huffman_length(s);
+    if (huffman < s.size()) {
+        encode_int(out, 0x80, 7, huffman);
+        huffman_encode(s, out);
+    }
+    else {
+        encode_int(out, 0x00, 7, s.size());
+        out.append(s.data(), s.size());
+    }
+}
+
+using header_list = std::vector<std::pair<std::string, std::string>>;
+
+// HPACK dinamik tablosu; en yeni giri en batadr
+class header_table {
+private:
+    std::deque<std::pair<std::string, std::string>> entries_;
+    std::size_t size_ = 0;
+    std::size_t max_size_ = 4096;
+
+    void evict() {
+        auto const& last = entries_.back();
+        size_ -= last.first.size() + last.second.size() + 32;
+        entries_.pop_back();
+    }
+
+public:
+    void add(std::string name, std::string value) {
+        std::size_t const entry = name.size() + value.size() + 32;
+        while (!entries_.empty() && size_ + entry > max_size_) {
+            evict();
+        }
+        if (entry > max_size_) {
+            return;
+        }
+        size_ += entry;
+        entries_.emplace_front(std::move(name), std::move(value));
+    }
+
+    void resize(std::size_t max_size) {
+        max_size_ = max_size;
+        while (size_ > max_size_) {
+            evict();
+        }
+    }
+
+    // 1..61 statik tablo, 62 ve sonras dinamik tablo
+    bool get(std::uint64_t index, std::string& name, std::string& value) const {
+        if (index == 0) {
+            return false;
+        }
+        if (index <= 61) {
+            name = static_table[index - 1].first;
+            value = static_table[index - 1].second;
+            return true;
+        }
+        if (index - 62 >= entries_.size()) {
+            return false;
+        }
+        auto const& e = entries_[static_cast<std::size_t>(index - 62)];
+        name = e.first;
+        value = e.second;
+        return true;
+    }
+
+    // Tam eleme varsa indeksi, sadece isim eleiyorsa negatif indeksi dndrr
+    long find(std::string_view name, std::string_view value) const {
+        long name_match = 0;
+        for (std::size_t i = 0; i < 61; ++i) {
+            if (name == static_table[i].first) {
+                if (value == static_table[i].second) {
+                    return static_cast<long>(i + 1);
+                }
+                if (name_match == 0) {
+                    name_match = -static_cast<long>(i + 1);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            if (name == entries_[i].first) {
+                if (value == entries_[i].second) {
+                    return static_cast<long>(i + 62);
+                }
+                if (name_match == 0) {
+                    name_match = -static_cast<long>(i + 62);
+                }
+            }
+        }
+        return name_match;
+    }
+};
+
+class hpack_decoder {
+private:
+    header_table table_;
+    std::size_t settings_limit_ = 4096;
+
+    bool read_string(const std::uint8_t*& p, const std::uint8_t* end, std::string& out) {
+        if (p == end) {
+            return false;
+        }
+        bool const huffman = (*p & 0x80) != 0;
+        std::uint64_t length = 0;
+        if (!decode_int(p, end, 7, length) || length > std::uint64_t(end - p)) {
+            return false;
+        }
+        out.clear();
+        if (huffman) {
+            if (!huffman_decode(p, static_cast<std::size_t>(length), out)) {
+                return false;
+            }
+        }
+        else {
+            out.assign(reinterpret_cast<const char*>(p), static_cast<std::size_t>(length));
+        }
+        p += length;
+        return true;
+    }
+
+public:
+    // Bir header blounu z; hata balant seviyesinde COMPRESSION_ERROR'dur
+    bool decode(const std::uint8_t* p, std::size_t n, header_list& out) {
+        const std::uint8_t* const end = p + n;
+        std::size_t list_size = 0;
+        bool first_field_seen = false;
+        while (p != end) {
+            std::uint64_t index = 0;
+            std::string name, value;
+            std::uint8_t const b = *p;
+            if (b & 0x80) {
+                // Indexed Header Field
+                if (!decode_int(p, end, 7, index) || !table_.get(index, name, value)) {
+                    return false;
+                }
+            }
+            else if ((b & 0xe0) == 0x20) {
+                // Dynamic Table Size Update: sadece blok banda
+                if (first_field_seen || !decode_int(p, end, 5, index) || index > settings_limit_) {
+                    return false;
+                }
+                table_.resize(static_cast<std::size_t>(index));
+                continue;
+            }
+            else {
+                // Literal; 01xxxxxx dinamik tabloya eklenir, 0000/0001 eklenmez
+                bool const incremental = (b & 0xc0) == 0x40;
+                if (!decode_int(p, end, incremental ? 6 : 4, index)) {
+                    return false;
+                }
+                if (index != 0) {
+                    std::string ignored;
+                    if (!table_.get(index, name, ignored)) {
+                        return false;
+                    }
+                }
+                else if (!read_string(p, end, name)) {
+                    return false;
+                }
+                if (!read_string(p, end, value)) {
+                    return false;
+                }
+                if (incremental) {
+                    table_.add(name, value);
+                }
+            }
+            first_field_seen = true;
+            list_size += name.size() + value.size() + 32;
+            if (list_size > max_header_block) {
+                return false;
+            }
+            out.emplace_back(std::move(name), std::move(value));
+        }
+        return true;
+    }
+};
+
+class hpack_encoder {
+private:
+    header_table table_;
+    std::size_t table_size_ = 4096;
+    std::size_t smallest_update_ = 4096;
+    bool update_pending_ = false;
+
+public:
+    // Kar tarafn SETTINGS_HEADER_TABLE_SIZE deeri; bir sonraki blokta boyut gncellemesi gnderilir
+    void set_max_table_size(std::size_t size) {
+        size = std::min<std::size_t>(size, 4096);
+        smallest_update_ = update_pending_ ? std::min(smallest_update_, size) : size;
+        table_size_ = size;
+        update_pending_ = true;
+    }
+
+    void begin_block(std::string& out) {
+        if (!update_pending_) {
+            return;
+        }
+        if (smallest_update_ < table_size_) {
+            encode_int(out, 0x20, 5, smallest_update_);
+        }
+        encode_int(out, 0x20, 5, table_size_);
+        table_.resize(table_size_);
+        update_pending_ = false;
+    }
+
+    // indexed=false olan alanlar (r. content-length) tabloya eklenmez
+    void encode(std::string& out, std::string_view name, std::string_view value, bool indexed = true) {
+        long const found = table_.find(name, value);
+        if (found > 0) {
+            encode_int(out, 0x80, 7, static_cast<std::uint64_t>(found));
+            return;
+        }
+        if (indexed) {
+            encode_int(out, 0x40, 6, static_cast<std::uint64_t>(-found));
+        }
+        else {
+            encode_int(out, 0x00, 4, static_cast<std::uint64_t>(-found));
+        }
+        if (found == 0) {
+            encode_string(out, name);
+        }
+        encode_string(out, value);
+        if (indexed) {
+            table_.add(std::string(name), std::string(value));
+        }
+    }
+};
+
+// HTTP2-Settings balndaki base64url (dolgusuz) deeri z
+inline bool decode_base64url(std::string_view in, std::string& out) {
+    std::uint32_t acc = 0;
+    int bits = 0;
+    for (char c : in) {
+        int v;
+        if (c >= 'A' && c <= 'Z') v = c - 'A';
+        else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') v = c - '0' + 52;
+        else if (c == '-' || c == '+') v = 62;
+        else if (c == '_' || c == '/') v = 63;
+        else if (c == '=') break;
+        else return false;
+        acc = (acc << 6) | static_cast<std::uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<char>((acc >> bits) & 0xff));
+        }
+    }
+    return true;
+}
+
+} // namespace h2
+
+// io thread'ine ait tampon havuzu. Bloklar boyut snflarna gre (4 KB - 64 KB) geri dntrlr;
+// thread core'una sabitlendikten sonra stld iin bellek o core'un NUMA dmnde kalr.
+class io_pool {
+private:
+    static constexpr std::size_t min_class = 12; // 4 KB
+    static constexpr std::size_t max_class = 16; // 64 KB
+    static constexpr std::size_t max_cached = 256;
+
+    std::vector<void*> free_[max_class - min_class + 1];
+
+    static std::size_t size_class(std::size_t n) {
+        std::size_t c = min_class;
+        while ((std::size_t(1) << c) < n) {
+            ++c;
+        }
+        return c;
+    }
+
+public:
+    ~io_pool() {
+        for (auto& list : free_) {
+            for (void* p : list) {
+                ::operator delete(p);
+            }
+        }
+    }
+
+    static io_pool& local() {
+        thread_local io_pool pool;
+        return pool;
+    }
+
+    void* allocate(std::size_t n) {
+        std::size_t const c = size_class(n);
+        if (c > max_class) {
+            return ::operator new(n);
+        }
+        auto& list = free_[c - min_class];
+        if (!list.empty()) {
+            void* p = list.back();
+            list.pop_back();
+            return p;
+        }
+        return ::operator new(std::size_t(1) << c);
+    }
+
+    void deallocate(void* p, std::size_t n) {
+        std::size_t const c = size_class(n);
+        if (c > max_class || free_[c - min_class].size() >= max_cached) {
+            ::operator delete(p);
+            return;
+        }
+        free_[c - min_class].push_back(p);
+    }
+
+    // Her snftan birka blou bu thread'de ayrp dokunarak yerel dme yerletir
+    void warm_up(std::size_t per_class = 16) {
+        for (std::size_t c = min_class; c <= max_class; ++c) {
+            while (free_[c - min_class].size() < per_class) {
+                void* p = ::operator new(std::size_t(1) << c);
+                std::memset(p, 0, std::size_t(1) << c);
+                free_[c - min_class].push_back(p);
+            }
+        }
+    }
+};
+
+// Oturum tamponlarnn io_pool'dan ayrlmasn salayan durumsuz allocator
+template <class T>
+struct io_allocator {
+    using value_type = T;
+
+    io_allocator() = default;
+    template <class U>
+    io_allocator(const io_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(io_pool::local().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        io_pool::local().deallocate(p, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const io_allocator<U>&) const noexcept { return true; }
+    template <class U>
+    bool operator!=(const io_allocator<U>&) const noexcept { return false; }
+};
+
+using io_buffer = beast::basic_flat_buffer<io_allocator<char>>;
+
+// Arenann ilk blou yetmediinde byme bloklarn io_pool'dan alan kaynak
+class io_pool_resource : public std::pmr::memory_resource {
+public:
+    static io_pool_resource* instance() {
+        static io_pool_resource resource;
+        return &resource;
+    }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t) override {
+        return io_pool::local().allocate(bytes);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t) override {
+        io_pool::local().deallocate(p, bytes);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Tek bir istein arenas: balk alanlar, gvde ve ayrtrcnn ara nesneleri ilk bloktan
+// ardk olarak ayrlr, tek tek serbest braklmaz. Cevap tamamlannca reset() hepsini birden
+// geri verir; ilk blok oturum boyunca tutulur, byme bloklar io_pool'a dner.
+class request_arena {
+private:
+    static constexpr std::size_t initial_block = 4 * 1024;
+
+    void* block_;
+    std::pmr::monotonic_buffer_resource resource_;
+
+public:
+    request_arena()
+        : block_(io_pool::local().allocate(initial_block)),
+        resource_(block_, initial_block, io_pool_resource::instance()) {
+    }
+
+    request_arena(const request_arena&) = delete;
+    request_arena& operator=(const request_arena&) = delete;
+
+    ~request_arena() {
+        resource_.release();
+        io_pool::local().deallocate(block_, initial_block);
+    }
+
+    arena_allocator allocator() {
+        return arena_allocator(&resource_);
+    }
+
+    // Arenadan ayrlm hibir nesne kalmamken arlmaldr
+    void reset() {
+        resource_.release();
+    }
+};
+
+// "Date" balnn deeri (IMF-fixdate). Her thread saniyede en fazla bir kez biimlendirir.
+inline std::string_view http_date() {
+    struct cache {
+        std::time_t second = -1;
+        char text[32] = {};
+        std::size_t length = 0;
+    };
+    thread_local cache c;
+
+    std::time_t const now = std::time(nullptr);
+    if (now != c.second) {
+        std::tm utc{};
+#if defined(_WIN32)
+        gmtime_s(&utc, &now);
+#else
+        gmtime_r(&now, &utc);
+#endif
+        c.length = std::strftime(c.text, sizeof(c.text), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+        c.second = now;
+    }
+    return { c.text, c.length };
+}
+
+// Tek bir TCP balants zerinde oklanm HTTP/2 (h2c) oturumu
+class http2_session : public std::enable_shared_from_this<http2_session> {
+private:
+    struct stream {
+        request_arena arena;
+        std::optional<api_request> request; // cevabn balklar gnderilince arenasyla birlikte braklr
+        bool end_stream_received = false;
+        bool in_ready_queue = false;
+        std::int64_t send_window = h2::default_window;
+        std::int64_t recv_window = h2::default_window;
+        std::uint32_t recv_unacked = 0;
+        std::shared_ptr<const std::string> body;
+        // Dosya gvdesi: DATA erevelerine okunarak kopyalanr. Tarayclar h2c kullanmadndan
+        // byk indirmeler HTTP/1.1 + sendfile yolundan gider; bu yol bant zamanlaycsna girmez.
+        std::shared_ptr<file_body> file;
+        std::uint64_t size = 0;
+        std::uint64_t sent = 0;
+        trace::request_trace trace;
+    };
+
+    // Kuyruktaki bir yazma: ereve bal (veya kk ereve) + paylaml gvdeden bir dilim
+    struct outgoing {
+        std::string bytes;
+        std::shared_ptr<const std::string> body;
+        std::size_t offset = 0;
+        std::size_t length = 0;
+        trace::request_trace trace; // akn son erevesinde doludur; yazlnca "write" aamas kaydedilir
+    };
+
+    static constexpr std::size_t max_queued_bytes = 256 * 1024;
+
+    tcp::socket socket_;
+    io_buffer buffer_;
+    router& routes_;
+    h2::hpack_decoder decoder_;
+    h2::hpack_encoder encoder_;
+    std::unordered_map<std::uint32_t, stream> streams_;
+    std::deque<std::uint32_t> ready_;
+    std::uint32_t last_stream_id_ = 0;
+
+    std::int64_t conn_send_window_ = h2::default_window;
+    std::int64_t conn_recv_window_ = h2::default_window;
+    std::uint32_t conn_recv_unacked_ = 0;
+    std::uint32_t peer_initial_window_ = h2::default_window;
+    std::uint32_t peer_max_frame_ = h2::default_frame_size;
+
+    // HEADERS + CONTINUATION birletirme durumu
+    std::uint32_t continuation_stream_ = 0;
+    bool continuation_end_stream_ = false;
+    std::string header_block_;
+    trace::request_trace header_trace_;
+
+    bool preface_received_ = false;
+    bool reading_ = false;
+    bool closing_ = false;
+
+    std::vector<outgoing> queue_;
+    std::vector<outgoing> in_flight_;
+    std::size_t queued_bytes_ = 0;
+    bool writing_ = false;
+
+public:
+    http2_session(tcp::socket socket, io_buffer buffer, router& routes)
+        : socket_(std::move(socket)), buffer_(std::move(buffer)), routes_(routes) {
+    }
+
+    // nceden bilinen (prior knowledge) HTTP/2: nsz zaten tamponda
+    void run() {
+        send_settings();
+        process_input();
+    }
+
+    // "Upgrade: h2c" ile gelen istek 1 numaral ak olarak cevaplanr
+    void run_upgraded(const api_request& request, std::string_view settings) {
+        outgoing switching;
+        switching.bytes = "HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n";
+        enqueue(std::move(switching));
+        send_settings();
+
+        std::string payload;
+        if (!h2::decode_base64url(settings, payload) || !apply_settings(
+            reinterpret_cast<const std::uint8_t*>(payload.data()), payload.size())) {
+            return connection_error(h2::protocol_error);
+        }
+
+        last_stream_id_ = 1;
+        stream& s = streams_[1];
+        s.send_window = peer_initial_window_;
+        // HTTP/1.1 oturumunun arenas onunla birlikte gideceinden istek akn arenasna kopyalanr
+        s.request.emplace(std::piecewise_construct, std::make_tuple(s.arena.allocator()), std::make_tuple(s.arena.allocator()));
+        *s.request = request;
+        s.end_stream_received = true;
+        s.trace.begin();
+        respond(1, s);
+        process_input();
+    }
+
+private:
+    void send_settings() {
+        std::string frame;
+        h2::put_frame_header(frame, 6, h2::frame_settings, 0, 0);
+        frame.push_back(0);
+        frame.push_back(static_cast<char>(h2::settings_max_concurrent_streams));
+        h2::put_u32(frame, h2::max_concurrent_streams);
+        enqueue_frame(std::move(frame));
+    }
+
+    void enqueue_frame(std::string frame) {
+        outgoing out;
+        out.bytes = std::move(frame);
+        enqueue(std::move(out));
+    }
+
+    void enqueue(outgoing out) {
+        queued_bytes_ += out.bytes.size() + out.length;
+        queue_.push_back(std::move(out));
+    }
+
+    void send_rst_stream(std::uint32_t id, h2::error_code code) {
+        std::string frame;
+        h2::put_frame_header(frame, 4, h2::frame_rst_stream, 0, id);
+        h2::put_u32(frame, code);
+        enqueue_frame(std::move(frame));
+    }
+
+    void send_window_update(std::uint32_t id, std::uint32_t increment) {
+        std::string frame;
+        h2::put_frame_header(frame, 4, h2::frame_window_update, 0, id);
+        h2::put_u32(frame, increment);
+        enqueue_frame(std::move(frame));
+    }
+
+    // Balant hatas: GOAWAY gnder, okumay brak, kuyruk boalnca kapat
+    void connection_error(h2::error_code code) {
+        if (closing_) {
+            return;
+        }
+        std::string frame;
+        h2::put_frame_header(frame, 8, h2::frame_goaway, 0, 0);
+        h2::put_u32(frame, last_stream_id_);
+        h2::put_u32(frame, code);
+        enqueue_frame(std::move(frame));
+        closing_ = true;
+        do_write();
+    }
+
+    void reset_stream(std::uint32_t id, h2::error_code code) {
+        streams_.erase(id);
+        send_rst_stream(id, code);
+    }
+
+    void do_read() {
+        if (reading_ || closing_) {
+            return;
+        }
+        // Kar taraf cevaplar okumuyorsa yeni istek kabul etmeyi durdur (geri basn)
+        if (queued_bytes_ >= max_queued_bytes) {
+            return;
+        }
+        reading_ = true;
+        socket_.async_read_some(buffer_.prepare(h2::default_frame_size + 9),
+            beast::bind_front_handler(&http2_session::on_read, shared_from_this()));
+    }
+
+    void on_read(beast::error_code ec, std::size_t bytes_transferred) {
+        reading_ = false;
+        if (ec) {
+            return do_close();
+        }
+        buffer_.commit(bytes_transferred);
+        process_input();
+    }
+
+    // Gelen ereveleri ile, retilen cevaplar gnder ve okumaya devam et
+    void process_input() {
+        parse_frames();
+        pump_data();
+        do_write();
+        do_read();
+    }
+
+    // Tampondaki tm tam ereveleri ile
+    void parse_frames() {
+        if (!preface_received_) {
+            if (buffer_.size() < h2::preface.size()) {
+                return;
+            }
+            std::string_view got(static_cast<const char*>(buffer_.data().data()), h2::preface.size());
+            if (got != h2::preface) {
+                return connection_error(h2::protocol_error);
+            }
+            buffer_.consume(h2::preface.size());
+            preface_received_ = true;
+        }
+
+        while (!closing_ && buffer_.size() >= 9) {
+            auto const* p = static_cast<const std::uint8_t*>(buffer_.data().data());
+            std::size_t const length = (std::size_t(p[0]) << 16) | (std::size_t(p[1]) << 8) | p[2];
+            if (length > h2::default_frame_size) {
+                return connection_error(h2::frame_size_error);
+            }
+            if (buffer_.size() < 9 + length) {
+                break;
+            }
+            handle_frame(p[3], p[4], h2::read_u32(p + 5) & h2::max_window, p + 9, length);
+            buffer_.consume(9 + length);
+        }
+    }
+
+    void handle_frame(std::uint8_t type, std::uint8_t flags, std::uint32_t id, const std::uint8_t* payload, std::size_t length) {
+        // Bir header blou bitmeden sadece ayn akn CONTINUATION' gelebilir
+        if (continuation_stream_ != 0 && (type != h2::frame_continuation || id != continuation_stream_)) {
+            return connection_error(h2::protocol_error);
+        }
+
+        switch (type) {
+        case h2::frame_data:
+            return on_data(flags, id, payload, length);
+        case h2::frame_headers:
+            return on_headers(flags, id, payload, length);
+        case h2::frame_continuation:
+            if (continuation_stream_ == 0) {
+                return connection_error(h2::protocol_error);
+            }
+            return append_header_block(id, flags, payload, length);
+        case h2::frame_priority:
+            if (id == 0 || length != 5) {
+                return connection_error(h2::protocol_error);
+            }
+            return;
+        case h2::frame_rst_stream:
+            if (id == 0 || length != 4) {
+                return connection_error(h2::protocol_error);
+            }
+            streams_.erase(id);
+            return;
+        case h2::frame_settings:
+            return on_settings(flags, id, payload, length);
+        case h2::frame_ping:
+            return on_ping(flags, id, payload, length);
+        case h2::frame_goaway:
+            // Kar taraf kapanyor; kuyruktakileri gnderip balanty kapat
+            closing_ = true;
+            return do_write();
+        case h2::frame_window_update:
+            return on_window_update(id, payload, length);
+        case h2::frame_push_promise:
+            return connection_error(h2::protocol_error);
+        default:
+            // Bilinmeyen ereve tipleri yok saylr
+            return;
+        }
+    }
+
+    void on_settings(std::uint8_t flags, std::uint32_t id, const std::uint8_t* payload, std::size_t length) {
+        if (id != 0) {
+            return connection_error(h2::protocol_error);
+        }
+        if (flags & h2::flag_ack) {
+            if (length != 0) {
+                return connection_error(h2::frame_size_error);
+            }
+            return;
+        }
+        if (length % 6 != 0) {
+            return connection_error(h2::frame_size_error);
+        }
+        if (!apply_settings(payload, length)) {
+            return;
+        }
+        std::string ack;
+        h2::put_frame_header(ack, 0, h2::frame_settings, h2::flag_ack, 0);
+        enqueue_frame(std::move(ack));
+    }
+
+    bool apply_settings(const std::uint8_t* payload, std::size_t length) {
+        for (std::size_t i = 0; i + 6 <= length; i += 6) {
+            std::uint16_t const key = static_cast<std::uint16_t>((payload[i] << 8) | payload[i + 1]);
+            std::uint32_t const value = h2::read_u32(payload + i + 2);
+            switch (key) {
+            case h2::settings_header_table_size:
+                encoder_.set_max_table_size(value);
+                break;
+            case h2::settings_enable_push:
+                if (value > 1) {
+                    connection_error(h2::protocol_error);
+                    return false;
+                }
+                break;
+            case h2::settings_initial_window_size: {
+                if (value > h2::max_window) {
+                    connection_error(h2::flow_control_error);
+                    return false;
+                }
+                // Tm ak aklarn gnderme penceresini fark kadar kaydr
+                std::int64_t const delta = std::int64_t(value) - peer_initial_window_;
+                peer_initial_window_ = value;
+                for (auto& [stream_id, s] : streams_) {
+                    s.send_window += delta;
+                    if (s.send_window > h2::max_window) {
+                        connection_error(h2::flow_control_error);
+                        return false;
+                    }
+                    mark_ready(stream_id, s);
+                }
+                break;
+            }
+            case h2::settings_max_frame_size:
+                if (value < h2::default_frame_size || value > 0xffffff) {
+                    connection_error(h2::protocol_error);
+                    return false;
+                }
+                peer_max_frame_ = value;
+                break;
+            default:
+                break;
+            }
+        }
+        return true;
+    }
+
+    void on_ping(std::uint8_t flags, std::uint32_t id, const std::uint8_t* payload, std::size_t length) {
+        if (id != 0) {
+            return connection_error(h2::protocol_error);
+        }
+        if (length != 8) {
+            return connection_error(h2::frame_size_error);
+        }
+        if (flags & h2::flag_ack) {
+            return;
+        }
+        std::string pong;
+        h2::put_frame_header(pong, 8, h2::frame_ping, h2::flag_ack, 0);
+        pong.append(reinterpret_cast<const char*>(payload), 8);
+        enqueue_frame(std::move(pong));
+    }
+
+    void on_window_update(std::uint32_t id, const std::uint8_t* payload, std::size_t length) {
+        if (length != 4) {
+            return connection_error(h2::frame_size_error);
+        }
+        std::uint32_t const increment = h2::read_u32(payload) & h2::max_window;
+        if (id == 0) {
+            if (increment == 0) {
+                return connection_error(h2::protocol_error);
+            }
+            conn_send_window_ += increment;
+            if (conn_send_window_ > h2::max_window) {
+                return connection_error(h2::flow_control_error);
+            }
+            return;
+        }
+
+        auto it = streams_.find(id);
+        if (it == streams_.end()) {
+            return;
+        }
+        if (increment == 0) {
+            return reset_stream(id, h2::protocol_error);
+        }
+        it->second.send_window += increment;
+        if (it->second.send_window > h2::max_window) {
+            return reset_stream(id, h2::flow_control_error);
+        }
+        mark_ready(id, it->second);
+    }
+
+    // Dolgu (PADDED) ve ncelik (PRIORITY) alanlarn aykla
+    static bool strip_padding(std::uint8_t flags, const std::uint8_t*& payload, std::size_t& length) {
+        if (flags & h2::flag_padded) {
+            if (length < 1 || payload[0] >= length) {
+                return false;
+            }
+            std::size_t const pad = payload[0];
+            payload += 1;
+            length -= 1 + pad;
+        }
+        return true;
+    }
+
+    void on_headers(std::uint8_t flags, std::uint32_t id, const std::uint8_t* payload, std::size_t length) {
+        if (id == 0 || (id % 2) == 0) {
+            return connection_error(h2::protocol_error);
+        }
+        if (!strip_padding(flags, payload, length)) {
+            return connection_error(h2::protocol_error);
+        }
+        if (flags & h2::flag_priority) {
+            if (length < 5) {
+                return connection_error(h2::frame_size_error);
+            }
+            payload += 5;
+            length -= 5;
+        }
+
+        bool const existing = streams_.count(id) != 0;
+        if (!existing) {
+            if (id <= last_stream_id_) {
+                return connection_error(h2::stream_closed);
+            }
+            last_stream_id_ = id;
+            header_trace_.begin();
+        }
+
+        continuation_stream_ = id;
+        continuation_end_stream_ = (flags & h2::flag_end_stream) != 0;
+        header_block_.clear();
+        append_header_block(id, flags, payload, length);
+    }
+
+    void append_header_block(std::uint32_t id, std::uint8_t flags, const std::uint8_t* payload, std::size_t length) {
+        if (header_block_.size() + length > h2::max_header_block) {
+            return connection_error(h2::protocol_error);
+        }
+        header_block_.append(reinterpret_cast<const char*>(payload), length);
+        if ((flags & h2::flag_end_headers) == 0) {
+            return;
+        }
+        continuation_stream_ = 0;
+        complete_headers(id);
+    }
+
+    void complete_headers(std::uint32_t id) {
+        h2::header_list fields;
+        std::uint64_t const parse_start = header_trace_.sampled() ? trace::now_ns() : 0;
+        // HPACK durumu balantya ait olduundan reddedilecek aklarn blou da zlmelidir
+        if (!decoder_.decode(reinterpret_cast<const std::uint8_t*>(header_block_.data()), header_block_.size(), fields)) {
+            return connection_error(h2::compression_error);
+        }
+
+        auto it = streams_.find(id);
+        if (it != streams_.end()) {
+            // Trailer alanlar: ierikleri kullanlmaz, sadece ak sonlandrr
+            if (!continuation_end_stream_ || it->second.end_stream_received) {
+                return reset_stream(id, h2::protocol_error);
+            }
+            it->second.end_stream_received = true;
+            return respond(id, it->second);
+        }
+
+        if (streams_.size() >= h2::max_concurrent_streams) {
+            return send_rst_stream(id, h2::refused_stream);
+        }
+
+        stream& s = streams_[id];
+        s.request.emplace(std::piecewise_construct, std::make_tuple(s.arena.allocator()), std::make_tuple(s.arena.allocator()));
+        api_request& request = *s.request;
+        request.version(11);
+        bool has_method = false, has_path = false;
+        for (auto& [name, value] : fields) {
+            if (name == ":method") {
+                request.method_string(value);
+                has_method = true;
+            }
+            else if (name == ":path") {
+                request.target(value);
+                has_path = true;
+            }
+            else if (name == ":authority") {
+                request.set(http::field::host, value);
+            }
+            else if (!name.empty() && name[0] != ':') {
+                request.insert(name, value);
+            }
+        }
+        if (!has_method || !has_path) {
+            streams_.erase(id);
+            return send_rst_stream(id, h2::protocol_error);
+        }
+
+        s.send_window = peer_initial_window_;
+        s.trace = header_trace_;
+        header_trace_ = {};
+        if (s.trace.sampled()) {
+            s.trace.record("parse", parse_start, trace::now_ns());
+        }
+        if (continuation_end_stream_) {
+            s.end_stream_received = true;
+            respond(id, s);
+        }
+    }
+
+    void on_data(std::uint8_t flags, std::uint32_t id, const std::uint8_t* payload, std::size_t length) {
+        if (id == 0) {
+            return connection_error(h2::protocol_error);
+        }
+        if (id > last_stream_id_) {
+            return connection_error(h2::protocol_error);
+        }
+
+        // Ak kapanm olsa bile balant penceresi dolgu dahil tketilir
+        conn_recv_window_ -= static_cast<std::int64_t>(length);
+        if (conn_recv_window_ < 0) {
+            return connection_error(h2::flow_control_error);
+        }
+        conn_recv_unacked_ += static_cast<std::uint32_t>(length);
+        if (conn_recv_unacked_ >= h2::default_window / 2) {
+            send_window_update(0, conn_recv_unacked_);
+            conn_recv_window_ += conn_recv_unacked_;
+            conn_recv_unacked_ = 0;
+        }
+
+        auto it = streams_.find(id);
+        if (it == streams_.end()) {
+            return;
+        }
+        stream& s = it->second;
+        if (s.end_stream_received) {
+            return reset_stream(id, h2::stream_closed);
+        }
+        s.recv_window -= static_cast<std::int64_t>(length);
+        if (s.recv_window < 0) {
+            return reset_stream(id, h2::flow_control_error);
+        }
+
+        std::size_t const frame_length = length;
+        if (!strip_padding(flags, payload, length)) {
+            return connection_error(h2::protocol_error);
+        }
+        if (s.request->body().size() + length > h2::max_request_body) {
+            return reset_stream(id, h2::cancel);
+        }
+        s.request->body().append(reinterpret_cast<const char*>(payload), length);
+
+        if (flags & h2::flag_end_stream) {
+            s.end_stream_received = true;
+            return respond(id, s);
+        }
+
+        s.recv_unacked += static_cast<std::uint32_t>(frame_length);
+        if (s.recv_unacked >= h2::default_window / 2) {
+            send_window_update(id, s.recv_unacked);
+            s.recv_window += s.recv_unacked;
+            s.recv_unacked = 0;
+        }
+    }
+
+    // stek tamamland: ayn route tablosundan cevab al (asenkron route'larda sonra gelir)
+    void respond(std::uint32_t id, stream& s) {
+        std::uint64_t const handler_start = s.trace.sampled() ? trace::now_ns() : 0;
+        s.trace.read_end = handler_start;
+        s.trace.record("read", s.trace.read_start, s.trace.read_end);
+
+        s.trace.write_start = handler_start;
+        route_ptr result = routes_.dispatch(*s.request, [this, id] { return make_responder(id); });
+        if (result) {
+            send_response(id, s, std::move(result));
+        }
+    }
+
+    // Asenkron cevap oturumun io thread'ine tanr; ak bu arada sfrlandysa cevap atlr
+    router::responder make_responder(std::uint32_t id) {
+        return [self = shared_from_this(), id](route_ptr result) {
+            net::post(self->socket_.get_executor(), [self, id, result = std::move(result)]() mutable {
+                auto it = self->streams_.find(id);
+                if (it == self->streams_.end() || self->closing_) {
+                    return;
+                }
+                self->send_response(id, it->second, std::move(result));
+                self->pump_data();
+                self->do_write();
+                self->do_read();
+                });
+        };
+    }
+
+    // Cevabn HEADERS erevesini kuyrua koy, gvdeyi DATA iin hazrla
+    void send_response(std::uint32_t id, stream& s, route_ptr result) {
+        if (s.trace.sampled()) {
+            std::uint64_t const handler_start = s.trace.write_start;
+            s.trace.write_start = trace::now_ns();
+            s.trace.record("handler", handler_start, s.trace.write_start);
+        }
+        std::uint64_t const body_size = result->body_size();
+        bool const has_body = s.request->method() != http::verb::head && body_size != 0;
+
+        std::string block;
+        encoder_.begin_block(block);
+        encoder_.encode(block, ":status", std::to_string(static_cast<unsigned>(result->status)));
+        encoder_.encode(block, "server", BOOST_BEAST_VERSION_STRING);
+        encoder_.encode(block, "date", http_date());
+        if (!result->content_type.empty()) {
+            encoder_.encode(block, "content-type", result->content_type);
+        }
+        encoder_.encode(block, "content-length", std::to_string(body_size), false);
+        for (auto const& [name, value] : result->headers) {
+            std::string lower(name);
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            encoder_.encode(block, lower, value, false);
+        }
+
+        // Blok ereve boyutunu aarsa CONTINUATION ile bl
+        std::size_t offset = 0;
+        bool first = true;
+        do {
+            std::size_t const n = std::min<std::size_t>(peer_max_frame_, block.size() - offset);
+            bool const last = offset + n == block.size();
+            std::uint8_t flags = last ? h2::flag_end_headers : 0;
+            if (first && !has_body) {
+                flags |= h2::flag_end_stream;
+            }
+            outgoing out;
+            h2::put_frame_header(out.bytes, n, first ? h2::frame_headers : h2::frame_continuation, flags, id);
+            out.bytes.append(block, offset, n);
+            if (last && !has_body) {
+                out.trace = s.trace;
+            }
+            enqueue(std::move(out));
+            offset += n;
+            first = false;
+        } while (offset < block.size());
+
+        if (!has_body) {
+            streams_.erase(id);
+            return;
+        }
+        s.body = result->body;
+        s.file = result->file;
+        s.size = body_size;
+        s.sent = 0;
+        s.request.reset();
+        s.arena.reset();
+        mark_ready(id, s);
+    }
+
+    void mark_ready(std::uint32_t id, stream& s) {
+        if (s.size != 0 && !s.in_ready_queue && s.send_window > 0) {
+            s.in_ready_queue = true;
+            ready_.push_back(id);
+        }
+    }
+
+    // Gnderilecek gvdeleri aklar arasnda srayla (round-robin) DATA erevelerine bl.
+    // Balant/ak penceresi kapal olan ak, WINDOW_UPDATE gelene kadar bekler.
+    void pump_data() {
+        while (!ready_.empty() && conn_send_window_ > 0 && queued_bytes_ < max_queued_bytes) {
+            std::uint32_t const id = ready_.front();
+            ready_.pop_front();
+            auto it = streams_.find(id);
+            if (it == streams_.end()) {
+                continue;
+            }
+            stream& s = it->second;
+            s.in_ready_queue = false;
+            if (s.send_window <= 0) {
+                continue;
+            }
+
+            std::uint64_t const remaining = s.size - s.sent;
+            std::size_t const n = static_cast<std::size_t>(std::min<std::int64_t>({
+                static_cast<std::int64_t>(std::min<std::uint64_t>(remaining, peer_max_frame_)),
+                conn_send_window_, s.send_window }));
+            bool const last = n == remaining;
+
+            outgoing out;
+            h2::put_frame_header(out.bytes, n, h2::frame_data, last ? h2::flag_end_stream : 0, id);
+            if (s.file) {
+                std::size_t const header_size = out.bytes.size();
+                out.bytes.resize(header_size + n);
+                if (!s.file->read(s.sent, out.bytes.data() + header_size, n)) {
+                    reset_stream(id, h2::internal_error);
+                    continue;
+                }
+            }
+            else {
+                out.body = s.body;
+                out.offset = static_cast<std::size_t>(s.sent);
+                out.length = n;
+            }
+            if (last) {
+                out.trace = s.trace;
+            }
+            enqueue(std::move(out));
+
+            s.sent += n;
+            s.send_window -= static_cast<std::int64_t>(n);
+            conn_send_window_ -= static_cast<std::int64_t>(n);
+            if (last) {
+                streams_.erase(it);
+            }
+            else {
+                mark_ready(id, s);
+            }
+        }
+    }
+
+    // Kuyruktaki tm ereveleri tek bir scatter/gather yazma ile gnder
+    void do_write() {
+        if (writing_) {
+            return;
+        }
+        if (queue_.empty()) {
+            if (closing_) {
+                do_close();
+            }
+            return;
+        }
+        writing_ = true;
+        in_flight_.swap(queue_);
+
+        std::vector<net::const_buffer> buffers;
+        buffers.reserve(in_flight_.size() * 2);
+        for (auto const& out : in_flight_) {
+            buffers.emplace_back(out.bytes.data(), out.bytes.size());
+            if (out.length != 0) {
+                buffers.emplace_back(out.body->data() + out.offset, out.length);
+            }
+        }
+        net::async_write(socket_, buffers,
+            beast::bind_front_handler(&http2_session::on_write, shared_from_this()));
+    }
+
+    void on_write(beast::error_code ec, std::size_t bytes_transferred) {
+        writing_ = false;
+        if (ec) {
+            return do_close();
+        }
+        queued_bytes_ -= bytes_transferred;
+        for (auto const& out : in_flight_) {
+            if (out.trace.sampled()) {
+                out.trace.record("write", out.trace.write_start, trace::now_ns());
+            }
+        }
+        in_flight_.clear();
+
+        pump_data();
+        do_write();
+        do_read();
+    }
+
+    // Soketi kapat
+    void do_close() {
+        beast::error_code ec;
+        socket_.shutdown(tcp::socket::shutdown_send, ec);
+    }
 };
 
 // HTTP isteini ileyen ve cevap dnen snf
 class http_session : public std::enable_shared_from_this<http_session> {
 private:
     tcp::socket socket_;
-    beast::flat_buffer buffer_;
-    http::request<http::string_body> request_;
+    io_buffer buffer_;
+    router& routes_;
+    // Oturum kabul thread'inde kurulur; arena ilk blok kendi io thread'inin havuzundan gelsin diye
+    // ilk do_read'de oluturulur
+    std::optional<request_arena> arena_;
+    std::optional<http::request_parser<arena_body, arena_allocator>> parser_;
+    std::optional<api_request> request_;
+    route_ptr response_;
+    char header_[512];
+    std::string header_overflow_;
+    std::uint64_t accepted_at_;
+    trace::request_trace trace_;
+    // Dosya gvdesinin gnderim durumu
+    std::uint64_t file_offset_ = 0;
+    std::uint64_t file_remaining_ = 0;
+    bool close_after_file_ = false;
+    std::string client_;
+#if !defined(__linux__)
+    std::vector<char> file_chunk_;
+#endif
 
 public:
     // Yaplandrc (Constructor)
-    explicit http_session(tcp::socket socket)
-        : socket_(std::move(socket)) {
+    http_session(tcp::socket socket, router& routes, std::uint64_t accepted_at = 0)
+        : socket_(std::move(socket)), routes_(routes), accepted_at_(accepted_at) {
     }
 
-    // Oturumu balat
+    // Oturumu balat: nce HTTP/2 nsz (prior knowledge) gelip gelmediine bak
     void run() {
-        http::async_read(socket_, buffer_, request_,
-            beast::bind_front_handler(&http_session::on_read, shared_from_this()));
+        net::dispatch(socket_.get_executor(),
+            beast::bind_front_handler(&http_session::start, shared_from_this()));
     }
 
-    // Gelen istee gre farkl cevaplar reten fonksiyon
-    void handle_request() {
-        // HTTP cevab iin bir ablon olutur
-        http::response<http::string_body> response{ http::status::ok, request_.version() };
-        response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-        response.keep_alive(request_.keep_alive());
+    // Balantnn kabulnden kendi io thread'inde almaya balamasna kadar geen sre
+    void start() {
+        if (accepted_at_ != 0) {
+            trace::request_trace accept;
+            accept.begin(accepted_at_);
+            accept.record("accept", accepted_at_, trace::now_ns());
+        }
+        detect_protocol();
+    }
 
-        // Gelen URL'ye (URI) gre ynlendirme yapma (routing)
-        if (request_.target() == "/login") {
-            response.set(http::field::content_type, "application/json");
-            response.body() = R"({"status": "success", "message": "Giris basarili!"})";
+    // lk baytlar HTTP/2 nszyle eleiyorsa oturumu HTTP/2'ye devret
+    void detect_protocol() {
+        std::size_t const have = std::min(buffer_.size(), h2::preface.size());
+        std::string_view got(static_cast<const char*>(buffer_.data().data()), have);
+        if (got != h2::preface.substr(0, have)) {
+            return do_read();
         }
-        else if (request_.target() == "/scores") {
-            response.set(http::field::content_type, "application/json");
-            response.body() = R"({"scores": [{"user": "Ahmet Baba", "score": 1500}, {"user": "Oyuncu2", "score": 1200}]})";
+        if (have == h2::preface.size()) {
+            return std::make_shared<http2_session>(std::move(socket_), std::move(buffer_), routes_)->run();
         }
-        else {
-            // Tanmlanmam URL iin 404 Not Found hatas
-            response.result(http::status::not_found);
-            response.set(http::field::content_type, "text/plain");
-            response.body() = "404 Sayfa Bulunamadi";
+        socket_.async_read_some(buffer_.prepare(1024),
+            beast::bind_front_handler(&http_session::on_detect, shared_from_this()));
+    }
+
+    void on_detect(beast::error_code ec, std::size_t bytes_transferred) {
+        if (ec) {
+            return do_close();
         }
+        buffer_.commit(bytes_transferred);
+        detect_protocol();
+    }
 
-        response.prepare_payload();
+    // Yeni bir istek iin ayrtrcy hazrla; tamponda kalan (pipelined) veri varsa nce onu ile
+    void do_read() {
+        // nceki istein cevab tamamland: arenadan ayrlan her ey tek seferde braklr
+        parser_.reset();
+        request_.reset();
+        if (arena_) {
+            arena_->reset();
+        }
+        else {
+            arena_.emplace();
+        }
+        parser_.emplace(std::piecewise_construct, std::make_tuple(arena_->allocator()), std::make_tuple(arena_->allocator()));
+        parser_->eager(true);
+        trace_ = {};
+        if (buffer_.size() > 0) {
+            return parse_buffered();
+        }
+        read_some();
+    }
 
-        // Asenkron yazma ilemini balat
-        http::async_write(socket_, response,
-            beast::bind_front_handler(&http_session::on_write, shared_from_this(), response.need_eof()));
+    void read_some() {
+        socket_.async_read_some(buffer_.prepare(4096),
+            beast::bind_front_handler(&http_session::on_read, shared_from_this()));
     }
 
     // Okuma ilemi tamamlandnda arlan fonksiyon
     void on_read(beast::error_code ec, std::size_t bytes_transferred) {
-        boost::ignore_unused(bytes_transferred);
-
-        if (ec == http::error::end_of_stream) {
+        if (ec == net::error::eof) {
             return do_close();
         }
 
@@ -83,25 +8276,240 @@ public:
             return;
         }
 
+        buffer_.commit(bytes_transferred);
+        parse_buffered();
+    }
+
+    // Okunan baytlar ayrtrcya ver; okuma (ilk bayttan son bayta) ve ayrtrma ayr llr
+    void parse_buffered() {
+        if (!trace_.begun) {
+            trace_.begin();
+        }
+        std::uint64_t const parse_start = trace_.sampled() ? trace::now_ns() : 0;
+        trace_.read_end = parse_start;
+
+        beast::error_code ec;
+        while (buffer_.size() > 0 && !parser_->is_done()) {
+            std::size_t const used = parser_->put(buffer_.data(), ec);
+            buffer_.consume(used);
+            if (ec == http::error::need_more) {
+                ec = {};
+                break;
+            }
+            if (ec || used == 0) {
+                break;
+            }
+        }
+        if (trace_.sampled()) {
+            trace_.record("parse", parse_start, trace::now_ns());
+        }
+
+        if (ec) {
+            return do_close();
+        }
+        if (!parser_->is_done()) {
+            return read_some();
+        }
+
+        trace_.record("read", trace_.read_start, trace_.read_end);
+        request_.emplace(parser_->release());
+
         // Gelen istei ile
         handle_request();
     }
 
+    // Gvdesiz ve HTTP2-Settings ieren "Upgrade: h2c" istei HTTP/2'ye ykseltilir
+    bool wants_h2c() const {
+        auto const upgrade = (*request_)[http::field::upgrade];
+        if (upgrade.empty() || request_->find("HTTP2-Settings") == request_->end() || !request_->body().empty()) {
+            return false;
+        }
+        return http::token_list{ upgrade }.exists("h2c");
+    }
+
+    // Gelen istee gre farkl cevaplar reten fonksiyon
+    void handle_request() {
+        if (wants_h2c()) {
+            std::string const settings((*request_)["HTTP2-Settings"]);
+            return std::make_shared<http2_session>(std::move(socket_), std::move(buffer_), routes_)
+                ->run_upgraded(*request_, settings);
+        }
+
+        trace_.write_start = trace_.sampled() ? trace::now_ns() : 0;
+        route_ptr result = routes_.dispatch(*request_, [this] { return make_responder(); });
+        if (result) {
+            send_response(std::move(result));
+        }
+        // Asenkron cevap beklenirken balantdan okunmaz; pipelined istekler tamponda bekler
+    }
+
+    router::responder make_responder() {
+        return [self = shared_from_this()](route_ptr result) {
+            net::post(self->socket_.get_executor(), [self, result = std::move(result)]() mutable {
+                self->send_response(std::move(result));
+                });
+        };
+    }
+
+    void send_response(route_ptr result) {
+        if (trace_.sampled()) {
+            std::uint64_t const handler_start = trace_.write_start;
+            trace_.write_start = trace::now_ns();
+            trace_.record("handler", handler_start, trace_.write_start);
+        }
+
+        // Cevap baln sabit bir tamponda olutur; gvde route'un (veya nbellein) paylaml
+        // tamponundan kopyalanmadan, balkla birlikte tek bir scatter/gather (writev) yazmasyla gider
+        response_ = std::move(result);
+        bool const keep_alive = request_->keep_alive();
+        std::uint64_t const body_size = response_->body_size();
+        auto const reason = http::obsolete_reason(response_->status);
+        std::string_view const date = http_date();
+        std::string extra;
+        for (auto const& [name, value] : response_->headers) {
+            extra.append(name).append(": ").append(value).append("\r\n");
+        }
+
+        char const* const connection = keep_alive
+            ? (request_->version() == 10 ? "Connection: keep-alive\r\n" : "")
+            : "Connection: close\r\n";
+        auto const format = [&](char* out, std::size_t capacity) {
+            return std::snprintf(out, capacity,
+                "HTTP/1.%u %u %.*s\r\n"
+                "Server: %s\r\n"
+                "Date: %.*s\r\n"
+                "Content-Type: %s\r\n"
+                "Content-Length: %llu\r\n"
+                "%s"
+                "%s"
+                "\r\n",
+                request_->version() == 10 ? 0u : 1u, static_cast<unsigned>(response_->status),
+                static_cast<int>(reason.size()), reason.data(),
+                BOOST_BEAST_VERSION_STRING,
+                static_cast<int>(date.size()), date.data(),
+                response_->content_type.c_str(),
+                static_cast<unsigned long long>(body_size),
+                extra.c_str(),
+                connection);
+        };
+
+        int const written = format(header_, sizeof(header_));
+        if (written < 0) {
+            return do_close();
+        }
+        net::const_buffer header(header_, static_cast<std::size_t>(written));
+        if (static_cast<std::size_t>(written) >= sizeof(header_)) {
+            // ok uzun Content-Type gibi nadir durumlar iin yedek yol
+            header_overflow_.resize(static_cast<std::size_t>(written) + 1);
+            format(header_overflow_.data(), header_overflow_.size());
+            header = net::const_buffer(header_overflow_.data(), static_cast<std::size_t>(written));
+        }
+
+        if (response_->file && body_size != 0 && request_->method() != http::verb::head) {
+            file_offset_ = response_->file->offset;
+            file_remaining_ = body_size;
+            close_after_file_ = !keep_alive;
+            return net::async_write(socket_, header,
+                beast::bind_front_handler(&http_session::on_header_written, shared_from_this()));
+        }
+
+        std::array<net::const_buffer, 2> buffers{ header, net::const_buffer{} };
+        if (body_size != 0 && request_->method() != http::verb::head) {
+            buffers[1] = net::buffer(*response_->body);
+        }
+
+        // Asenkron yazma ilemini balat
+        net::async_write(socket_, buffers,
+            beast::bind_front_handler(&http_session::on_write, shared_from_this(), !keep_alive));
+    }
+
+    void on_header_written(beast::error_code ec, std::size_t) {
+        if (ec) {
+            return;
+        }
+        beast::error_code ignored;
+        client_ = socket_.remote_endpoint(ignored).address().to_string();
+        request_file_chunk();
+    }
+
+    // Dosya gvdesi dilim dilim gider: her dilim iin bant zamanlaycsndan izin alnr ve dilim
+    // io thread'ine post edilir, bylece ayn thread'deki dier balantlar araya girebilir
+    void request_file_chunk() {
+        static constexpr std::size_t chunk = 256 * 1024;
+        if (file_remaining_ == 0) {
+            return on_write(close_after_file_, {}, 0);
+        }
+        std::size_t const want = static_cast<std::size_t>(std::min<std::uint64_t>(file_remaining_, chunk));
+        bandwidth_scheduler::instance().acquire(client_, want, [self = shared_from_this()](std::size_t granted) {
+            net::post(self->socket_.get_executor(), [self, granted] { self->send_file(granted); });
+            });
+    }
+
+    // zin verilen kadarn sendfile ile (ekirdekte, kullanc alanna kopyalamadan) gnder;
+    // soket tamponu doluysa yazlabilir olmasn bekle
+    void send_file(std::size_t allowance) {
+#if defined(__linux__)
+        beast::error_code ec;
+        socket_.native_non_blocking(true, ec);
+        while (allowance > 0) {
+            off_t offset = static_cast<off_t>(file_offset_);
+            ssize_t const n = ::sendfile(socket_.native_handle(), fileno(response_->file->file), &offset, allowance);
+            if (n > 0) {
+                file_offset_ += static_cast<std::uint64_t>(n);
+                file_remaining_ -= static_cast<std::uint64_t>(n);
+                allowance -= static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return socket_.async_wait(tcp::socket::wait_write, [self = shared_from_this(), allowance](beast::error_code ec) {
+                    if (!ec) {
+                        self->send_file(allowance);
+                    }
+                    });
+            }
+            // Balant hatas ya da dosya beklenenden ksa (gnderim srasnda krplm)
+            return do_close();
+        }
+        request_file_chunk();
+#else
+        // sendfile olmayan platformlarda dosya tampona okunup yazlr
+        file_chunk_.resize(allowance);
+        if (!response_->file->read(file_offset_ - response_->file->offset, file_chunk_.data(), allowance)) {
+            return do_close();
+        }
+        net::async_write(socket_, net::buffer(file_chunk_),
+            [self = shared_from_this()](beast::error_code ec, std::size_t n) {
+                if (ec) {
+                    return;
+                }
+                self->file_offset_ += n;
+                self->file_remaining_ -= n;
+                self->request_file_chunk();
+            });
+#endif
+    }
+
     // Yazma ilemi tamamlandnda arlan fonksiyon
-    void on_write(beast::error_code ec, std::size_t bytes_transferred, bool close) {
+    void on_write(bool close, beast::error_code ec, std::size_t bytes_transferred) {
         boost::ignore_unused(bytes_transferred);
 
         if (ec) {
             return;
         }
 
+        if (trace_.sampled()) {
+            trace_.record("write", trace_.write_start, trace::now_ns());
+        }
+        response_.reset();
+
         if (close) {
             return do_close();
         }
 
-        request_ = {};
-        http::async_read(socket_, buffer_, request_,
-            beast::bind_front_handler(&http_session::on_read, shared_from_this()));
+        do_read();
     }
 
     // Soketi kapat
@@ -111,30 +8519,459 @@ public:
     }
 };
 
+// Thread yerleim politikas: io thread'lerinin hangi core'lara sabitlenecei
+struct placement_policy {
+    enum class mode { none, compact, spread };
+
+    mode pin = mode::none;
+    std::string irq_interface; // bo deilse bu arayzn RX kuyruk IRQ'lar io thread'lerine ynlendirilir
+};
+
+struct cpu_slot {
+    int cpu;
+    int node;
+};
+
+// Srecin almasna izin verilen CPU'lar ve NUMA dmlerini bul
+std::vector<cpu_slot> discover_cpus() {
+    std::vector<cpu_slot> cpus;
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (!CPU_ISSET(cpu, &allowed)) {
+                continue;
+            }
+            int node = 0;
+            std::error_code ec;
+            std::filesystem::directory_iterator it("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec);
+            for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+                auto const name = it->path().filename().string();
+                if (name.size() > 4 && name.compare(0, 4, "node") == 0) {
+                    node = std::atoi(name.c_str() + 4);
+                    break;
+                }
+            }
+            cpus.push_back({ cpu, node });
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        unsigned const count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned cpu = 0; cpu < count; ++cpu) {
+            cpus.push_back({ static_cast<int>(cpu), 0 });
+        }
+    }
+    return cpus;
+}
+
+// Her io thread'i iin bir CPU se. compact: dmleri srayla doldurur,
+// spread: thread'leri dmler arasnda dnml datr.
+std::vector<cpu_slot> plan_placement(const placement_policy& policy, int threads) {
+    if (policy.pin == placement_policy::mode::none) {
+        return {};
+    }
+    auto cpus = discover_cpus();
+    std::stable_sort(cpus.begin(), cpus.end(),
+        [](const cpu_slot& a, const cpu_slot& b) { return a.node < b.node; });
+
+    std::vector<cpu_slot> ordered;
+    if (policy.pin == placement_policy::mode::compact) {
+        ordered = cpus;
+    }
+    else {
+        std::map<int, std::deque<cpu_slot>> by_node;
+        for (auto const& slot : cpus) {
+            by_node[slot.node].push_back(slot);
+        }
+        while (ordered.size() < cpus.size()) {
+            for (auto& [node, slots] : by_node) {
+                if (!slots.empty()) {
+                    ordered.push_back(slots.front());
+                    slots.pop_front();
+                }
+            }
+        }
+    }
+
+    std::vector<cpu_slot> plan;
+    for (int i = 0; i < threads; ++i) {
+        plan.push_back(ordered[static_cast<std::size_t>(i) % ordered.size()]);
+    }
+    return plan;
+}
+
+// aran thread'i tek bir core'a sabitle
+bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    boost::ignore_unused(cpu);
+    return false;
+#endif
+}
+
+// NIC'in RX kuyruk IRQ'larn io thread'lerinin core'larna dat (root yetkisi gerekir).
+// q. kuyruk, plan'daki (q mod thread says). core'a ynlendirilir.
+void steer_irqs(const std::string& iface, const std::vector<cpu_slot>& plan) {
+#if defined(__linux__)
+    std::ifstream interrupts("/proc/interrupts");
+    std::string line;
+    std::size_t queue = 0, steered = 0;
+    while (std::getline(interrupts, line)) {
+        if (line.find(iface) == std::string::npos) {
+            continue;
+        }
+        auto const colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string const irq = line.substr(line.find_first_not_of(' '), colon - line.find_first_not_of(' '));
+        int const cpu = plan[queue++ % plan.size()].cpu;
+        std::ofstream affinity("/proc/irq/" + irq + "/smp_affinity_list");
+        if (affinity << cpu << '\n' && affinity.flush()) {
+            ++steered;
+        }
+        else {
+            std::cerr << "IRQ " << irq << " core " << cpu << " uzerine yonlendirilemedi\n";
+        }
+    }
+    std::cout << iface << " icin " << steered << "/" << queue << " IRQ yonlendirildi.\n";
+#else
+    boost::ignore_unused(iface, plan);
+    std::cerr << "IRQ yonlendirmesi sadece Linux'ta destekleniyor\n";
+#endif
+}
+
+// Her biri tek bir thread tarafndan altrlan io_context havuzu.
+// Balant mr boyunca ayn thread'de kalr, bylece verisi o thread'in core'una ve NUMA dmne yakn olur.
+class io_context_pool {
+private:
+    using work_guard = net::executor_work_guard<net::io_context::executor_type>;
+
+    std::vector<std::unique_ptr<net::io_context>> contexts_;
+    std::vector<work_guard> work_;
+    std::atomic<std::size_t> next_{ 0 };
+
+public:
+    explicit io_context_pool(int threads) {
+        for (int i = 0; i < threads; ++i) {
+            contexts_.push_back(std::make_unique<net::io_context>(1));
+            work_.push_back(net::make_work_guard(*contexts_.back()));
+        }
+    }
+
+    void stop() {
+        work_.clear();
+        for (auto& ioc : contexts_) {
+            ioc->stop();
+        }
+    }
+
+    // Yeni balantlar io_context'ler arasnda srayla datlr
+    net::io_context& next() {
+        return *contexts_[next_++ % contexts_.size()];
+    }
+
+    net::io_context& front() {
+        return *contexts_.front();
+    }
+
+    // Her io_context iin bir thread balat; plan bo deilse thread nce core'una sabitlenir,
+    // ardndan tampon havuzunu str (first-touch ile sayfalar yerel NUMA dmnden gelir)
+    void run(const std::vector<cpu_slot>& plan) {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < contexts_.size(); ++i) {
+            threads.emplace_back([this, i, &plan] {
+                if (!plan.empty() && !pin_current_thread(plan[i].cpu)) {
+                    std::cerr << "io thread " << i << " core " << plan[i].cpu << " uzerine sabitlenemedi\n";
+                }
+                io_pool::local().warm_up();
+                contexts_[i]->run();
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+};
+
+// Gelen balantlar kabul eden ve her birini havuzdaki bir io_context'e devreden snf
+class listener : public std::enable_shared_from_this<listener> {
+private:
+    io_context_pool& pool_;
+    tcp::acceptor acceptor_;
+    router& routes_;
+
+public:
+    listener(io_context_pool& pool, tcp::endpoint endpoint, router& routes)
+        : pool_(pool), acceptor_(pool.front(), endpoint), routes_(routes) {
+    }
+
+    void run() {
+        do_accept();
+    }
+
+private:
+    void do_accept() {
+        acceptor_.async_accept(pool_.next(),
+            beast::bind_front_handler(&listener::on_accept, shared_from_this()));
+    }
+
+    void on_accept(beast::error_code ec, tcp::socket socket) {
+        if (!ec) {
+            std::uint64_t const accepted_at = trace::registry::instance().rate() != 0 ? trace::now_ns() : 0;
+            std::make_shared<http_session>(std::move(socket), routes_, accepted_at)->run();
+        }
+        do_accept();
+    }
+};
+
+// Komut satr seenekleri
+struct server_options {
+    const char* host = "0.0.0.0"; // "localhost" yerine 0.0.0.0, d balantlar iin daha iyi
+    unsigned short port = 8080;
+    int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    placement_policy policy;
+    std::filesystem::path data_dir = "data";
+    std::chrono::seconds snapshot_interval{ 300 };
+    // Telemetri tamponlarnn en ge bu aralkla segment dosyalarna yazlmas
+    std::chrono::seconds telemetry_interval{ 10 };
+    // Para modu: bu sre sadece hash'i kendisine den oyuncular tutar
+    shard_placement shard;
+    // n dm modu: skor tablosu tutulmaz, skor istekleri bu paralara (host:port) datlr
+    std::vector<tcp::endpoint> front_shards;
+    // /download/ altndan sunulan dosyalar ve dosya bana ezamanl indirme snr
+    std::filesystem::path downloads_dir = "downloads";
+    unsigned download_slots = 64;
+    // ndirme dizinindeki versions.txt'nin yeniden taranma aral ve yama hesaplayan i paracklar
+    std::chrono::seconds patch_interval{ 60 };
+    unsigned patch_threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+};
+
+// "10M", "512k" gibi bayt miktarn oku (k/m/g: 1024'n katlar)
+inline bool parse_byte_size(std::string_view text, std::uint64_t& out) {
+    auto const r = std::from_chars(text.data(), text.data() + text.size(), out);
+    if (r.ec != std::errc()) {
+        return false;
+    }
+    std::string_view const suffix(r.ptr, static_cast<std::size_t>(text.data() + text.size() - r.ptr));
+    if (suffix.empty()) {
+        return true;
+    }
+    if (suffix.size() != 1) {
+        return false;
+    }
+    switch (std::tolower(static_cast<unsigned char>(suffix[0]))) {
+    case 'g': out *= 1024;
+        [[fallthrough]];
+    case 'm': out *= 1024;
+        [[fallthrough]];
+    case 'k': out *= 1024;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// "i/N" biimindeki para tanmn oku
+inline bool parse_shard(std::string_view text, shard_placement& shard) {
+    auto const slash = text.find('/');
+    if (slash == std::string_view::npos) {
+        return false;
+    }
+    auto const index = std::from_chars(text.data(), text.data() + slash, shard.index);
+    auto const count = std::from_chars(text.data() + slash + 1, text.data() + text.size(), shard.count);
+    return index.ec == std::errc() && count.ec == std::errc() && shard.count > 0 && shard.index < shard.count;
+}
+
+// Virglle ayrlm host:port listesini oku (para sras, oyuncu hash'inin elendii sradr)
+inline bool parse_endpoints(std::string_view text, std::vector<tcp::endpoint>& out) {
+    while (!text.empty()) {
+        auto const comma = text.find(',');
+        std::string_view const item = text.substr(0, comma);
+        auto const colon = item.rfind(':');
+        unsigned short port = 0;
+        if (colon == std::string_view::npos
+            || std::from_chars(item.data() + colon + 1, item.data() + item.size(), port).ec != std::errc()) {
+            return false;
+        }
+        beast::error_code ec;
+        auto const address = net::ip::make_address(std::string(item.substr(0, colon)), ec);
+        if (ec) {
+            return false;
+        }
+        out.emplace_back(address, port);
+        text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+    }
+    return !out.empty();
+}
+
 // Ana sunucu dngsn balatan fonksiyon
-void run_server(const char* host, unsigned short port) {
-    auto const address = net::ip::make_address(host);
-    net::io_context ioc{ 1 };
-    tcp::acceptor acceptor{ ioc, {address, port} };
+void run_server(const server_options& options) {
+    auto const address = net::ip::make_address(options.host);
+    io_context_pool pool{ options.threads };
+
+    router routes;
+    std::optional<score_store> scores;
+    std::optional<telemetry_store> telemetry;
+    std::optional<shard_client> shards;
+    if (options.front_shards.empty()) {
+        scores.emplace();
+        if (!scores->open(options.data_dir, options.snapshot_interval)) {
+            return;
+        }
+        register_routes(routes, *scores, options.shard);
+        telemetry.emplace();
+        if (!telemetry->open(options.data_dir / "telemetry", options.telemetry_interval)) {
+            return;
+        }
+        register_telemetry_routes(routes, *telemetry);
+    }
+    else {
+        shards.emplace(options.front_shards);
+        register_front_routes(routes, *shards);
+    }
+    // Oturumlar indirme yuvalarn kendi mrleri boyunca tutar; ynetici onlardan sonra yok olmal
+    auto downloads = std::make_shared<download_manager>(options.downloads_dir, options.download_slots);
+    register_download_routes(routes, downloads);
+    patch_store patches;
+    if (!patches.open(options.downloads_dir, options.data_dir / "patches", options.patch_interval, options.patch_threads)) {
+        return;
+    }
+    register_patch_routes(routes, patches);
+    save_store saves;
+    if (!saves.open(options.data_dir / "saves")) {
+        return;
+    }
+    register_save_routes(routes, saves);
+
+    // Ctrl+C / SIGTERM: io thread'lerini durdur, ardndan score_store log'u boaltp snapshot alr
+    net::signal_set signals(pool.front(), SIGINT, SIGTERM);
+    signals.async_wait([&pool](beast::error_code, int) { pool.stop(); });
 
-    std::cout << "KORKUOYUNU.SITE sunucusu baslatildi, " << host << ":" << port << " adresini dinliyor.\n";
+    std::make_shared<listener>(pool, tcp::endpoint{ address, options.port }, routes)->run();
+
+    auto const plan = plan_placement(options.policy, options.threads);
+    if (!options.policy.irq_interface.empty() && !plan.empty()) {
+        steer_irqs(options.policy.irq_interface, plan);
+    }
 
-    for (;;) {
-        tcp::socket socket{ ioc };
-        acceptor.accept(socket);
+    std::cout << "KORKUOYUNU.SITE sunucusu baslatildi, " << options.host << ":" << options.port
+        << " adresini dinliyor (HTTP/1.1 + h2c, " << options.threads << " io thread";
+    if (shards) {
+        std::cout << ", " << shards->size() << " parcanin on dugumu";
+    }
+    else if (options.shard.count > 1) {
+        std::cout << ", parca " << options.shard.index << "/" << options.shard.count;
+    }
+    std::cout << ").\n";
 
-        std::thread([s = std::move(socket)]() mutable {
-            std::make_shared<http_session>(std::move(s))->run();
-            }).detach();
+    pool.run(plan);
+    bandwidth_scheduler::instance().stop();
+    patches.stop();
+    saves.stop();
+    if (shards) {
+        shards->stop();
+    }
+    if (scores) {
+        scores->stop();
+    }
+    if (telemetry) {
+        telemetry->stop();
     }
 }
 
 // Ana fonksiyon
+// Kullanm: backend [thread says] [--port=N] [--pin=none|compact|spread] [--irq=<arayz>] [--trace-rate=N]
+//                   [--data=<dizin>] [--snapshot-every=<saniye>] [--telemetry-every=<saniye>]
+//                   [--downloads=<dizin>] [--download-slots=N] [--download-rate=<bayt/s, r. 50M>]
+//                   [--patch-every=<saniye>] [--patch-threads=N]
+//                   [--shard=<i>/<N>]                   para olarak al
+//                   [--front=<host:port>,<host:port>...] paralarn n dm olarak al
 int main(int argc, char* argv[]) {
-    auto const host = "0.0.0.0"; // "localhost" yerine 0.0.0.0, d balantlar iin daha iyi
-    auto const port = 8080;
+    server_options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const arg = argv[i];
+        if (arg == "--pin=compact") {
+            options.policy.pin = placement_policy::mode::compact;
+        }
+        else if (arg == "--pin=spread") {
+            options.policy.pin = placement_policy::mode::spread;
+        }
+        else if (arg == "--pin=none") {
+            options.policy.pin = placement_policy::mode::none;
+        }
+        else if (arg.substr(0, 6) == "--irq=") {
+            options.policy.irq_interface = std::string(arg.substr(6));
+        }
+        else if (arg.substr(0, 13) == "--trace-rate=") {
+            trace::registry::instance().set_rate(static_cast<unsigned>(std::atoi(argv[i] + 13)));
+        }
+        else if (arg.substr(0, 7) == "--data=") {
+            options.data_dir = std::string(arg.substr(7));
+        }
+        else if (arg.substr(0, 17) == "--snapshot-every=") {
+            options.snapshot_interval = std::chrono::seconds(std::max(1, std::atoi(argv[i] + 17)));
+        }
+        else if (arg.substr(0, 18) == "--telemetry-every=") {
+            options.telemetry_interval = std::chrono::seconds(std::max(1, std::atoi(argv[i] + 18)));
+        }
+        else if (arg.substr(0, 12) == "--downloads=") {
+            options.downloads_dir = std::string(arg.substr(12));
+        }
+        else if (arg.substr(0, 17) == "--download-slots=") {
+            options.download_slots = static_cast<unsigned>(std::max(1, std::atoi(argv[i] + 17)));
+        }
+        else if (arg.substr(0, 16) == "--download-rate=") {
+            std::uint64_t rate = 0;
+            if (!parse_byte_size(arg.substr(16), rate)) {
+                std::cerr << "Gecersiz indirme hizi: " << arg << " (ornek: --download-rate=50M)\n";
+                return 1;
+            }
+            bandwidth_scheduler::instance().set_rate(rate);
+        }
+        else if (arg.substr(0, 14) == "--patch-every=") {
+            options.patch_interval = std::chrono::seconds(std::max(1, std::atoi(argv[i] + 14)));
+        }
+        else if (arg.substr(0, 16) == "--patch-threads=") {
+            options.patch_threads = static_cast<unsigned>(std::max(1, std::atoi(argv[i] + 16)));
+        }
+        else if (arg.substr(0, 7) == "--port=") {
+            options.port = static_cast<unsigned short>(std::atoi(argv[i] + 7));
+        }
+        else if (arg.substr(0, 8) == "--shard=") {
+            if (!parse_shard(arg.substr(8), options.shard)) {
+                std::cerr << "Gecersiz parca: " << arg << " (ornek: --shard=0/4)\n";
+                return 1;
+            }
+        }
+        else if (arg.substr(0, 8) == "--front=") {
+            if (!parse_endpoints(arg.substr(8), options.front_shards)) {
+                std::cerr << "Gecersiz parca listesi: " << arg << " (ornek: --front=127.0.0.1:8081,127.0.0.1:8082)\n";
+                return 1;
+            }
+        }
+        else {
+            options.threads = std::max(1, std::atoi(argv[i]));
+        }
+    }
 
-    run_server(host, port);
+#if !defined(_WIN32)
+    // sendfile MSG_NOSIGNAL alamaz; kapanm balantya yazmak sreci ldrmesin, EPIPE dnsn
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    run_server(options);
 
     return 0;
 }
@@ -5,130 +5,2587 @@
 // Visual Studio Code'da vcpkg ile JsonCpp kurduysanız, #include <json/json.h> genellikle yeterlidir.
 // Eğer hala hata alıyorsanız, derleyici yol ayarlarınızı kontrol edin veya duruma göre sadece <json.h> deneyin.
 #include <vector>    // vector için
-#include <algorithm> // std::transform, std::tolower için
+#include <algorithm> // std::min, std::stable_sort için
 #include <ctime>     // time, localtime, strftime için (saat bilgisini almak için)
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
 
-// Basit bir chatbot yanıt fonksiyonu
-std::string getBotResponse(const std::string& userMessage) {
-    std::string lowerCaseMessage = userMessage;
-    // Mesajı küçük harfe çevir
-    std::transform(lowerCaseMessage.begin(), lowerCaseMessage.end(), lowerCaseMessage.begin(),
-                   [](unsigned char c){ return std::tolower(c); });
-
-    // Mevcut bot yanıt mantığı
-    if (lowerCaseMessage.find("benim sana sorabileceğim tüm komutlar") != std::string::npos ||
-        lowerCaseMessage.find("tüm komutları listele") != std::string::npos ||
-        lowerCaseMessage.find("ne sorabilirim") != std::string::npos)
-    {
-        return R"(Elbette, işte sana sorabileceğim bazı komutlar:
-1. Nasılsın? / Naber?
-2. Oyun hakkında bilgi / Oyun nedir?
-3. Nasıl indirilir? / İndir
-4. Hikaye / Konu
-5. Özellikler
-6. Saat kaç? / Zaman
-7. Teşekkürler / Sağ ol
-8. Merhaba / Selam
-9. Korkunç
-10. Sistem gereksinimleri / Minimum özellikler
-11. Çıkış tarihi / Ne zaman çıkacak?
-12. Ana karakter / Kiminle oynuyoruz?
-13. Kaç sonu var? / Oyunun sonu?
-14. Zorluk seviyesi / Nasıl zor?
-15. Destek / İletişim
+// Bir niyet (intent): tetikleyici ifadelerden biri mesajda geçerse cevap verilir.
+// Birden fazla niyet eşleşirse önceliği küçük olan kazanır (eşitlikte dosyadaki sıra).
+struct Intent {
+    std::string name;
+    int priority = 0;
+    std::vector<std::string> phrases;
+    std::string reply; // "{saat}" anlık saatle değiştirilir
+    std::string more;  // "daha fazla" gibi bir devam isteğine verilecek ek cevap (boşsa yok)
+};
+
+// Tüm tetikleyici ifadeler için tek bir Aho-Corasick otomatı. Geçişler double-array düzenindedir:
+// s durumundan c koduyla t = base[s] + c durumuna gidilir, check[t] == s değilse geçiş yoktur.
+// Her düğümün base/check/fail/out alanları yan yana durur, böylece bir geçiş tek önbellek satırıdır.
+// Mesaj bir kez taranır; her durumda, o noktada biten ifadelerin en öncelikli niyeti (out) hazırdır.
+class IntentMatcher {
+public:
+    static constexpr int noMatch = INT_MAX;
+
+    explicit IntentMatcher(const std::vector<Intent>& intents) {
+        build(intents);
+    }
+
+    // Mesajda geçen en öncelikli niyetin sırası; hiçbiri yoksa noMatch
+    int match(std::string_view text) const {
+        int state = 0;
+        int best = noMatch;
+        for (unsigned char ch : text) {
+            int const c = code_[ch];
+            if (c == 0) {
+                // Hiçbir ifadede geçmeyen bayt: her eşleşme burada kopar
+                state = 0;
+                continue;
+            }
+            for (;;) {
+                int const next = nodes_[state].base + c;
+                if (nodes_[next].check == state) {
+                    state = next;
+                    break;
+                }
+                if (state == 0) {
+                    break;
+                }
+                state = nodes_[state].fail;
+            }
+            if (nodes_[state].out < best) {
+                best = nodes_[state].out;
+                if (best == 0) {
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+private:
+    struct Node {
+        int base = 0;
+        int check = -1; // -1: boş hücre
+        int fail = 0;
+        int out = noMatch;
+    };
+
+    std::array<std::uint8_t, 256> code_{}; // bayt -> alfabe kodu (0: ifadelerde yok)
+    std::vector<Node> nodes_;
+
+    // Kurulum sırasında kullanılan sıradan trie
+    struct TrieNode {
+        std::map<int, int> next;
+        int fail = 0;
+        int out = noMatch;
+        int index = 0; // double-array'deki yeri
+    };
+
+    void build(const std::vector<Intent>& intents) {
+        int alphabet = 0;
+        for (const Intent& intent : intents) {
+            for (const std::string& phrase : intent.phrases) {
+                for (unsigned char ch : phrase) {
+                    if (code_[ch] == 0) {
+                        code_[ch] = static_cast<std::uint8_t>(++alphabet);
+                    }
+                }
+            }
+        }
+
+        std::vector<TrieNode> trie(1);
+        for (std::size_t i = 0; i < intents.size(); ++i) {
+            for (const std::string& phrase : intents[i].phrases) {
+                if (phrase.empty()) {
+                    continue;
+                }
+                int node = 0;
+                for (unsigned char ch : phrase) {
+                    auto it = trie[node].next.find(code_[ch]);
+                    if (it == trie[node].next.end()) {
+                        trie.emplace_back();
+                        it = trie[node].next.emplace(code_[ch], static_cast<int>(trie.size() - 1)).first;
+                    }
+                    node = it->second;
+                }
+                trie[node].out = std::min(trie[node].out, static_cast<int>(i));
+            }
+        }
+
+        // Genişlik öncelikli sırayla hata bağlantıları; out, sonek olan ifadelerin önceliğini de kapsar
+        std::vector<int> order{ 0 };
+        for (std::size_t head = 0; head < order.size(); ++head) {
+            int const node = order[head];
+            for (auto [c, child] : trie[node].next) {
+                if (node != 0) {
+                    int f = trie[node].fail;
+                    while (f != 0 && trie[f].next.count(c) == 0) {
+                        f = trie[f].fail;
+                    }
+                    auto it = trie[f].next.find(c);
+                    trie[child].fail = it != trie[f].next.end() ? it->second : 0;
+                    trie[child].out = std::min(trie[child].out, trie[trie[child].fail].out);
+                }
+                order.push_back(child);
+            }
+        }
+
+        // Double-array yerleşimi: her düğümün çocukları boş hücrelere sığacak en küçük base aranır
+        nodes_.assign(1, Node{});
+        nodes_[0].check = -2;
+        for (int node : order) {
+            auto const& next = trie[node].next;
+            if (next.empty()) {
+                continue;
+            }
+            int base = 1;
+            for (;; ++base) {
+                bool fits = true;
+                for (auto const& entry : next) {
+                    std::size_t const slot = static_cast<std::size_t>(base + entry.first);
+                    if (slot < nodes_.size() && nodes_[slot].check != -1) {
+                        fits = false;
+                        break;
+                    }
+                }
+                if (fits) {
+                    break;
+                }
+            }
+            int const parent = trie[node].index;
+            nodes_[parent].base = base;
+            for (auto [c, child] : next) {
+                std::size_t const slot = static_cast<std::size_t>(base + c);
+                if (slot >= nodes_.size()) {
+                    nodes_.resize(slot + 1);
+                }
+                nodes_[slot].check = parent;
+                trie[child].index = static_cast<int>(slot);
+            }
+        }
+        for (int node : order) {
+            Node& n = nodes_[trie[node].index];
+            n.fail = trie[trie[node].fail].index;
+            n.out = trie[node].out;
+        }
+        // base + c her zaman dizinin içinde kalsın diye sona alfabe kadar boş hücre eklenir
+        int maxBase = 0;
+        for (const Node& n : nodes_) {
+            maxBase = std::max(maxBase, n.base);
+        }
+        nodes_.resize(std::max<std::size_t>(nodes_.size(), static_cast<std::size_t>(maxBase + alphabet + 1)));
+    }
+};
+
+// Yazım hatalı mesajlar için yaklaşık eşleştirme: tam eşleşme yoksa, mesajın herhangi bir yerinde
+// bir ifadeye k düzenlemeyle (ekleme, silme, değiştirme) ulaşılabiliyor mu diye bakılır. İfadeler
+// 64 bitlik kelimelere yan yana paketlenir ve Wu-Manber bitap ile her kelimedeki tüm ifadeler aynı
+// anda ilerletilir. İzin verilen düzenleme ifade uzunluğuna bağlıdır: 5'ten kısa ifadeler bulanık
+// aranmaz ("sa", "konu" her şeye benzer), 5 baytlık ifadelere 1, daha uzunlara 2 düzenleme tanınır.
+// Yaklaşık geçiş bir kelime sonunda bitmelidir; yoksa "kadar olacak" içindeki "ar ol" bile "sag ol"
+// sayılırdı.
+// Taramadan önce ikili (bigram) süzgeç, q-gram lemmasına göre eşleşme şansı olmayan ifadeleri
+// eler; yalnızca aday ifade içeren kelimeler taranır.
+class FuzzyMatcher {
+public:
+    static constexpr int maxEdits = 2;
+
+    explicit FuzzyMatcher(const std::vector<Intent>& intents) {
+        build(intents);
+    }
+
+    // Bu uzunluktaki bir ifadeye tanınan düzenleme sayısı
+    static int allowedEdits(std::size_t length) {
+        return length < 5 ? 0 : length == 5 ? 1 : maxEdits;
+    }
+
+    // Kelimenin devam ettiğini gösteren bayt: ASCII harf/rakam ya da çok baytlı bir UTF-8 karakterin parçası
+    static bool isWordByte(char ch) {
+        unsigned char const c = static_cast<unsigned char>(ch);
+        return c >= 0x80 || (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z');
+    }
+
+    // En az düzenlemeyle eşleşen niyetin sırası (eşitlikte öncelikli olan); hiçbiri yoksa noMatch.
+    // prefilter yalnızca ölçüm için kapatılır.
+    int match(std::string_view text, bool prefilter = true) const {
+        if (phrases_.empty() || text.size() < 2) {
+            return IntentMatcher::noMatch;
+        }
+
+        thread_local std::array<std::uint64_t, (1 << bucketBits) / 64> seen{};
+        thread_local std::vector<std::uint16_t> counts;
+        thread_local std::vector<int> words;
+        words.clear();
+        if (prefilter) {
+            // Mesajın her farklı ikilisi, onu içeren ifadelerin sayacını bir artırır
+            counts.assign(phrases_.size(), 0);
+            for (std::size_t i = 0; i + 1 < text.size(); ++i) {
+                std::uint16_t const gram = bigram(text[i], text[i + 1]);
+                std::uint64_t const bit = std::uint64_t{ 1 } << (gram & 63);
+                if ((seen[gram >> 6] & bit) != 0) {
+                    continue;
+                }
+                seen[gram >> 6] |= bit;
+                for (std::uint32_t p = bucketStart_[gram]; p < bucketStart_[gram + 1]; ++p) {
+                    ++counts[postings_[p]];
+                }
+            }
+            for (std::size_t i = 0; i + 1 < text.size(); ++i) {
+                seen[bigram(text[i], text[i + 1]) >> 6] = 0;
+            }
+            for (std::size_t i = 0; i < phrases_.size(); ++i) {
+                if (counts[i] >= phrases_[i].threshold && (words.empty() || words.back() != phrases_[i].word)) {
+                    words.push_back(phrases_[i].word);
+                }
+            }
+        }
+        else {
+            for (int w = 0; w < wordCount_; ++w) {
+                words.push_back(w);
+            }
+        }
+
+        int bestEdits = maxEdits + 1;
+        int best = IntentMatcher::noMatch;
+        for (int w : words) {
+            std::uint64_t const start = starts_[w];
+            std::uint64_t row[maxEdits + 1];
+            // j düzenlemeyle ifadenin ilk j baytı metin başlamadan silinmiş sayılabilir
+            for (int j = 0; j <= maxEdits; ++j) {
+                row[j] = 0;
+                for (int p = 0; p < j; ++p) {
+                    row[j] |= start << p;
+                }
+            }
+            for (std::size_t t = 0; t < text.size(); ++t) {
+                unsigned char const ch = static_cast<unsigned char>(text[t]);
+                std::uint64_t const mask = masks_[ch * static_cast<std::size_t>(wordCount_) + w];
+                // Başlangıç bitleri her adımda yeniden eklenir; bir ifadenin son bitinden kayan bit
+                // sonraki ifadenin zaten dolu olan ilk bitine düştüğü için ifadeler birbirini bozmaz.
+                std::uint64_t previous = row[0];
+                row[0] = ((row[0] << 1) | start) & mask;
+                for (int j = 1; j <= maxEdits; ++j) {
+                    std::uint64_t const old = row[j];
+                    row[j] = (((old << 1) | start) & mask) // eşleşme
+                        | previous                         // metinde fazladan bayt
+                        | (previous << 1) | start          // değiştirme
+                        | (row[j - 1] << 1);               // ifadeden bayt eksik
+                    previous = old;
+                }
+                if (t + 1 < text.size() && isWordByte(text[t + 1])) {
+                    continue;
+                }
+                for (int j = 1; j <= std::min(bestEdits, maxEdits); ++j) {
+                    std::uint64_t hits = row[j] & ends_[j * static_cast<std::size_t>(wordCount_) + w];
+                    if (hits == 0) {
+                        continue;
+                    }
+                    while (hits != 0) {
+                        int const bit = lowestBit(hits);
+                        hits &= hits - 1;
+                        int const intent = phrases_[bitPhrase_[static_cast<std::size_t>(w) * 64 + bit]].intent;
+                        if (j < bestEdits || intent < best) {
+                            bestEdits = j;
+                            best = intent;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+        return best;
+    }
+
+private:
+    struct Phrase {
+        int intent;
+        int word;      // paketlendiği 64 bitlik kelime
+        int threshold; // süzgeçten geçmek için mesajla paylaşılması gereken en az farklı ikili
+    };
+
+    int wordCount_ = 0;
+    std::vector<Phrase> phrases_;
+    std::vector<std::uint64_t> masks_;  // [bayt * wordCount_ + kelime]: baytın geçtiği ifade konumları
+    std::vector<std::uint64_t> starts_; // her ifadenin ilk biti
+    std::vector<std::uint64_t> ends_;   // [j * wordCount_ + kelime]: j düzenlemeye izin veren ifadelerin son biti
+    std::vector<int> bitPhrase_;        // [kelime * 64 + bit] -> ifadenin son bitiyse ifade, değilse -1
+    std::vector<std::uint32_t> bucketStart_; // ikili kovası -> postings_ içindeki aralık
+    std::vector<std::uint32_t> postings_;    // o ikiliyi içeren ifadeler
+
+    static constexpr int bucketBits = 12;
+
+    // İkililer 4096 kovaya düşürülür; çakışma yalnızca süzgeci gevşetir, sonucu değiştirmez
+    static std::uint16_t bigram(char a, char b) {
+        return static_cast<std::uint16_t>(((static_cast<unsigned char>(a) & 63) << 6) | (static_cast<unsigned char>(b) & 63));
+    }
+
+    static int lowestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(value);
+#else
+        int bit = 0;
+        while ((value & 1) == 0) {
+            value >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    void build(const std::vector<Intent>& intents) {
+        // İfadeler kelime sınırını aşmayacak şekilde sırayla yerleştirilir; 64 bayttan uzun ifadeler
+        // bir kelimeye sığmadığından yalnızca tam eşleşmeyle bulunur.
+        struct Placed {
+            const std::string* text;
+            int edits;
+            int word;
+            int offset;
+        };
+        std::vector<Placed> placed;
+        int used = 64;
+        for (std::size_t i = 0; i < intents.size(); ++i) {
+            for (const std::string& phrase : intents[i].phrases) {
+                int const edits = allowedEdits(phrase.size());
+                if (edits == 0 || phrase.size() > 64) {
+                    continue;
+                }
+                if (used + static_cast<int>(phrase.size()) > 64) {
+                    ++wordCount_;
+                    used = 0;
+                }
+                placed.push_back({ &phrase, edits, wordCount_ - 1, used });
+                used += static_cast<int>(phrase.size());
+
+                // q-gram lemması (q = 2): m baytlık ifadenin k düzenlemeli bir geçişi, ifadenin en az
+                // m - 1 - 2k ikili konumunu korur. Tekrarlanan ikililer farklı sayımda bir kez görüneceğinden
+                // eşik tekrar sayısı kadar düşürülür.
+                std::vector<std::uint16_t> grams;
+                for (std::size_t p = 0; p + 1 < phrase.size(); ++p) {
+                    grams.push_back(bigram(phrase[p], phrase[p + 1]));
+                }
+                std::sort(grams.begin(), grams.end());
+                std::size_t const positions = grams.size();
+                grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+                int const threshold = static_cast<int>(phrase.size()) - 1 - 2 * edits
+                    - static_cast<int>(positions - grams.size());
+                phrases_.push_back({ static_cast<int>(i), wordCount_ - 1, std::max(threshold, 0) });
+            }
+        }
+
+        masks_.assign(256 * static_cast<std::size_t>(wordCount_), 0);
+        starts_.assign(wordCount_, 0);
+        ends_.assign((maxEdits + 1) * static_cast<std::size_t>(wordCount_), 0);
+        bitPhrase_.assign(64 * static_cast<std::size_t>(wordCount_), -1);
+        std::vector<std::vector<std::uint32_t>> buckets(std::size_t{ 1 } << bucketBits);
+        for (std::size_t i = 0; i < placed.size(); ++i) {
+            const std::string& phrase = *placed[i].text;
+            int const w = placed[i].word;
+            int const offset = placed[i].offset;
+            for (std::size_t p = 0; p < phrase.size(); ++p) {
+                masks_[static_cast<unsigned char>(phrase[p]) * static_cast<std::size_t>(wordCount_) + w] |=
+                    std::uint64_t{ 1 } << (offset + p);
+            }
+            int const last = offset + static_cast<int>(phrase.size()) - 1;
+            starts_[w] |= std::uint64_t{ 1 } << offset;
+            for (int j = 1; j <= placed[i].edits; ++j) {
+                ends_[j * static_cast<std::size_t>(wordCount_) + w] |= std::uint64_t{ 1 } << last;
+            }
+            bitPhrase_[static_cast<std::size_t>(w) * 64 + last] = static_cast<int>(i);
+            for (std::size_t p = 0; p + 1 < phrase.size(); ++p) {
+                auto& bucket = buckets[bigram(phrase[p], phrase[p + 1])];
+                if (bucket.empty() || bucket.back() != i) {
+                    bucket.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+        }
+        bucketStart_.assign(buckets.size() + 1, 0);
+        for (std::size_t b = 0; b < buckets.size(); ++b) {
+            bucketStart_[b + 1] = bucketStart_[b] + static_cast<std::uint32_t>(buckets[b].size());
+            postings_.insert(postings_.end(), buckets[b].begin(), buckets[b].end());
+        }
+    }
+};
+
+// UTF-8 metni Türkçe kurallarıyla küçük harfe çevirir (İ→i, I→ı); fold açıksa aksanları da atar
+// (ş→s, ç→c, ı→i ve ayrışık yazılmış birleşik işaretler). ASCII bloklar SSE2 ile 16 bayt birden,
+// U+00C0..U+017F aralığı tabloyla işlenir; diğer baytlar olduğu gibi kopyalanır.
+class TextNormalizer {
+public:
+    static const TextNormalizer& instance() {
+        static const TextNormalizer normalizer;
+        return normalizer;
+    }
+
+    // Sonuç out'a yazılır; aynı tampon tekrar kullanılırsa mesaj başına bellek ayrılmaz
+    void normalize(std::string_view text, bool fold, std::string& out) const {
+        // En kötü durumda her 'I' iki bayta ('ı') çıkar
+        if (out.size() < text.size() * 2) {
+            out.resize(text.size() * 2);
+        }
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(text.data());
+        std::size_t const n = text.size();
+        char* o = &out[0];
+        std::size_t i = 0;
+        while (i < n) {
+#if defined(__SSE2__) || defined(_M_X64)
+            if (i + 16 <= n) {
+                __m128i const v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                bool const ascii = _mm_movemask_epi8(v) == 0;
+                bool const dotless = !fold && _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('I'))) != 0;
+                if (ascii && !dotless) {
+                    __m128i const upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+                                                        _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20))));
+                    i += 16;
+                    o += 16;
+                    continue;
+                }
+            }
+            // Blok ASCII değilse en az 16 bayt tek tek işlenir, sonra hızlı yola tekrar bakılır
+            std::size_t const end = std::min(n, i + 16);
+#else
+            std::size_t const end = n;
+#endif
+            while (i < end) {
+                unsigned char const c = in[i];
+                if (c < 0x80) {
+                    if (c == 'I' && !fold) {
+                        // Ayrışık yazılmış "İ" (I + U+0307) noktalı i'dir
+                        if (i + 2 < n && in[i + 1] == 0xCC && in[i + 2] == 0x87) {
+                            *o++ = 'i';
+                            i += 3;
+                            continue;
+                        }
+                        *o++ = '\xC4';
+                        *o++ = '\xB1';
+                    }
+                    else {
+                        *o++ = static_cast<char>(c >= 'A' && c <= 'Z' ? c | 0x20 : c);
+                    }
+                    ++i;
+                    continue;
+                }
+                if (i + 1 < n && (in[i + 1] & 0xC0) == 0x80) {
+                    unsigned const cp = (static_cast<unsigned>(c & 0x1F) << 6) | (in[i + 1] & 0x3F);
+                    if (c >= 0xC3 && c <= 0xC5) {
+                        const Mapping& m = (fold ? folded_ : lower_)[cp - tableStart];
+                        *o++ = m.bytes[0];
+                        if (m.length == 2) {
+                            *o++ = m.bytes[1];
+                        }
+                        i += 2;
+                        continue;
+                    }
+                    if (fold && cp >= 0x300 && cp <= 0x36F) {
+                        // Birleşik aksan işareti (ör. s + U+0327): katlamada atılır
+                        i += 2;
+                        continue;
+                    }
+                }
+                *o++ = static_cast<char>(c);
+                ++i;
+            }
+        }
+        out.resize(static_cast<std::size_t>(o - out.data()));
+    }
+
+private:
+    struct Mapping {
+        char bytes[2];
+        std::uint8_t length;
+    };
+
+    static constexpr unsigned tableStart = 0xC0;
+    static constexpr unsigned tableEnd = 0x180;
+
+    Mapping lower_[tableEnd - tableStart];
+    Mapping folded_[tableEnd - tableStart];
+
+    TextNormalizer() {
+        // Aksansız temel harfler; '.' olanlar yalnızca küçük harfe çevrilir (æ, ß, ĳ, œ ...)
+        static const char base[] =
+            "aaaaaa.ceeeeiiii" "dnooooo.ouuuuy.." "aaaaaa.ceeeeiiii" "dnooooo.ouuuuy.y"  // U+00C0..U+00FF
+            "aaaaaaccccccccdd" "ddeeeeeeeeeegggg" "gggghhhhiiiiiiii" "ii..jjkk.lllllll"  // U+0100..U+013F
+            "lllnnnnnnn..oooo" "oo..rrrrrrssssss" "ssttttttuuuuuuuu" "uuuuwwyyyzzzzzzs"; // U+0140..U+017F
+        for (unsigned cp = tableStart; cp < tableEnd; ++cp) {
+            lower_[cp - tableStart] = encode(toLower(cp));
+            char const b = base[cp - tableStart];
+            folded_[cp - tableStart] = b == '.' ? lower_[cp - tableStart] : encode(static_cast<unsigned char>(b));
+        }
+    }
+
+    static unsigned toLower(unsigned cp) {
+        if (cp == 0x130) {
+            return 'i'; // İ
+        }
+        if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) {
+            return cp + 0x20;
+        }
+        if (cp == 0x178) {
+            return 0xFF; // Ÿ
+        }
+        // Latin Extended-A büyük/küçük çiftleri: çoğunda büyük harf çift, iki aralıkta tek sayıdır
+        bool const evenUpper = (cp >= 0x100 && cp <= 0x137) || (cp >= 0x14A && cp <= 0x177);
+        bool const oddUpper = (cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E);
+        if ((evenUpper && cp % 2 == 0) || (oddUpper && cp % 2 == 1)) {
+            return cp + 1;
+        }
+        return cp;
+    }
+
+    static Mapping encode(unsigned cp) {
+        if (cp < 0x80) {
+            return { { static_cast<char>(cp), 0 }, 1 };
+        }
+        return { { static_cast<char>(0xC0 | (cp >> 6)), static_cast<char>(0x80 | (cp & 0x3F)) }, 2 };
+    }
+};
+
+// Normalleştirilmiş mesajın 64 bit özeti. Tohum süreç başında rastgele seçilir; böylece önbellekte
+// çakışan anahtarlar dışarıdan hazırlanıp yanlış cevap döndürtülemez.
+std::uint64_t messageHash(std::string_view text) {
+    static const std::uint64_t seed = (static_cast<std::uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+    auto mix = [](std::uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    };
+    std::uint64_t h = seed ^ (text.size() * 0x9e3779b97f4a7c15ull);
+    std::size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, text.data() + i, 8);
+        h = mix(h ^ word);
+    }
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, text.data() + i, text.size() - i);
+    return mix(h ^ tail ^ 0xff);
+}
+
+// Hazır JSON cevapların önbelleği: anahtar, normalleştirilmiş mesajın özeti. Anahtarın üst bitleri
+// parçayı (shard) seçer; her parça kendi kilidi ve sabit kapasitesiyle ayrı bir LRU listesidir.
+// Girişler önceden ayrılmış bir dizide durur, dolunca en eski giriş yenisine yer açar. Her girişle
+// birlikte cevabın niyeti de saklanır; isabette oturumlar mesajı yeniden eşleştirmeden güncellenir.
+class ReplyCache {
+public:
+    explicit ReplyCache(std::size_t capacity) {
+        std::size_t const perShard = (capacity + shardCount - 1) / shardCount;
+        for (Shard& shard : shards_) {
+            shard.capacity = perShard;
+            shard.entries.reserve(perShard);
+            shard.index.reserve(perShard);
+        }
+    }
+
+    // validUntil geçmişse giriş silinir ve bulunamadı sayılır; bulunursa niyeti intent'e yazılır
+    std::shared_ptr<const std::string> find(std::uint64_t key, std::time_t now, int& intent) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return nullptr;
+        }
+        std::uint32_t const slot = it->second;
+        Entry& entry = shard.entries[slot];
+        if (entry.validUntil != 0 && now >= entry.validUntil) {
+            // Süresi dolan giriş listenin sonuna alınır; ilk yer gerektiğinde o kullanılır
+            shard.index.erase(it);
+            entry.reply.reset();
+            unlink(shard, slot);
+            pushBack(shard, slot);
+            return nullptr;
+        }
+        unlink(shard, slot);
+        pushFront(shard, slot);
+        intent = entry.intent;
+        return entry.reply;
+    }
+
+    // validUntil 0 ise giriş süresizdir (yalnızca LRU ile çıkar)
+    void store(std::uint64_t key, std::shared_ptr<const std::string> reply, int intent, std::time_t validUntil) {
+        Shard& shard = shardFor(key);
+        if (shard.capacity == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        std::uint32_t slot;
+        if (it != shard.index.end()) {
+            slot = it->second;
+            unlink(shard, slot);
+        }
+        else if (shard.entries.size() < shard.capacity) {
+            slot = static_cast<std::uint32_t>(shard.entries.size());
+            shard.entries.emplace_back();
+        }
+        else {
+            slot = shard.tail;
+            if (shard.entries[slot].reply) {
+                shard.index.erase(shard.entries[slot].key);
+            }
+            unlink(shard, slot);
+        }
+        Entry& entry = shard.entries[slot];
+        entry.key = key;
+        entry.reply = std::move(reply);
+        entry.intent = intent;
+        entry.validUntil = validUntil;
+        shard.index[key] = slot;
+        pushFront(shard, slot);
+    }
+
+private:
+    static constexpr std::size_t shardCount = 16;
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    struct Entry {
+        std::uint64_t key = 0;
+        std::shared_ptr<const std::string> reply; // boşsa giriş kullanılmıyor
+        int intent = IntentMatcher::noMatch;
+        std::time_t validUntil = 0;
+        std::uint32_t prev = none;
+        std::uint32_t next = none;
+    };
+
+    // Anahtar zaten karışık olduğundan tablo onu olduğu gibi kullanır
+    struct KeyHash {
+        std::size_t operator()(std::uint64_t key) const { return static_cast<std::size_t>(key); }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;
+        std::unordered_map<std::uint64_t, std::uint32_t, KeyHash> index;
+        std::uint32_t head = none; // en son kullanılan
+        std::uint32_t tail = none; // ilk çıkarılacak
+        std::size_t capacity = 0;
+    };
+
+    Shard shards_[shardCount];
+
+    Shard& shardFor(std::uint64_t key) {
+        return shards_[key >> 60];
+    }
+
+    static void unlink(Shard& shard, std::uint32_t slot) {
+        Entry& entry = shard.entries[slot];
+        (entry.prev == none ? shard.head : shard.entries[entry.prev].next) = entry.next;
+        (entry.next == none ? shard.tail : shard.entries[entry.next].prev) = entry.prev;
+        entry.prev = entry.next = none;
+    }
+
+    static void pushFront(Shard& shard, std::uint32_t slot) {
+        Entry& entry = shard.entries[slot];
+        entry.next = shard.head;
+        (shard.head == none ? shard.tail : shard.entries[shard.head].prev) = slot;
+        shard.head = slot;
+    }
+
+    static void pushBack(Shard& shard, std::uint32_t slot) {
+        Entry& entry = shard.entries[slot];
+        entry.prev = shard.tail;
+        (shard.tail == none ? shard.head : shard.entries[shard.tail].next) = slot;
+        shard.tail = slot;
+    }
+};
+
+// Dosyadan yüklenip derlenmiş niyet tablosu. Kurulduktan sonra değişmez; yeniden yüklemede yenisi
+// kurulur ve eskisi, onu kullanan son istek bitince serbest kalır.
+struct IntentSet {
+    std::vector<Intent> intents; // önceliğe göre sıralı; eşleştirici bu sırayı döner
+    std::string fallback;
+    bool foldDiacritics;         // mesajlar da ifadelerle aynı biçimde normalleştirilmeli
+    IntentMatcher matcher;
+    FuzzyMatcher fuzzy;          // tam eşleşme yoksa yazım hatalarına göz yumarak tekrar denenir
+    IntentMatcher followUps;     // "daha fazla" gibi devam ifadeleri (tek niyet gibi derlenir)
+    std::vector<std::uint32_t> ids; // niyet adlarının özeti; oturumlar yeniden yüklemeden etkilenmesin diye
+    // Bu tablonun ürettiği cevaplar; tablo değişince önbellek de onunla birlikte yenilenir
+    mutable ReplyCache replies;
+
+    IntentSet(std::vector<Intent> list, std::string fallbackReply, std::vector<std::string> followUpPhrases, bool fold,
+              std::size_t cacheCapacity)
+        : intents(std::move(list)), fallback(std::move(fallbackReply)), foldDiacritics(fold), matcher(intents),
+        fuzzy(intents), followUps(std::vector<Intent>{ Intent{ "followUps", 0, std::move(followUpPhrases), "", "" } }),
+        replies(cacheCapacity) {
+        for (const Intent& intent : intents) {
+            ids.push_back(static_cast<std::uint32_t>(messageHash(intent.name)));
+        }
+    }
+
+    // Kimliği verilen niyetin sırası; bu tabloda yoksa -1
+    int findIntent(std::uint32_t id) const {
+        auto const it = std::find(ids.begin(), ids.end(), id);
+        return it == ids.end() ? -1 : static_cast<int>(it - ids.begin());
+    }
+
+    // Mesajı bu tablonun ifadeleriyle karşılaştırılabilir hale getir
+    void normalize(std::string_view message, std::string& out) const {
+        TextNormalizer::instance().normalize(message, foldDiacritics, out);
+    }
+};
+
+// Niyet dosyasını oku ve doğrula; hatada nullptr döner ve error doldurulur
+std::shared_ptr<const IntentSet> loadIntents(const std::string& path, std::size_t cacheCapacity, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "dosya açılamadı";
+        return nullptr;
+    }
+    std::string const text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(text, root) || !root.isObject()) {
+        error = "geçersiz JSON: " + reader.getFormattedErrorMessages();
+        while (!error.empty() && std::isspace(static_cast<unsigned char>(error.back()))) {
+            error.pop_back();
+        }
+        return nullptr;
+    }
+    if (!root["fallback"].isString() || !root["intents"].isArray()) {
+        error = "'fallback' ve 'intents' alanları gerekli";
+        return nullptr;
+    }
+    if (root.isMember("foldDiacritics") && !root["foldDiacritics"].isBool()) {
+        error = "'foldDiacritics' true/false olmalı";
+        return nullptr;
+    }
+    bool const fold = root.get("foldDiacritics", false).asBool();
+    if (root.isMember("followUps") && !root["followUps"].isArray()) {
+        error = "'followUps' metin dizisi olmalı";
+        return nullptr;
+    }
+    std::vector<std::string> followUps;
+    for (const Json::Value& phrase : root["followUps"]) {
+        if (!phrase.isString() || phrase.asString().empty()) {
+            error = "'followUps' boş olmayan metinler içermeli";
+            return nullptr;
+        }
+        followUps.emplace_back();
+        TextNormalizer::instance().normalize(phrase.asString(), fold, followUps.back());
+    }
+
+    std::vector<Intent> intents;
+    for (const Json::Value& item : root["intents"]) {
+        Intent intent;
+        std::string const position = "intents[" + std::to_string(intents.size()) + "]";
+        if (!item.isObject() || !item["reply"].isString() || !item["phrases"].isArray() || item["phrases"].empty()) {
+            error = position + ": 'phrases' ve 'reply' alanları gerekli";
+            return nullptr;
+        }
+        if (item.isMember("priority") && !item["priority"].isInt()) {
+            error = position + ": 'priority' tam sayı olmalı";
+            return nullptr;
+        }
+        if (item.isMember("more") && !item["more"].isString()) {
+            error = position + ": 'more' metin olmalı";
+            return nullptr;
+        }
+        intent.name = item.get("name", position).asString();
+        intent.priority = item.get("priority", 0).asInt();
+        intent.reply = item["reply"].asString();
+        intent.more = item.get("more", "").asString();
+        for (const Json::Value& phrase : item["phrases"]) {
+            if (!phrase.isString() || phrase.asString().empty()) {
+                error = position + ": ifadeler boş olmayan metin olmalı";
+                return nullptr;
+            }
+            // Mesajlar normalleştirilerek arandığından ifadeler de öyle saklanır
+            std::string normalized;
+            TextNormalizer::instance().normalize(phrase.asString(), fold, normalized);
+            intent.phrases.push_back(std::move(normalized));
+        }
+        intents.push_back(std::move(intent));
+    }
+    std::stable_sort(intents.begin(), intents.end(),
+                     [](const Intent& a, const Intent& b) { return a.priority < b.priority; });
+    return std::make_shared<const IntentSet>(std::move(intents), root["fallback"].asString(), std::move(followUps), fold,
+                                             cacheCapacity);
+}
+
+// Geçerli niyet tablosu. Dosya değişince yeni tablo arka planda kurulur ve tek bir işaretçi
+// değişimiyle devreye girer; istekler kilit beklemez, o an elindeki tabloyla işini bitirir.
+class IntentStore {
+public:
+    IntentStore(std::string path, std::size_t cacheCapacity) : path_(std::move(path)), cacheCapacity_(cacheCapacity) {}
+
+    IntentStore(const IntentStore&) = delete;
+    IntentStore& operator=(const IntentStore&) = delete;
+
+    ~IntentStore() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (watcher_.joinable()) {
+            watcher_.join();
+        }
+    }
+
+    const std::string& path() const { return path_; }
+
+    std::shared_ptr<const IntentSet> current() const {
+        return std::atomic_load(&current_);
+    }
+
+    // Dosyayı yükle; başarısızsa mevcut tablo yerinde kalır
+    bool reload(std::string& error) {
+        stamp_ = fileStamp();
+        std::shared_ptr<const IntentSet> next = loadIntents(path_, cacheCapacity_, error);
+        if (!next) {
+            return false;
+        }
+        std::atomic_store(&current_, std::move(next));
+        return true;
+    }
+
+    // Dosyanın değişim zamanını ve boyutunu periyodik olarak kontrol eden thread'i başlat
+    void watch(std::chrono::milliseconds every) {
+        watcher_ = std::thread([this, every] {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!wake_.wait_for(lock, every, [this] { return stopping_; })) {
+                if (fileStamp() == stamp_) {
+                    continue;
+                }
+                std::string error;
+                if (reload(error)) {
+                    std::cout << "Niyet tablosu yeniden yüklendi: " << current()->intents.size() << " niyet" << std::endl;
+                }
+                else {
+                    std::cerr << "Niyet tablosu yüklenemedi (" << path_ << "): " << error << ", eski tablo kullanılıyor" << std::endl;
+                }
+            }
+        });
+    }
+
+private:
+    using Stamp = std::pair<std::filesystem::file_time_type, std::uintmax_t>;
+
+    Stamp fileStamp() const {
+        std::error_code ec;
+        auto const modified = std::filesystem::last_write_time(path_, ec);
+        auto const size = std::filesystem::file_size(path_, ec);
+        return { ec ? std::filesystem::file_time_type{} : modified, ec ? 0 : size };
+    }
+
+    std::string path_;
+    std::size_t cacheCapacity_;
+    std::shared_ptr<const IntentSet> current_; // std::atomic_load/atomic_store ile erişilir
+    Stamp stamp_{};
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread watcher_;
+};
+
+// Niyet cevabını hazırla: "{saat}" yer tutucusu anlık saatle doldurulur. Saat içeren cevap
+// yalnızca o dakika boyunca geçerlidir; validUntil bir sonraki dakikanın başına ayarlanır.
+// Dönen görünüm ya tablodaki metni ya da rendered tamponunu gösterir.
+std::string_view renderReply(const std::string& reply, std::time_t now, std::time_t& validUntil, std::string& rendered) {
+    std::string::size_type const at = reply.find("{saat}");
+    if (at == std::string::npos) {
+        return reply;
+    }
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    char buffer[80];
+    strftime(buffer,sizeof(buffer),"%H:%M",&local);
+    // Saat dilimleri tam dakika kaydığından yerel dakika da UTC dakikasıyla aynı anda değişir
+    validUntil = now - now % 60 + 60;
+    rendered.assign(reply, 0, at);
+    rendered += buffer;
+    rendered.append(reply, at + 6, std::string::npos);
+    return rendered;
+}
+
+// Normalleştirilmiş mesajın niyeti: önce tam, sonra bulanık eşleştirme; hiçbiri yoksa noMatch
+int matchIntent(const IntentSet& set, std::string_view normalizedMessage) {
+    int const intent = set.matcher.match(normalizedMessage);
+    return intent != IntentMatcher::noMatch ? intent : set.fuzzy.match(normalizedMessage);
+}
+
+// Eşleştirilmiş niyetin (ya da noMatch) cevabı. Mesaj hem bir niyete hem bir devam ifadesine uyuyorsa
+// ("hikaye hakkında daha fazla") niyetin ek cevabı verilir; sonuç yine yalnızca mesaja bağlıdır.
+std::string_view getIntentResponse(const IntentSet& set, int intent, std::string_view normalizedMessage,
+                                   std::time_t now, std::time_t& validUntil, std::string& rendered) {
+    if (intent == IntentMatcher::noMatch) {
+        return set.fallback;
+    }
+    const Intent& matched = set.intents[intent];
+    bool const more = !matched.more.empty() && set.followUps.match(normalizedMessage) != IntentMatcher::noMatch;
+    return renderReply(more ? matched.more : matched.reply, now, validUntil, rendered);
+}
+
+// Normalleştirilmiş mesaja chatbot yanıtı
+std::string_view getBotResponse(const IntentSet& set, std::string_view normalizedMessage, std::time_t now,
+                                std::time_t& validUntil, std::string& rendered) {
+    return getIntentResponse(set, matchIntent(set, normalizedMessage), normalizedMessage, now, validUntil, rendered);
+}
+
+// Sohbet oturumları: her oturum son historySize niyeti tutar, böylece "daha fazla" gibi bir devam
+// isteği önceki konuya bağlanabilir. Oturumlar başta ayrılan sabit boyutlu bir slab'da durur; kovalar
+// ve listeler slab içindeki sıra numaralarıyla kurulduğundan istek yolunda bellek ayrılmaz ve toplam
+// bellek kapasiteyle sınırlıdır. Kimlik özetinin üst bitleri parçayı seçer, her parçanın kendi kilidi
+// vardır. Süre dolumu zaman çarkıyla izlenir: oturum, son erişiminden ttl sonra düşeceği dilimin
+// listesine bağlanır ve parçaya her erişimde aradan geçen dilimler boşaltılır. Parça doluysa süresi
+// en yakın oturum yeni gelene yer açar.
+class SessionStore {
+public:
+    static constexpr std::size_t historySize = 4;
+    static constexpr std::size_t maxIdLength = 48;
+
+    struct Stats {
+        std::size_t active = 0;
+        std::size_t capacity = 0;
+        std::size_t bytes = 0;    // slab, kova ve çark dizileri birlikte
+        std::uint64_t expired = 0; // süresi dolduğu için düşen
+        std::uint64_t evicted = 0; // yer açmak için atılan
+    };
+
+    SessionStore(std::size_t capacity, std::chrono::seconds ttl) {
+        // ttl en fazla wheelSize - 1 dilime yayılır; böylece bir dilimdeki oturumların hepsi aynı turda düşer.
+        // Erişilen dilimin bir kısmı geçmiş olabileceğinden bir dilim fazladan sayılır: oturum ttl ile
+        // ttl + bir dilim arasında bir sürede düşer, hiçbir zaman erken düşmez.
+        long long const seconds = std::max<long long>(1, ttl.count());
+        tickSeconds_ = std::max<long long>(1, (seconds + wheelSize - 3) / (wheelSize - 2));
+        ticksPerTtl_ = (seconds + tickSeconds_ - 1) / tickSeconds_ + 1;
+        std::size_t const perShard = (capacity + shardCount - 1) / shardCount;
+        std::size_t buckets = 1;
+        while (buckets < perShard) {
+            buckets <<= 1;
+        }
+        for (Shard& shard : shards_) {
+            shard.slab.resize(perShard);
+            shard.buckets.assign(perShard == 0 ? 0 : buckets, none);
+            shard.wheel.fill(none);
+            for (std::size_t i = 0; i < perShard; ++i) {
+                shard.slab[i].next = i + 1 < perShard ? static_cast<std::uint32_t>(i + 1) : none;
+            }
+            shard.free = perShard == 0 ? none : 0;
+        }
+    }
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    bool enabled() const { return !shards_[0].slab.empty(); }
+
+    // Oturumun niyetlerini yeniden eskiye recent'e yazar ve sayısını döner (oturum yoksa 0);
+    // bulunan oturumun süresi tazelenir
+    std::size_t recall(std::string_view id, std::time_t now, std::array<std::uint32_t, historySize>& recent) {
+        std::uint64_t const hash = messageHash(id);
+        Shard& shard = shardFor(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::int64_t const tick = advance(shard, now);
+        std::uint32_t const slot = find(shard, hash, id);
+        if (slot == none) {
+            return 0;
+        }
+        Session& session = shard.slab[slot];
+        std::copy(session.recent, session.recent + session.count, recent.begin());
+        schedule(shard, slot, tick + ticksPerTtl_);
+        return session.count;
+    }
+
+    // Niyeti oturumun başına ekle (en eskisi düşer); oturum yoksa açılır
+    void remember(std::string_view id, std::uint32_t intent, std::time_t now) {
+        std::uint64_t const hash = messageHash(id);
+        Shard& shard = shardFor(hash);
+        if (shard.slab.empty() || id.size() > maxIdLength) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::int64_t const tick = advance(shard, now);
+        std::uint32_t slot = find(shard, hash, id);
+        if (slot == none) {
+            slot = open(shard, hash, id);
+        }
+        Session& session = shard.slab[slot];
+        if (session.count == 0 || session.recent[0] != intent) {
+            std::copy_backward(session.recent, session.recent + std::min<std::size_t>(session.count, historySize - 1),
+                               session.recent + std::min<std::size_t>(session.count + 1, historySize));
+            session.recent[0] = intent;
+            session.count = static_cast<std::uint8_t>(std::min<std::size_t>(session.count + 1, historySize));
+        }
+        schedule(shard, slot, tick + ticksPerTtl_);
+    }
+
+    Stats stats(std::time_t now) {
+        Stats total;
+        for (Shard& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            advance(shard, now);
+            total.active += shard.active;
+            total.capacity += shard.slab.size();
+            total.bytes += shard.slab.size() * sizeof(Session) + shard.buckets.size() * sizeof(std::uint32_t)
+                + sizeof(shard.wheel);
+            total.expired += shard.expired;
+            total.evicted += shard.evicted;
+        }
+        return total;
+    }
+
+private:
+    static constexpr std::size_t shardCount = 16;
+    static constexpr std::size_t wheelSize = 64;
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    struct Session {
+        std::uint64_t hash = 0;
+        std::int64_t expires = -1;      // düşeceği dilim; -1: çarkta değil
+        std::uint32_t next = none;      // kovadaki sonraki oturum; boşsa boş listedeki sonraki yer
+        std::uint32_t timerPrev = none; // çark dilimindeki çift yönlü liste
+        std::uint32_t timerNext = none;
+        std::uint32_t recent[historySize] = {}; // niyet kimlikleri, yeniden eskiye
+        std::uint8_t count = 0;
+        std::uint8_t idLength = 0;
+        char id[maxIdLength] = {};
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::vector<Session> slab;
+        std::vector<std::uint32_t> buckets;          // özet -> kovadaki ilk oturum
+        std::array<std::uint32_t, wheelSize> wheel{}; // dilim -> o dilimde düşecek ilk oturum
+        std::uint32_t free = none;
+        std::size_t active = 0;
+        std::int64_t lastTick = -1;
+        std::uint64_t expired = 0;
+        std::uint64_t evicted = 0;
+    };
+
+    Shard shards_[shardCount];
+    std::int64_t tickSeconds_ = 1;
+    std::int64_t ticksPerTtl_ = 1;
+
+    Shard& shardFor(std::uint64_t hash) {
+        return shards_[hash >> 60];
+    }
+
+    std::uint32_t& bucketFor(Shard& shard, std::uint64_t hash) const {
+        return shard.buckets[hash & (shard.buckets.size() - 1)];
+    }
+
+    std::uint32_t find(Shard& shard, std::uint64_t hash, std::string_view id) const {
+        if (shard.buckets.empty()) {
+            return none;
+        }
+        for (std::uint32_t slot = bucketFor(shard, hash); slot != none; slot = shard.slab[slot].next) {
+            const Session& session = shard.slab[slot];
+            if (session.hash == hash && std::string_view(session.id, session.idLength) == id) {
+                return slot;
+            }
+        }
+        return none;
+    }
+
+    // Boş yer al; yoksa süresi en yakın oturumu at. Oturum kovaya eklenir, çarka schedule bağlar.
+    std::uint32_t open(Shard& shard, std::uint64_t hash, std::string_view id) {
+        if (shard.free == none) {
+            for (std::size_t i = 1; i <= wheelSize && shard.free == none; ++i) {
+                std::uint32_t const oldest = shard.wheel[(shard.lastTick + i) % wheelSize];
+                if (oldest != none) {
+                    release(shard, oldest);
+                    ++shard.evicted;
+                }
+            }
+        }
+        std::uint32_t const slot = shard.free;
+        Session& session = shard.slab[slot];
+        shard.free = session.next;
+        session.hash = hash;
+        session.count = 0;
+        session.idLength = static_cast<std::uint8_t>(id.size());
+        std::memcpy(session.id, id.data(), id.size());
+        std::uint32_t& bucket = bucketFor(shard, hash);
+        session.next = bucket;
+        bucket = slot;
+        ++shard.active;
+        return slot;
+    }
+
+    void release(Shard& shard, std::uint32_t slot) {
+        Session& session = shard.slab[slot];
+        std::uint32_t* link = &bucketFor(shard, session.hash);
+        while (*link != slot) {
+            link = &shard.slab[*link].next;
+        }
+        *link = session.next;
+        unschedule(shard, slot);
+        session.next = shard.free;
+        shard.free = slot;
+        --shard.active;
+    }
+
+    void unschedule(Shard& shard, std::uint32_t slot) {
+        Session& session = shard.slab[slot];
+        if (session.expires < 0) {
+            return;
+        }
+        (session.timerPrev == none ? shard.wheel[session.expires % wheelSize] : shard.slab[session.timerPrev].timerNext) =
+            session.timerNext;
+        if (session.timerNext != none) {
+            shard.slab[session.timerNext].timerPrev = session.timerPrev;
+        }
+        session.timerPrev = session.timerNext = none;
+        session.expires = -1;
+    }
+
+    void schedule(Shard& shard, std::uint32_t slot, std::int64_t expires) {
+        unschedule(shard, slot);
+        Session& session = shard.slab[slot];
+        session.expires = expires;
+        std::uint32_t& head = shard.wheel[expires % wheelSize];
+        session.timerNext = head;
+        if (head != none) {
+            shard.slab[head].timerPrev = slot;
+        }
+        head = slot;
+    }
+
+    // Son erişimden bu yana geçen dilimlerdeki süresi dolmuş oturumları sil; şimdiki dilimi döner
+    std::int64_t advance(Shard& shard, std::time_t now) {
+        std::int64_t const tick = static_cast<std::int64_t>(now) / tickSeconds_;
+        if (shard.lastTick < 0 || tick <= shard.lastTick) {
+            shard.lastTick = std::max(shard.lastTick, tick);
+            return shard.lastTick;
+        }
+        // Bir dilimdeki oturumlar en fazla bir tur ileridedir; tam tur geçtiyse her dilime bir kez bakmak yeter
+        std::int64_t const steps = std::min<std::int64_t>(tick - shard.lastTick, wheelSize);
+        for (std::int64_t i = 1; i <= steps; ++i) {
+            std::uint32_t slot = shard.wheel[(shard.lastTick + i) % wheelSize];
+            while (slot != none) {
+                std::uint32_t const next = shard.slab[slot].timerNext;
+                if (shard.slab[slot].expires <= tick) {
+                    release(shard, slot);
+                    ++shard.expired;
+                }
+                slot = next;
+            }
+        }
+        shard.lastTick = tick;
+        return tick;
+    }
+};
+
+// Hiçbir niyete uymayan devam isteği ("daha fazla"): oturumdaki son niyetlerden ek cevabı olan en
+// yenisinin devamı reply'a yazılır ve true döner. Böyle bir niyet yoksa olağan yol izlenir.
+bool getFollowUpResponse(const IntentSet& set, SessionStore& sessions, std::string_view session, std::time_t now,
+                         std::string& rendered, std::string_view& reply) {
+    std::array<std::uint32_t, SessionStore::historySize> recent;
+    std::size_t const count = sessions.recall(session, now, recent);
+    for (std::size_t i = 0; i < count; ++i) {
+        int const previous = set.findIntent(recent[i]);
+        if (previous >= 0 && !set.intents[previous].more.empty()) {
+            std::time_t validUntil = 0;
+            reply = renderReply(set.intents[previous].more, now, validUntil, rendered);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Mesajın gönderilecek hali; format cevap metnini /chatbot JSON'u ya da akış olayları olarak yazar.
+// Oturumlu istekte önce ucuz olan devam ifadesi denetlenir: niyete uymayan devam isteği oturumdan
+// cevaplanır ve önbelleğe girmez. Sonra önbelleğe bakılır; isabette oturuma girişle saklanan niyet
+// eklenir. Iskalamada mesaj bir kez eşleştirilir ve aynı niyet hem oturuma hem cevaba kullanılır.
+std::shared_ptr<const std::string> getReplyPayload(const IntentSet& set, SessionStore& sessions,
+                                                   std::string_view session, std::string_view normalizedMessage,
+                                                   std::uint64_t key, std::time_t now,
+                                                   const std::function<void(std::string&, std::string_view)>& format) {
+    bool const tracked = !session.empty() && sessions.enabled();
+    thread_local std::string rendered;
+    bool matched = false;
+    int intent = IntentMatcher::noMatch;
+    if (tracked && set.followUps.match(normalizedMessage) != IntentMatcher::noMatch) {
+        intent = matchIntent(set, normalizedMessage);
+        matched = true;
+        std::string_view reply;
+        if (intent == IntentMatcher::noMatch && getFollowUpResponse(set, sessions, session, now, rendered, reply)) {
+            std::string text;
+            format(text, reply);
+            return std::make_shared<const std::string>(std::move(text));
+        }
+    }
+
+    int cachedIntent = IntentMatcher::noMatch;
+    if (std::shared_ptr<const std::string> cached = set.replies.find(key, now, cachedIntent)) {
+        if (tracked && cachedIntent != IntentMatcher::noMatch) {
+            sessions.remember(session, set.ids[cachedIntent], now);
+        }
+        return cached;
+    }
+
+    if (!matched) {
+        intent = matchIntent(set, normalizedMessage);
+    }
+    if (tracked && intent != IntentMatcher::noMatch) {
+        sessions.remember(session, set.ids[intent], now);
+    }
+    std::time_t validUntil = 0;
+    std::string text;
+    format(text, getIntentResponse(set, intent, normalizedMessage, now, validUntil, rendered));
+    auto payload = std::make_shared<const std::string>(std::move(text));
+    set.replies.store(key, payload, intent, validUntil);
+    return payload;
+}
+
+// İstek gövdesini ağaç kurmadan okuyan JSON ayrıştırıcı. Değerler sırayla çekilir, istenmeyenler
+// doğrulanarak atlanır. Kaçış içermeyen metinler gövdenin içini gösteren string_view olarak döner;
+// kaçış varsa çözülmüş hali verilen tampona yazılır. Hata olursa sonraki tüm çağrılar başarısız olur.
+class JsonPullReader {
+public:
+    explicit JsonPullReader(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    bool failed() const { return failed_; }
+
+    bool beginObject() { return expect('{'); }
+    bool beginArray() { return expect('['); }
+
+    // Nesnenin sıradaki anahtarı; nesne bittiyse (veya hata varsa) false
+    bool nextMember(std::string_view& key) {
+        if (!nextItem('}')) {
+            return false;
+        }
+        if (!readString(key, keyScratch_) || !expect(':')) {
+            return false;
+        }
+        return true;
+    }
+
+    // Dizinin sıradaki elemanına geç; dizi bittiyse (veya hata varsa) false
+    bool nextElement() {
+        return nextItem(']');
+    }
+
+    // Sıradaki değerin ilk karakteri (değer tüketilmez); belge bittiyse veya hata varsa '\0'
+    char peek() {
+        skipSpace();
+        return !failed_ && p_ < end_ ? *p_ : '\0';
+    }
 
-Unutma, bazen sana cevap veremesem bile, kabusların sonsuz...)";
+    bool readString(std::string_view& out, std::string& scratch) {
+        if (!expect('"')) {
+            return false;
+        }
+        const char* const start = p_;
+        while (p_ < end_ && *p_ != '"' && *p_ != '\\') {
+            if (static_cast<unsigned char>(*p_) < 0x20) {
+                return fail();
+            }
+            ++p_;
+        }
+        if (p_ < end_ && *p_ == '"') {
+            out = std::string_view(start, static_cast<std::size_t>(p_ - start));
+            ++p_;
+            return true;
+        }
+        // Kaçış dizisi var: baştan itibaren tampona çöz
+        scratch.assign(start, static_cast<std::size_t>(p_ - start));
+        while (p_ < end_ && *p_ != '"') {
+            char const c = *p_++;
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return fail();
+            }
+            if (c != '\\') {
+                scratch += c;
+                continue;
+            }
+            if (p_ == end_) {
+                return fail();
+            }
+            switch (*p_++) {
+            case '"': scratch += '"'; break;
+            case '\\': scratch += '\\'; break;
+            case '/': scratch += '/'; break;
+            case 'b': scratch += '\b'; break;
+            case 'f': scratch += '\f'; break;
+            case 'n': scratch += '\n'; break;
+            case 'r': scratch += '\r'; break;
+            case 't': scratch += '\t'; break;
+            case 'u': {
+                unsigned cp;
+                if (!readHex4(cp)) {
+                    return fail();
+                }
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    // Vekil çifti: ardından düşük vekil (DC00..DFFF) gelmeli
+                    unsigned low;
+                    if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+                        return fail();
+                    }
+                    p_ += 2;
+                    if (!readHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                        return fail();
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                    return fail();
+                }
+                appendUtf8(scratch, cp);
+                break;
+            }
+            default:
+                return fail();
+            }
+        }
+        if (p_ == end_) {
+            return fail();
+        }
+        ++p_;
+        out = scratch;
+        return true;
     }
-    else if (lowerCaseMessage.find("nasılsın") != std::string::npos || lowerCaseMessage.find("naber") != std::string::npos) {
-        return "Karanlıkta beklemekten başka ne olabilirim ki? Sen nasılsın, kabuslara hazır mısın?";
+
+    // Sıradaki değeri (her türden) doğrulayarak atla
+    bool skipValue() {
+        return skipValue(0);
     }
-    else if (lowerCaseMessage.find("oyun hakkında bilgi") != std::string::npos || lowerCaseMessage.find("oyun nedir") != std::string::npos) {
-        return "Nightmare Realm, terk edilmiş bir akıl hastanesinde geçen, psikolojik ve hayatta kalma unsurları içeren bir korku oyunudur. Geçmişin sırlarını çözmeli ve dehşetle yüzleşmelisin.";
+
+    // Belgenin sonunda yalnızca boşluk kalmalı
+    bool finish() {
+        skipSpace();
+        return p_ == end_ || fail();
     }
-    else if (lowerCaseMessage.find("nasıl indirilir") != std::string::npos || lowerCaseMessage.find("indir") != std::string::npos) {
-        return "Oyunumuzu indirmek için 'Şimdi İndir' butonuna tıklayarak ilgili platformlara yönlenebilirsin. Sistem gereksinimlerini kontrol etmeyi unutma!";
+
+private:
+    static constexpr int maxDepth = 64;
+
+    const char* p_;
+    const char* end_;
+    bool failed_ = false;
+    bool first_ = true; // nesne/dizide henüz eleman okunmadı
+    std::string keyScratch_;
+    std::string valueScratch_;
+
+    bool fail() {
+        failed_ = true;
+        p_ = end_;
+        return false;
     }
-    else if (lowerCaseMessage.find("hikaye") != std::string::npos || lowerCaseMessage.find("konu") != std::string::npos) {
-        return "Hikaye, bir akıl hastanesinin karanlık geçmişiyle yüzleşen bir karakterin etrafında dönüyor. Çevreyle etkileşime geçmeli, bulmacaları çözmeli ve hayatta kalmalısın.";
+
+    void skipSpace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+            ++p_;
+        }
     }
-    else if (lowerCaseMessage.find("özellikler") != std::string::npos) {
-        return "Oyunumuz yoğun psikolojik korku, akıl almaz bulmacalar, gerçekçi atmosfer ve sürükleyici bir hikaye sunuyor.";
+
+    bool expect(char c) {
+        if (failed_) {
+            return false;
+        }
+        skipSpace();
+        if (p_ == end_ || *p_ != c) {
+            return fail();
+        }
+        ++p_;
+        first_ = c == '{' || c == '[';
+        return true;
+    }
+
+    // Eleman ayıracını (',') veya kapanışı oku
+    bool nextItem(char close) {
+        if (failed_) {
+            return false;
+        }
+        skipSpace();
+        if (p_ < end_ && *p_ == close) {
+            ++p_;
+            first_ = false;
+            return false;
+        }
+        if (!first_ && !expect(',')) {
+            return false;
+        }
+        first_ = false;
+        return true;
+    }
+
+    bool skipValue(int depth) {
+        if (failed_) {
+            return false;
+        }
+        if (depth > maxDepth) {
+            return fail();
+        }
+        skipSpace();
+        if (p_ == end_) {
+            return fail();
+        }
+        switch (*p_) {
+        case '"': {
+            std::string_view ignored;
+            return readString(ignored, valueScratch_);
+        }
+        case '{': {
+            expect('{');
+            std::string_view key;
+            while (nextMember(key)) {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            }
+            return !failed_;
+        }
+        case '[':
+            expect('[');
+            while (nextElement()) {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            }
+            return !failed_;
+        case 't': return literal("true");
+        case 'f': return literal("false");
+        case 'n': return literal("null");
+        default: return number();
+        }
     }
-    else if (lowerCaseMessage.find("saat kaç") != std::string::npos || lowerCaseMessage.find("zaman") != std::string::npos) {
-        // C++ ile anlık saat bilgisi almak
-        time_t rawtime;
-        struct tm * timeinfo;
-        char buffer[80];
-        time (&rawtime);
-        timeinfo = localtime(&rawtime);
-        strftime(buffer,sizeof(buffer),"%H:%M",timeinfo);
-        return "Burada zamanın bir önemi yok... Ama dışarıda saat " + std::string(buffer) + ".";
+
+    bool literal(std::string_view word) {
+        if (static_cast<std::size_t>(end_ - p_) < word.size() || std::string_view(p_, word.size()) != word) {
+            return fail();
+        }
+        p_ += word.size();
+        return true;
     }
-    else if (lowerCaseMessage.find("teşekkürler") != std::string::npos || lowerCaseMessage.find("sağ ol") != std::string::npos) {
-        return "Rica ederim. Gecenin karanlığı seninle olsun.";
+
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool number() {
+        auto digits = [this] {
+            const char* const start = p_;
+            while (p_ < end_ && *p_ >= '0' && *p_ <= '9') {
+                ++p_;
+            }
+            return p_ != start;
+        };
+        if (p_ < end_ && *p_ == '-') {
+            ++p_;
+        }
+        if (p_ < end_ && *p_ == '0') {
+            ++p_;
+        }
+        else if (!digits()) {
+            return fail();
+        }
+        if (p_ < end_ && *p_ == '.') {
+            ++p_;
+            if (!digits()) {
+                return fail();
+            }
+        }
+        if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+            ++p_;
+            if (p_ < end_ && (*p_ == '+' || *p_ == '-')) {
+                ++p_;
+            }
+            if (!digits()) {
+                return fail();
+            }
+        }
+        return true;
     }
-    else if (lowerCaseMessage.find("merhaba") != std::string::npos || lowerCaseMessage.find("selam") != std::string::npos) {
-        return "Uyanık kaldığına sevindim. Sana nasıl yardımcı olabilirim?";
+
+    bool readHex4(unsigned& value) {
+        if (end_ - p_ < 4) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char const c = *p_++;
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= static_cast<unsigned>(c - '0');
+            }
+            else if (c >= 'a' && c <= 'f') {
+                value |= static_cast<unsigned>(c - 'a' + 10);
+            }
+            else if (c >= 'A' && c <= 'F') {
+                value |= static_cast<unsigned>(c - 'A' + 10);
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
     }
-    else if (lowerCaseMessage.find("korkunç") != std::string::npos) {
-        return "Burası korkunun kendisi... Daha fazlasını görmek ister misin?";
+
+    static void appendUtf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        }
+        else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
     }
-    else if (lowerCaseMessage.find("sistem gereksinimleri") != std::string::npos || lowerCaseMessage.find("minimum özellikler") != std::string::npos) {
-        return "Minimum gereksinimler: Windows 10 (64-bit), Intel Core i5-4460, 8 GB RAM, NVIDIA GTX 760 ve 25 GB depolama alanı.";
+};
+
+// Metni JSON dizgesi olarak (tırnaklarıyla) ekle. UTF-8 olduğu gibi yazılır; yalnızca tırnak,
+// ters bölü ve kontrol karakterleri kaçışlanır. Kaçış gerektirmeyen aralıklar tek seferde kopyalanır.
+void appendJsonString(std::string& out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        unsigned char const c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out += hex[c >> 4];
+            out += hex[c & 0xF];
+        }
     }
-    else if (lowerCaseMessage.find("çıkış tarihi") != std::string::npos || lowerCaseMessage.find("ne zaman çıkacak") != std::string::npos) {
-        return "Oyunumuzun tam çıkış tarihi yakında duyurulacak, gelişmeleri takipte kal!";
+    out.append(text.data() + run, text.size() - run);
+    out += '"';
+}
+
+// Cevabı Server-Sent Events olarak ekle: her kelime (ardındaki boşluklarla birlikte) ayrı bir
+// {"token": ...} olayıdır, istemci geldikçe ekleyerek yazma efekti verir; son olay "done".
+// Kelimeler yalnızca ASCII boşlukta bölündüğünden UTF-8 karakterler parçalanmaz.
+void appendSseReply(std::string& out, std::string_view reply) {
+    std::size_t start = 0;
+    while (start < reply.size()) {
+        std::size_t end = reply.find(' ', start);
+        end = end == std::string_view::npos ? reply.size() : reply.find_first_not_of(' ', end);
+        end = end == std::string_view::npos ? reply.size() : end;
+        out += "data: {\"token\":";
+        appendJsonString(out, reply.substr(start, end - start));
+        out += "}\n\n";
+        start = end;
     }
-    else if (lowerCaseMessage.find("ana karakter") != std::string::npos || lowerCaseMessage.find("kiminle oynuyoruz") != std::string::npos) {
-        return "Oyunumuzda, geçmişinin izlerini süren, hafızasını kaybetmiş bir karakteri canlandırıyorsun. Kim olduğunu ve neden burada olduğunu keşfetmelisin.";
+    out += "event: done\ndata: {}\n\n";
+}
+
+// /chatbot gövdesinden "message" ve isteğe bağlı "session" alanları; başka alanlar doğrulanıp atlanır.
+// session verilmemişse boş kalır.
+enum class RequestError { none, invalidJson, invalidField, invalidSession };
+
+RequestError readMessageField(std::string_view body, std::string_view& message, std::string& scratch,
+                              std::string_view& session, std::string& sessionScratch) {
+    JsonPullReader reader(body);
+    bool found = false;
+    bool sessionValid = true;
+    session = {};
+    std::string_view key;
+    if (reader.beginObject()) {
+        while (reader.nextMember(key)) {
+            if (key == "session" && reader.peek() == '"') {
+                sessionValid = reader.readString(session, sessionScratch) && session.size() <= SessionStore::maxIdLength;
+            }
+            else if (key == "session") {
+                sessionValid = false;
+                reader.skipValue();
+            }
+            else if (key == "message" && reader.peek() == '"') {
+                // Aynı anahtar tekrar ederse sonuncusu geçerlidir
+                found = reader.readString(message, scratch);
+            }
+            else if (key == "message") {
+                found = false;
+                reader.skipValue();
+            }
+            else {
+                reader.skipValue();
+            }
+        }
     }
-    else if (lowerCaseMessage.find("kaç sonu var") != std::string::npos || lowerCaseMessage.find("oyunun sonu") != std::string::npos) {
-        return "Nightmare Realm'de kararlarına göre şekillenen birden fazla son bulunuyor. Her seçim, farklı bir kaderin kapısını arayabilir.";
+    if (reader.failed() || !reader.finish()) {
+        return RequestError::invalidJson;
     }
-    else if (lowerCaseMessage.find("zorluk seviyesi") != std::string::npos || lowerCaseMessage.find("nasıl zor") != std::string::npos) {
-        return "Oyunumuz zorlayıcı bulmacalar ve sürekli bir gerilim sunuyor. Hayatta kalmak için dikkatli olmalı ve kaynaklarını iyi yönetmelisin.";
+    if (!found) {
+        return RequestError::invalidField;
     }
-    else if (lowerCaseMessage.find("destek") != std::string::npos || lowerCaseMessage.find("iletişim") != std::string::npos) {
-        return "Herhangi bir sorun için lütfen destek sayfamızı ziyaret et veya [email@example.com](mailto:email@example.com) adresinden bize ulaş. Ama dikkatli ol, bazı soruların cevabı seni beklediğinden daha çok ürkütebilir...";
+    return sessionValid ? RequestError::none : RequestError::invalidSession;
+}
+
+// Toplu isteklerin mesajlarını paylaşılan thread'lere dağıtan havuz. İş parçalar (chunk) halinde
+// dağıtılır: her thread sıradaki parçayı atomik bir sayaçla alır, böylece kısa ve uzun mesajlar
+// thread'ler arasında kendiliğinden dengelenir. İsteği getiren thread de beklemek yerine işe katılır.
+class BatchPool {
+public:
+    explicit BatchPool(std::size_t threads) {
+        for (std::size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    BatchPool(const BatchPool&) = delete;
+    BatchPool& operator=(const BatchPool&) = delete;
+
+    ~BatchPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    std::size_t size() const { return workers_.size(); }
+
+    // fn(i) her i < count için bir kez çağrılır; hepsi bitince döner
+    void run(std::size_t count, std::size_t chunk, const std::function<void(std::size_t)>& fn) {
+        if (count == 0) {
+            return;
+        }
+        auto job = std::make_shared<Job>(count, std::max<std::size_t>(1, chunk), fn);
+        if (count > job->chunk) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(job);
+            }
+            wake_.notify_all();
+        }
+        work(*job);
+
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->done.wait(lock, [&] { return job->finished == job->count; });
+    }
+
+private:
+    struct Job {
+        std::size_t count;
+        std::size_t chunk;
+        const std::function<void(std::size_t)>& fn;
+        std::atomic<std::size_t> next{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t finished = 0;
+
+        Job(std::size_t n, std::size_t c, const std::function<void(std::size_t)>& f) : count(n), chunk(c), fn(f) {}
+    };
+
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<Job>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+
+    // Parça kalmayana kadar al ve işle; fn'e yalnızca parça alınabildiyse dokunulur
+    static void work(Job& job) {
+        for (;;) {
+            std::size_t const begin = job.next.fetch_add(job.chunk);
+            if (begin >= job.count) {
+                return;
+            }
+            std::size_t const end = std::min(job.count, begin + job.chunk);
+            for (std::size_t i = begin; i < end; ++i) {
+                job.fn(i);
+            }
+            std::lock_guard<std::mutex> lock(job.mutex);
+            job.finished += end - begin;
+            if (job.finished == job.count) {
+                job.done.notify_all();
+            }
+        }
+    }
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            std::shared_ptr<Job> job = queue_.front();
+            if (job->next.load() >= job->count) {
+                // Tüm parçaları dağıtılmış iş kuyruktan çıkar (bitmesini sahibi bekler)
+                queue_.pop_front();
+                continue;
+            }
+            lock.unlock();
+            work(*job);
+            lock.lock();
+        }
+    }
+};
+
+// İstek günlüğü. Her thread kayıtlarını kendi halka tamponuna kilitsiz yazar (tek yazar, tek okuyucu);
+// arka plandaki thread tamponları düzenli aralıklarla boşaltıp kayıtları tek seferde dosyaya ya da
+// stdout'a yazar. İstek thread'i hiçbir zaman beklemez: tampon doluysa kayıt atılır ve sayılır.
+// Örnekleme açıksa her thread yalnızca her N kayıttan birini tutar. Farklı thread'lerin kayıtları
+// dosyada en fazla bir boşaltma aralığı kadar karışık sırada görünebilir.
+class AsyncLog {
+public:
+    // out: kayıtların yazılacağı akış (sahipliği alınmaz); sample: her kaç kayıttan biri tutulsun (0: hiçbiri)
+    AsyncLog(std::FILE* out, std::size_t sample, std::chrono::milliseconds every)
+        : out_(out), sample_(sample), enabled_(out != nullptr && sample != 0) {
+        if (enabled_) {
+            flusher_ = std::thread([this, every] { flushLoop(every); });
+        }
+    }
+
+    AsyncLog(const AsyncLog&) = delete;
+    AsyncLog& operator=(const AsyncLog&) = delete;
+
+    ~AsyncLog() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        if (flusher_.joinable()) {
+            flusher_.join();
+        }
+    }
+
+    // Parçaları tek kayıt olarak ekle. Kilit almaz, bellek ayırmaz (thread'in ilk kaydı hariç).
+    void record(std::initializer_list<std::string_view> parts) {
+        if (!enabled_) {
+            return;
+        }
+        Ring& ring = localRing();
+        if (sample_ > 1 && ring.skipped++ % sample_ != 0) {
+            return;
+        }
+        std::size_t length = 0;
+        for (std::string_view part : parts) {
+            length += part.size();
+        }
+        length = std::min(length, maxRecord);
+        std::int64_t const stamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        ring.push(stamp, parts, static_cast<std::uint32_t>(length));
+    }
+
+    // Tampon dolduğu için atılan kayıt sayısı
+    std::uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::uint64_t total = retiredDrops_;
+        for (const auto& ring : rings_) {
+            total += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    static constexpr std::size_t ringBytes = std::size_t{ 1 } << 18; // thread başına
+    static constexpr std::size_t maxRecord = 1024;                   // daha uzun kayıtlar kesilir
+    static constexpr std::size_t headerBytes = sizeof(std::uint32_t) + sizeof(std::int64_t);
+
+    // Tek yazarlı, tek okuyuculu bayt halkası. Konumlar hiç sarmayan 64 bitlik sayaçlardır;
+    // yazar head'i, okuyucu tail'i ilerletir. Kayıt: [uzunluk][zaman damgası ms][metin].
+    struct Ring {
+        std::unique_ptr<char[]> data{ new char[ringBytes] };
+        alignas(64) std::atomic<std::uint64_t> head{ 0 };
+        std::uint64_t cachedTail = 0;       // yazarın son gördüğü tail; okuyucuya her kayıtta gidilmez
+        std::uint64_t skipped = 0;          // örnekleme sayacı (yalnızca yazar)
+        std::atomic<std::uint64_t> dropped{ 0 };
+        std::atomic<bool> closed{ false };  // sahibi thread bitti; boşaltılınca listeden çıkar
+        alignas(64) std::atomic<std::uint64_t> tail{ 0 };
+
+        void push(std::int64_t stamp, std::initializer_list<std::string_view> parts, std::uint32_t length) {
+            std::uint64_t const position = head.load(std::memory_order_relaxed);
+            std::uint64_t const size = headerBytes + length;
+            if (position + size - cachedTail > ringBytes) {
+                cachedTail = tail.load(std::memory_order_acquire);
+                if (position + size - cachedTail > ringBytes) {
+                    // Yalnızca bu thread yazdığından atomik artırmaya gerek yok
+                    dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            std::uint64_t at = position;
+            copyIn(at, &length, sizeof(length));
+            copyIn(at, &stamp, sizeof(stamp));
+            std::size_t left = length;
+            for (std::string_view part : parts) {
+                std::size_t const n = std::min(left, part.size());
+                copyIn(at, part.data(), n);
+                left -= n;
+            }
+            head.store(position + size, std::memory_order_release);
+        }
+
+        void copyIn(std::uint64_t& at, const void* from, std::size_t n) {
+            std::size_t const offset = static_cast<std::size_t>(at % ringBytes);
+            std::size_t const first = std::min(n, ringBytes - offset);
+            std::memcpy(data.get() + offset, from, first);
+            std::memcpy(data.get(), static_cast<const char*>(from) + first, n - first);
+            at += n;
+        }
+
+        void copyOut(std::uint64_t& at, void* to, std::size_t n) const {
+            std::size_t const offset = static_cast<std::size_t>(at % ringBytes);
+            std::size_t const first = std::min(n, ringBytes - offset);
+            std::memcpy(to, data.get() + offset, first);
+            std::memcpy(static_cast<char*>(to) + first, data.get(), n - first);
+            at += n;
+        }
+    };
+
+    // Thread bitince halkasını kapalı işaretler; kalan kayıtlar yine de yazılır
+    struct LocalRing {
+        const AsyncLog* owner = nullptr;
+        std::shared_ptr<Ring> ring;
+
+        ~LocalRing() {
+            if (ring) {
+                ring->closed.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    std::FILE* out_;
+    std::size_t sample_;
+    bool enabled_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::vector<std::shared_ptr<Ring>> rings_; // mutex_ ile korunur; yalnızca thread'in ilk kaydında değişir
+    std::uint64_t retiredDrops_ = 0;           // listeden çıkan halkaların atılan kayıtları
+    std::thread flusher_;
+
+    Ring& localRing() {
+        thread_local LocalRing local;
+        if (local.owner != this) {
+            if (local.ring) {
+                local.ring->closed.store(true, std::memory_order_release);
+            }
+            local.owner = this;
+            local.ring = std::make_shared<Ring>();
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings_.push_back(local.ring);
+        }
+        return *local.ring;
+    }
+
+    // Halkadaki tüm kayıtları "[SS:DD:ss.mmm] metin" satırları olarak batch'e ekle
+    static void drain(Ring& ring, std::string& batch, std::int64_t& lastSecond, char (&clock)[16]) {
+        std::uint64_t const head = ring.head.load(std::memory_order_acquire);
+        std::uint64_t at = ring.tail.load(std::memory_order_relaxed);
+        while (at < head) {
+            std::uint32_t length = 0;
+            std::int64_t stamp = 0;
+            ring.copyOut(at, &length, sizeof(length));
+            ring.copyOut(at, &stamp, sizeof(stamp));
+            if (stamp / 1000 != lastSecond) {
+                lastSecond = stamp / 1000;
+                std::time_t const seconds = static_cast<std::time_t>(lastSecond);
+                std::tm local{};
+#if defined(_WIN32)
+                localtime_s(&local, &seconds);
+#else
+                localtime_r(&seconds, &local);
+#endif
+                strftime(clock, sizeof(clock), "%H:%M:%S", &local);
+            }
+            char millis[8];
+            std::snprintf(millis, sizeof(millis), ".%03d", static_cast<int>(stamp % 1000));
+            batch += '[';
+            batch += clock;
+            batch += millis;
+            batch += "] ";
+            std::size_t const start = batch.size();
+            batch.resize(start + length);
+            ring.copyOut(at, &batch[start], length);
+            // Mesajdaki satır sonları günlüğün satır düzenini bozmasın
+            for (std::size_t i = start; i < batch.size(); ++i) {
+                if (static_cast<unsigned char>(batch[i]) < 0x20) {
+                    batch[i] = ' ';
+                }
+            }
+            batch += '\n';
+        }
+        ring.tail.store(at, std::memory_order_release);
+    }
+
+    void flushLoop(std::chrono::milliseconds every) {
+        std::string batch;
+        std::int64_t lastSecond = -1;
+        char clock[16] = {};
+        std::uint64_t reportedDrops = 0;
+        std::vector<std::shared_ptr<Ring>> rings;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            bool const stopping = wake_.wait_for(lock, every, [this] { return stopping_; });
+            rings = rings_;
+            lock.unlock();
+
+            // Kapalı halka, closed okunduktan sonra boşaltılırsa artık kaydı kalmaz
+            std::vector<const Ring*> finished;
+            for (const auto& ring : rings) {
+                if (ring->closed.load(std::memory_order_acquire)) {
+                    finished.push_back(ring.get());
+                }
+                drain(*ring, batch, lastSecond, clock);
+            }
+            rings.clear();
+
+            lock.lock();
+            for (const Ring* ring : finished) {
+                auto const it = std::find_if(rings_.begin(), rings_.end(),
+                                             [ring](const auto& item) { return item.get() == ring; });
+                retiredDrops_ += (*it)->dropped.load(std::memory_order_relaxed);
+                rings_.erase(it);
+            }
+            lock.unlock();
+            std::uint64_t const drops = dropped();
+
+            if (drops != reportedDrops) {
+                batch += "[günlük] tampon dolu olduğu için " + std::to_string(drops - reportedDrops) + " kayıt atıldı\n";
+                reportedDrops = drops;
+            }
+            if (!batch.empty()) {
+                std::fwrite(batch.data(), 1, batch.size(), out_);
+                std::fflush(out_);
+                batch.clear();
+            }
+            lock.lock();
+            if (stopping) {
+                return;
+            }
+        }
+    }
+};
+
+// Karşılaştırma için eski yöntem: her ifade için mesajı baştan tarayan std::string::find zinciri
+int matchByFind(const IntentSet& set, const std::string& normalizedMessage) {
+    const std::vector<Intent>& intents = set.intents;
+    for (std::size_t i = 0; i < intents.size(); ++i) {
+        for (const std::string& phrase : intents[i].phrases) {
+            if (normalizedMessage.find(phrase) != std::string::npos) {
+                return static_cast<int>(i);
+            }
+        }
+    }
+    return IntentMatcher::noMatch;
+}
+
+// Bulanık eşleştiricinin doğrulaması: her ifade için mesajın kelime sonunda biten her alt dizisine olan
+// düzenleme uzaklığı klasik dinamik programlamayla hesaplanır
+int matchByEditDistance(const IntentSet& set, const std::string& normalizedMessage) {
+    int bestEdits = FuzzyMatcher::maxEdits + 1;
+    int best = IntentMatcher::noMatch;
+    std::vector<int> previous;
+    std::vector<int> row;
+    for (std::size_t i = 0; i < set.intents.size(); ++i) {
+        for (const std::string& phrase : set.intents[i].phrases) {
+            int const allowed = FuzzyMatcher::allowedEdits(phrase.size());
+            if (allowed == 0 || phrase.size() > 64) {
+                continue;
+            }
+            // Sütun: ifadenin ilk p baytı, mesajda herhangi bir yerde bitecek şekilde
+            previous.assign(normalizedMessage.size() + 1, 0);
+            for (std::size_t p = 1; p <= phrase.size(); ++p) {
+                row.assign(normalizedMessage.size() + 1, static_cast<int>(p));
+                for (std::size_t t = 1; t <= normalizedMessage.size(); ++t) {
+                    int const substitute = previous[t - 1] + (phrase[p - 1] != normalizedMessage[t - 1] ? 1 : 0);
+                    row[t] = std::min({ substitute, previous[t] + 1, row[t - 1] + 1 });
+                }
+                previous.swap(row);
+            }
+            int edits = INT_MAX;
+            for (std::size_t t = 1; t <= normalizedMessage.size(); ++t) {
+                if (t == normalizedMessage.size() || !FuzzyMatcher::isWordByte(normalizedMessage[t])) {
+                    edits = std::min(edits, previous[t]);
+                }
+            }
+            if (edits <= allowed && edits < bestEdits) {
+                bestEdits = edits;
+                best = static_cast<int>(i);
+            }
+        }
+    }
+    return best;
+}
+
+// Oyuncu sohbetlerine benzeyen örnek mesajlar; --bench bir dosya verilmezse bunlar kullanılır
+const std::vector<std::string>& sampleCorpus() {
+    static const std::vector<std::string> corpus = {
+        "merhaba",
+        "selam naber",
+        "Merhaba, nasılsın?",
+        "nasıl indirilir",
+        "oyunu nereden indirebilirim acaba",
+        "steam linki var mı",
+        "saat kaç",
+        "teşekkürler!",
+        "sağ ol kanka",
+        "ne sorabilirim",
+        "tüm komutları listele",
+        "oyun nedir, biraz anlatır mısın",
+        "hikaye ne hakkında? akıl hastanesi mi",
+        "sistem gereksinimleri neler, laptopum eski de",
+        "minimum özellikler nedir",
+        "çıkış tarihi belli mi",
+        "ne zaman çıkacak bu oyun artık",
+        "ana karakter kim",
+        "kaç sonu var",
+        "zorluk seviyesi ayarlanabiliyor mu",
+        "destek ekibine nasıl ulaşırım",
+        "bu oyun çok korkunç ya",
+        "dün gece oynadım uyuyamadım",
+        "lol",
+        "???",
+        "bölüm 3'teki kapıyı nasıl açıyoruz, anahtarı bulamadım hiçbir yerde",
+        "ekran kartım gtx 1050 çalışır mı",
+        "türkçe dublaj gelecek mi",
+        "arkadaşlarla co-op oynanıyor mu yoksa tek kişilik mi",
+        "fiyatı ne kadar olacak",
+        "hesabımı nasıl silerim",
+        "şifremi unuttum",
+        "skor tablosunda adım görünmüyor neden",
+        "ps5 sürümü olacak mı",
+        "oyunu bitirdim ama sonu anlamadım, kaç sonu var gerçekten",
+        "Merhaba ben yeni geldim, oyun hakkında bilgi verir misin? bir de sistem gereksinimleri nedir",
+        "abi bu oyunu 3 gündür oynuyorum ve hala ilk bölümdeyim, bulmacalar çok zor, zorluk seviyesi düşürülebiliyor mu acaba yoksa hep böyle mi",
+        "iletişim",
+        "zaman",
+        "sa",
+        "NASILSIN",
+        "TEŞEKKÜRLER",
+        "İNDİR",
+        "Indir linki nerede",
+        "nasilsin",
+        "oyun hakkinda bilgi",
+        "Çıkış Tarihi Ne?",
+        "nasilsn",
+        "merhba",
+        "hikya ne",
+        "tesekurler",
+        "sistem gereksinimlri",
+        "cikis tarhi ne zaman",
+        "zorlk seviyesi",
+        "korkunc olmus",
+    };
+    return corpus;
+}
+
+// Eşleştiricinin ölçümü: otomat ile eski find zinciri aynı mesajları işler, sonuçlar karşılaştırılır
+int runBenchmark(const IntentSet& set, const char* corpusPath) {
+    std::vector<std::string> corpus;
+    if (corpusPath != nullptr) {
+        std::ifstream file(corpusPath);
+        if (!file) {
+            std::cerr << "Mesaj dosyası açılamadı: " << corpusPath << std::endl;
+            return 1;
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty()) {
+                corpus.push_back(line);
+            }
+        }
     }
     else {
-        return "Anladım... Ama bu sorunun cevabı karanlığın derinliklerinde saklı olabilir. Başka bir şey sormak ister misin?";
+        corpus = sampleCorpus();
+    }
+    if (corpus.empty()) {
+        std::cerr << "Mesaj dosyası boş." << std::endl;
+        return 1;
+    }
+
+    const IntentMatcher& matcher = set.matcher;
+    std::vector<std::string> normalized;
+    std::size_t mismatches = 0;
+    for (const std::string& message : corpus) {
+        normalized.emplace_back();
+        set.normalize(message, normalized.back());
+        if (matcher.match(normalized.back()) != matchByFind(set, normalized.back())) {
+            std::cerr << "Farklı sonuç: " << message << std::endl;
+            ++mismatches;
+        }
+    }
+    // Tam eşleşmeyenler bulanık eşleştiriciye gider; süzgeçli ve süzgeçsiz sonuç DP ile aynı olmalı
+    std::vector<std::string> unmatched;
+    std::size_t fuzzyHits = 0;
+    for (std::size_t i = 0; i < corpus.size(); ++i) {
+        const std::string& message = normalized[i];
+        if (matcher.match(message) != IntentMatcher::noMatch) {
+            continue;
+        }
+        unmatched.push_back(message);
+        int const expected = matchByEditDistance(set, message);
+        if (set.fuzzy.match(message) != expected || set.fuzzy.match(message, false) != expected) {
+            std::cerr << "Farklı bulanık sonuç: " << corpus[i] << std::endl;
+            ++mismatches;
+        }
+        fuzzyHits += expected != IntentMatcher::noMatch ? 1 : 0;
     }
+
+    std::size_t const rounds = std::max<std::size_t>(1, 2000000 / corpus.size());
+    auto measure = [&](const std::vector<std::string>& inputs, auto&& fn) {
+        std::size_t bytes = 0;
+        for (const std::string& input : inputs) {
+            bytes += input.size();
+        }
+        long long sink = 0;
+        auto const start = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (const std::string& message : inputs) {
+                sink += fn(message);
+            }
+        }
+        double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "  " << seconds * 1e9 / (rounds * inputs.size()) << " ns/mesaj, "
+                  << rounds * bytes / seconds / 1e6 << " MB/s (" << sink % 7 << ")" << std::endl;
+    };
+
+    std::cout << corpus.size() << " mesaj, " << rounds << " tur" << std::endl;
+    std::cout << "Normalleştirme:" << std::endl;
+    std::string buffer;
+    measure(corpus, [&](const std::string& m) {
+        set.normalize(m, buffer);
+        return buffer.size();
+    });
+    std::cout << "Aho-Corasick:" << std::endl;
+    measure(normalized, [&](const std::string& m) { return matcher.match(m); });
+
+    // Node'un gönderdiği biçimde istek gövdeleri ve her mesajın cevabı
+    std::vector<std::string> bodies;
+    std::vector<std::string> replies;
+    for (std::size_t i = 0; i < corpus.size(); ++i) {
+        bodies.emplace_back("{\"message\": ");
+        appendJsonString(bodies.back(), corpus[i]);
+        bodies.back() += '}';
+        std::string rendered;
+        std::time_t validUntil = 0;
+        replies.emplace_back(getBotResponse(set, normalized[i], 0, validUntil, rendered));
+    }
+    std::cout << "İstek ayrıştırma (jsoncpp Json::Reader):" << std::endl;
+    measure(bodies, [&](const std::string& body) {
+        Json::Value requestJson;
+        Json::Reader reader;
+        reader.parse(body, requestJson);
+        return requestJson["message"].asString().size();
+    });
+    std::cout << "İstek ayrıştırma (JsonPullReader):" << std::endl;
+    std::string scratch;
+    std::string sessionScratch;
+    measure(bodies, [&](const std::string& body) {
+        std::string_view message;
+        std::string_view session;
+        readMessageField(body, message, scratch, session, sessionScratch);
+        return message.size();
+    });
+    std::size_t styledBytes = 0;
+    std::size_t compactBytes = 0;
+    std::cout << "Cevap yazma (jsoncpp toStyledString, önbellek isabetinde atlanır):" << std::endl;
+    measure(replies, [&](const std::string& reply) {
+        Json::Value responseJson;
+        responseJson["reply"] = reply;
+        return responseJson.toStyledString().size();
+    });
+    std::cout << "Cevap yazma (appendJsonString):" << std::endl;
+    measure(replies, [&](const std::string& reply) {
+        buffer.assign("{\"reply\":");
+        appendJsonString(buffer, reply);
+        buffer += '}';
+        return buffer.size();
+    });
+    std::cout << "Akış olayları (appendSseReply):" << std::endl;
+    measure(replies, [&](const std::string& reply) {
+        buffer.clear();
+        appendSseReply(buffer, reply);
+        return buffer.size();
+    });
+    for (const std::string& reply : replies) {
+        Json::Value responseJson;
+        responseJson["reply"] = reply;
+        styledBytes += responseJson.toStyledString().size();
+        buffer.assign("{\"reply\":");
+        appendJsonString(buffer, reply);
+        compactBytes += buffer.size() + 1;
+    }
+    std::cout << "Cevap boyutu: jsoncpp " << styledBytes / replies.size() << " bayt, sıkıştırılmış "
+              << compactBytes / replies.size() << " bayt (ortalama)" << std::endl;
+    std::cout << "Önbellek (özet + arama):" << std::endl;
+    for (const std::string& message : normalized) {
+        set.replies.store(messageHash(message), std::make_shared<const std::string>(message), IntentMatcher::noMatch, 0);
+    }
+    int cachedIntent;
+    measure(normalized, [&](const std::string& m) { return set.replies.find(messageHash(m), 0, cachedIntent) != nullptr; });
+    if (!unmatched.empty()) {
+        std::cout << "Bulanık eşleştirme, tam eşleşmeyen " << unmatched.size() << " mesaj (" << fuzzyHits
+                  << " tanesi bir niyete bağlandı):" << std::endl;
+        measure(unmatched, [&](const std::string& m) { return set.fuzzy.match(m); });
+        std::cout << "Bulanık eşleştirme, ikili süzgeç kapalı:" << std::endl;
+        measure(unmatched, [&](const std::string& m) { return set.fuzzy.match(m, false); });
+        std::cout << "Düzenleme uzaklığı (dinamik programlama):" << std::endl;
+        measure(unmatched, [&](const std::string& m) { return matchByEditDistance(set, m); });
+    }
+    std::cout << "Oturum deposu (niyet ekle + geçmişi oku):" << std::endl;
+    {
+        SessionStore sessions(65536, std::chrono::seconds(1800));
+        std::array<std::uint32_t, SessionStore::historySize> recent;
+        std::uint32_t next = 0;
+        measure(normalized, [&](const std::string& m) {
+            std::string_view const id(m.data(), std::min(m.size(), SessionStore::maxIdLength));
+            sessions.remember(id, ++next, 1000000);
+            return sessions.recall(id, 1000000, recent);
+        });
+    }
+    // Günlük /dev/null'a yazılır; ölçülen, istek thread'inin kayıt başına ödediği bedeldir
+    if (std::FILE* sink = std::fopen("/dev/null", "w")) {
+        std::ofstream stream("/dev/null");
+        std::cout << "Günlük kaydı (akışa yaz + std::endl):" << std::endl;
+        measure(corpus, [&](const std::string& m) {
+            stream << "Node.js'ten gelen mesaj: " << m << std::endl;
+            return m.size();
+        });
+        std::cout << "Günlük kaydı (AsyncLog; döngü tamponu boşaltmaktan hızlı olduğundan çoğu kayıt atılır):" << std::endl;
+        {
+            AsyncLog log(sink, 1, std::chrono::milliseconds(50));
+            measure(corpus, [&](const std::string& m) {
+                log.record({ "Node.js'ten gelen mesaj: ", m });
+                return m.size();
+            });
+            std::cout << "  tampon dolduğu için atılan: " << log.dropped() << std::endl;
+        }
+        std::fclose(sink);
+    }
+    std::cout << "std::string::find zinciri:" << std::endl;
+    measure(normalized, [&](const std::string& m) { return matchByFind(set, m); });
+    std::cout << "Farklı sonuç: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // "--intents=dosya": niyet tablosu (varsayılan intents.json)
+    // "--reply-cache=N": önbellekte tutulacak en fazla cevap (0: kapalı)
+    // "--batch-threads=N": /chatbot/batch için thread sayısı (varsayılan: çekirdek sayısı - 1)
+    // "--log=dosya": istek günlüğü bu dosyanın sonuna yazılır ("-": stdout, varsayılan)
+    // "--log-sample=N": her thread'de her N istekten biri günlüğe yazılır (1: hepsi, 0: hiçbiri)
+    // "--sessions=N": hafızada tutulacak en fazla sohbet oturumu (0: oturumlar kapalı)
+    // "--session-ttl=saniye": son mesajından bu kadar sonra oturum unutulur (varsayılan 1800)
+    // "--bench [mesajlar.txt]": sunucuyu başlatmadan eşleştiriciyi ölç
+    std::string intentsPath = "intents.json";
+    std::size_t cacheCapacity = 8192;
+    std::size_t batchThreads = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    std::string logPath = "-";
+    std::size_t logSample = 1;
+    std::size_t sessionCapacity = 65536;
+    long long sessionTtl = 1800;
+    bool bench = false;
+    const char* corpusPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (arg.rfind("--intents=", 0) == 0) {
+            intentsPath = arg.substr(10);
+        }
+        else if (arg.rfind("--reply-cache=", 0) == 0) {
+            cacheCapacity = std::strtoull(arg.c_str() + 14, nullptr, 10);
+        }
+        else if (arg.rfind("--batch-threads=", 0) == 0) {
+            batchThreads = std::strtoull(arg.c_str() + 16, nullptr, 10);
+        }
+        else if (arg.rfind("--log=", 0) == 0) {
+            logPath = arg.substr(6);
+        }
+        else if (arg.rfind("--log-sample=", 0) == 0) {
+            logSample = std::strtoull(arg.c_str() + 13, nullptr, 10);
+        }
+        else if (arg.rfind("--sessions=", 0) == 0) {
+            sessionCapacity = std::strtoull(arg.c_str() + 11, nullptr, 10);
+        }
+        else if (arg.rfind("--session-ttl=", 0) == 0) {
+            sessionTtl = std::strtoll(arg.c_str() + 14, nullptr, 10);
+        }
+        else if (arg == "--bench") {
+            bench = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                corpusPath = argv[++i];
+            }
+        }
+    }
+
+    IntentStore intents(intentsPath, cacheCapacity);
+    std::string error;
+    if (!intents.reload(error)) {
+        std::cerr << "Niyet tablosu yüklenemedi (" << intentsPath << "): " << error << std::endl;
+        return 1;
+    }
+    if (bench) {
+        return runBenchmark(*intents.current(), corpusPath);
+    }
+    std::cout << "Niyet tablosu yüklendi: " << intents.current()->intents.size() << " niyet" << std::endl;
+    intents.watch(std::chrono::seconds(1));
+
+    std::FILE* logFile = stdout;
+    if (logPath != "-") {
+        logFile = std::fopen(logPath.c_str(), "a");
+        if (logFile == nullptr) {
+            std::cerr << "Günlük dosyası açılamadı: " << logPath << std::endl;
+            return 1;
+        }
+    }
+    AsyncLog requestLog(logFile, logSample, std::chrono::milliseconds(50));
+
+    SessionStore sessions(sessionCapacity, std::chrono::seconds(sessionTtl));
+    {
+        SessionStore::Stats const stats = sessions.stats(std::time(nullptr));
+        std::cout << "Oturum deposu: " << stats.capacity << " oturum, oturum başına "
+                  << (stats.capacity == 0 ? 0 : stats.bytes / stats.capacity) << " bayt, toplam "
+                  << stats.bytes / 1024 << " KB" << std::endl;
+    }
+
     httplib::Server svr; // Bir HTTP sunucusu objesi oluştur
 
     // /chatbot API endpoint'i tanımla
-    svr.Post("/chatbot", [](const httplib::Request& req, httplib::Response& res) {
-        Json::Value requestJson;
-        Json::Reader reader;
-        
-        // Gelen isteğin JSON body'sini ayrıştır
-        if (!reader.parse(req.body, requestJson)) {
+    svr.Post("/chatbot", [&intents, &requestLog, &sessions](const httplib::Request& req, httplib::Response& res) {
+        // Gelen isteğin JSON body'sinden mesajı doğrudan oku (kaçış yoksa kopyalanmaz)
+        thread_local std::string scratch;
+        thread_local std::string sessionScratch;
+        std::string_view userMessage;
+        std::string_view session;
+        RequestError const parsed = readMessageField(req.body, userMessage, scratch, session, sessionScratch);
+        if (parsed == RequestError::invalidJson) {
             res.status = 400; // Bad Request
             res.set_content("{\"error\": \"Invalid JSON\"}", "application/json");
             return;
         }
+        if (parsed == RequestError::invalidField) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"'message' alanı eksik veya geçersiz\"}", "application/json");
+            return;
+        }
+        if (parsed == RequestError::invalidSession) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"'session' en fazla 48 baytlık bir metin olmalı\"}", "application/json");
+            return;
+        }
+
+        requestLog.record({ "Node.js'ten gelen mesaj: ", userMessage }); // Günlüğe yaz (beklemeden)
+
+        // Mesajı thread'e ait tampona normalleştir; aynı mesaj daha önce cevaplandıysa hazır JSON gönderilir
+        std::shared_ptr<const IntentSet> set = intents.current();
+        thread_local std::string normalized;
+        set->normalize(userMessage, normalized);
+        std::uint64_t const key = messageHash(normalized);
+        std::time_t const now = std::time(nullptr);
 
-        if (!requestJson.isMember("message") || !requestJson["message"].isString()) {
+        // Chatbot yanıtını JSON formatında al ve Node.js'e gönder
+        std::shared_ptr<const std::string> const responseJson = getReplyPayload(*set, sessions, session, normalized, key,
+            now, [](std::string& out, std::string_view reply) {
+                out.assign("{\"reply\":");
+                appendJsonString(out, reply);
+                out += '}';
+            });
+        res.set_content(*responseJson, "application/json");
+    });
+
+    // Akış halinde cevap: GET /chatbot/stream?message=... (tarayıcı EventSource) ya da /chatbot ile aynı
+    // gövdeyle POST. Cevap mikro saniyeler içinde hazır olduğundan bütün olaylar tek parça halinde
+    // hemen yazılır; yazma efektinin temposunu istemci tutar. Sunucu olaylar arasında beklemediği için
+    // bir akış, worker thread'ini yalnızca soket verileri alana kadar meşgul eder.
+    auto streamReply = [&intents, &requestLog, &sessions](std::string_view userMessage, std::string_view session,
+                                                           httplib::Response& res) {
+        requestLog.record({ "Node.js'ten gelen akış isteği: ", userMessage });
+
+        // Olay metni de önbelleğe girer; anahtar /chatbot cevaplarıyla karışmasın diye ayrıştırılır
+        std::shared_ptr<const IntentSet> set = intents.current();
+        thread_local std::string normalized;
+        set->normalize(userMessage, normalized);
+        std::uint64_t const key = messageHash(normalized) ^ 0x73747265616d0000ull;
+        std::time_t const now = std::time(nullptr);
+        std::shared_ptr<const std::string> const events = getReplyPayload(*set, sessions, session, normalized, key, now,
+            appendSseReply);
+
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("X-Accel-Buffering", "no"); // araya giren nginx olayları biriktirmesin
+        // Akış bitince istemci bağlantıyı kapatsın; keep-alive'da bekleyen bağlantı da bir worker tutar
+        res.set_header("Connection", "close");
+        res.set_chunked_content_provider("text/event-stream", [events](std::size_t, httplib::DataSink& sink) {
+            // Küçük parçaları ayrı ayrı yazmak Nagle yüzünden olaylar arasında gecikme yaratırdı
+            sink.write(events->data(), events->size());
+            sink.done();
+            return true;
+        });
+    };
+    svr.Get("/chatbot/stream", [streamReply](const httplib::Request& req, httplib::Response& res) {
+        if (!req.has_param("message")) {
             res.status = 400; // Bad Request
             res.set_content("{\"error\": \"'message' alanı eksik veya geçersiz\"}", "application/json");
             return;
         }
+        std::string const session = req.get_param_value("session");
+        if (session.size() > SessionStore::maxIdLength) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"'session' en fazla 48 baytlık bir metin olmalı\"}", "application/json");
+            return;
+        }
+        streamReply(req.get_param_value("message"), session, res);
+    });
+    svr.Post("/chatbot/stream", [streamReply](const httplib::Request& req, httplib::Response& res) {
+        thread_local std::string scratch;
+        thread_local std::string sessionScratch;
+        std::string_view userMessage;
+        std::string_view session;
+        RequestError const parsed = readMessageField(req.body, userMessage, scratch, session, sessionScratch);
+        if (parsed == RequestError::invalidJson) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"Invalid JSON\"}", "application/json");
+            return;
+        }
+        if (parsed == RequestError::invalidField) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"'message' alanı eksik veya geçersiz\"}", "application/json");
+            return;
+        }
+        if (parsed == RequestError::invalidSession) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"'session' en fazla 48 baytlık bir metin olmalı\"}", "application/json");
+            return;
+        }
+        streamReply(userMessage, session, res);
+    });
+
+    // Oturum deposunun durumu: kaç oturum açık, ne kadar bellek ayrılmış, kaçı düştü
+    svr.Get("/chatbot/sessions", [&sessions](const httplib::Request&, httplib::Response& res) {
+        SessionStore::Stats const stats = sessions.stats(std::time(nullptr));
+        std::string body = "{\"active\":" + std::to_string(stats.active) + ",\"capacity\":" + std::to_string(stats.capacity)
+            + ",\"bytes\":" + std::to_string(stats.bytes) + ",\"bytesPerSession\":"
+            + std::to_string(stats.capacity == 0 ? 0 : stats.bytes / stats.capacity) + ",\"expired\":"
+            + std::to_string(stats.expired) + ",\"evicted\":" + std::to_string(stats.evicted) + "}";
+        res.set_content(std::move(body), "application/json");
+    });
 
-        std::string userMessage = requestJson["message"].asString();
-        std::cout << "Node.js'ten gelen mesaj: " << userMessage << std::endl; // Konsola yazdır
+    // Toplu mesaj: {"messages": [...]} -> {"replies": [...]}, cevaplar aynı sırada.
+    // HTTP ve JSON maliyeti mesaj başına değil istek başına ödenir.
+    BatchPool batchPool(batchThreads);
+    svr.Post("/chatbot/batch", [&intents, &batchPool, &requestLog](const httplib::Request& req, httplib::Response& res) {
+        static constexpr std::size_t maxMessages = 1000;
 
-        // Chatbot yanıtını al
-        std::string botResponse = getBotResponse(userMessage);
+        // Mesajlar gövdenin içini gösterir; yalnızca kaçış içerenler çözülüp ayrıca saklanır
+        std::vector<std::string_view> messages;
+        std::deque<std::string> decoded;
+        bool found = false;
+        bool tooMany = false;
+        bool notText = false;
+        JsonPullReader reader(req.body);
+        std::string_view key;
+        if (reader.beginObject()) {
+            while (reader.nextMember(key)) {
+                if (key != "messages" || reader.peek() != '[') {
+                    reader.skipValue();
+                    continue;
+                }
+                reader.beginArray();
+                found = true;
+                messages.clear();
+                while (reader.nextElement()) {
+                    if (reader.peek() != '"') {
+                        notText = true;
+                        reader.skipValue();
+                        continue;
+                    }
+                    std::string scratch;
+                    std::string_view message;
+                    if (!reader.readString(message, scratch)) {
+                        break;
+                    }
+                    if (message.data() == scratch.data()) {
+                        message = decoded.emplace_back(std::move(scratch));
+                    }
+                    if (messages.size() == maxMessages) {
+                        tooMany = true;
+                        continue;
+                    }
+                    messages.push_back(message);
+                }
+            }
+        }
+        if (reader.failed() || !reader.finish()) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"Invalid JSON\"}", "application/json");
+            return;
+        }
+        if (!found || tooMany) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"'messages' en fazla 1000 mesajlık bir dizi olmalı\"}", "application/json");
+            return;
+        }
+        if (notText) {
+            res.status = 400; // Bad Request
+            res.set_content("{\"error\": \"'messages' yalnızca metin içermeli\"}", "application/json");
+            return;
+        }
+        char count[24];
+        char* const countEnd = std::to_chars(count, count + sizeof(count), messages.size()).ptr;
+        requestLog.record({ "Node.js'ten gelen toplu istek: ", std::string_view(count, countEnd - count), " mesaj" });
 
-        // Yanıtı JSON formatında hazırla
-        Json::Value responseJson;
-        responseJson["reply"] = botResponse;
+        // Her thread kendi tamponunda normalleştirir; cevap mesajın sırasındaki yere yazılır
+        std::shared_ptr<const IntentSet> set = intents.current();
+        std::time_t const now = std::time(nullptr);
+        // Saat içeren cevaplar mesajın kendi rendered tamponuna yazılır; diğerleri tabloyu gösterir
+        std::vector<std::string_view> replies(messages.size());
+        std::vector<std::string> rendered(messages.size());
+        std::size_t const chunk = std::max<std::size_t>(16, messages.size() / (4 * (batchPool.size() + 1)));
+        batchPool.run(messages.size(), chunk, [&](std::size_t i) {
+            thread_local std::string normalized;
+            set->normalize(messages[i], normalized);
+            std::time_t validUntil = 0;
+            replies[i] = getBotResponse(*set, normalized, now, validUntil, rendered[i]);
+        });
 
-        // Yanıtı Node.js'e JSON olarak gönder
-        res.set_content(responseJson.toStyledString(), "application/json");
+        std::string responseJson = "{\"replies\":[";
+        for (std::size_t i = 0; i < replies.size(); ++i) {
+            if (i != 0) {
+                responseJson += ',';
+            }
+            appendJsonString(responseJson, replies[i]);
+        }
+        responseJson += "]}";
+        res.set_content(std::move(responseJson), "application/json");
     });
 
     // Sunucuyu 8081 portunda başlat
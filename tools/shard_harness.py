@@ -0,0 +1,250 @@
+#!/usr/bin/env python3
+# Parçalı skor tablosunu tek süreçli sunucuyla karşılaştıran yerel sınama aracı.
+#
+# N tane "--shard=i/N" süreci, bunların önünde bir "--front=" düğümü ve tek süreçli bir referans
+# sunucu başlatır; hepsine aynı skor gönderimlerini yollar, ardından ön düğümün ve referansın
+# cevaplarını karşılaştırır: top-K (all/daily/weekly), /scores/rank ve /scores/ranks.
+#
+# Varsayılan olarak her gönderimin skoru farklıdır ve cevaplar birebir aynı olmalıdır. --ties ile skorlar
+# dar bir aralıktan seçilir: tek süreçte eşit skorlar "skoru önce alan önde" sıralanırken ön düğüm
+# parçalar arası eşitlikleri oyuncunun arkasında sayar. Bu kipte eşit skorlu oyuncuların kendi
+# aralarındaki sırası karşılaştırılmaz; sıra numarasının eşitlik grubunun içinde kalması yeterlidir.
+#
+# Kullanım:
+#   python3 tools/shard_harness.py --backend=./backend [--shards=3] [--players=600] [--seed=1] [--ties]
+#
+# Yalnızca standart kütüphaneyi kullanır. Fark bulunursa ilk birkaçı yazdırılır ve çıkış kodu 1 olur.
+
+import argparse
+import bisect
+import json
+import os
+import random
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+
+WINDOWS = ['', 'daily', 'weekly']
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Parçalı skor tablosunu tek süreçli sunucuyla karşılaştırır')
+    parser.add_argument('--backend', required=True, help='derlenmiş backend programı')
+    parser.add_argument('--shards', type=int, default=3, help='parça sayısı (varsayılan 3)')
+    parser.add_argument('--players', type=int, default=600, help='oyuncu sayısı (varsayılan 600)')
+    parser.add_argument('--submissions', type=int, default=0,
+                        help='toplam gönderim; oyuncu sayısından fazlası tekrar gönderimdir (varsayılan 2 kat)')
+    parser.add_argument('--seed', type=int, default=1, help='rastgele üreteç tohumu')
+    parser.add_argument('--base-port', type=int, default=18080,
+                        help='ilk port: referans, ön düğüm ve parçalar sırayla bunu kullanır')
+    parser.add_argument('--threads', type=int, default=1, help='her sürecin io thread sayısı')
+    parser.add_argument('--ties', action='store_true', help='eşit skorlar üret, eşitlik içi sırayı karşılaştırma')
+    parser.add_argument('--keep', action='store_true', help='veri dizinlerini ve günlükleri silme')
+    return parser.parse_args()
+
+
+class Cluster:
+    def __init__(self, args, root):
+        self.args = args
+        self.root = root
+        self.processes = []
+
+    # Süreci kendi dizininde başlat; günlüğü aynı dizine yazılır
+    def start(self, name, port, extra):
+        # Portu başka bir süreç tutuyorsa hazır olma denetimi yanlışlıkla onunla konuşurdu
+        probe = socket.socket()
+        probe.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1) # TIME_WAIT bağlantıları engel olmasın
+        try:
+            probe.bind(('127.0.0.1', port))
+        except OSError:
+            raise RuntimeError('%d portu kullanımda (--base-port ile başka bir aralık seçin)' % port)
+        finally:
+            probe.close()
+        directory = os.path.join(self.root, name)
+        os.makedirs(os.path.join(directory, 'downloads'))
+        command = [os.path.abspath(self.args.backend), str(self.args.threads), '--port=%d' % port,
+                   '--data=' + os.path.join(directory, 'data')] + extra
+        log = open(os.path.join(directory, 'server.log'), 'w')
+        process = subprocess.Popen(command, cwd=directory, stdout=log, stderr=subprocess.STDOUT)
+        self.processes.append((name, process, port))
+
+    # Her süreç portunu dinleyene kadar bekle
+    def wait_ready(self, timeout=15.0):
+        deadline = time.time() + timeout
+        for name, process, port in self.processes:
+            while True:
+                if process.poll() is not None:
+                    raise RuntimeError('%s başlatılamadı (çıkış kodu %d), günlük: %s'
+                                       % (name, process.returncode, os.path.join(self.root, name, 'server.log')))
+                try:
+                    socket.create_connection(('127.0.0.1', port), timeout=0.2).close()
+                    break
+                except OSError:
+                    if time.time() > deadline:
+                        raise RuntimeError('%s %d portunu açmadı' % (name, port))
+                    time.sleep(0.05)
+
+    def stop(self):
+        for _, process, _ in self.processes:
+            if process.poll() is None:
+                process.terminate()
+        for _, process, _ in self.processes:
+            try:
+                process.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                process.kill()
+                process.wait()
+
+
+# Cevabın durum kodu ve ayrıştırılmış gövdesi (ayrıştırılamazsa ham metin)
+def call(port, path, body=None):
+    data = json.dumps(body).encode() if body is not None else None
+    request = urllib.request.Request('http://127.0.0.1:%d%s' % (port, path), data=data,
+                                     method='POST' if data is not None else 'GET',
+                                     headers={'Content-Type': 'application/json'})
+    try:
+        with urllib.request.urlopen(request, timeout=10) as response:
+            status, text = response.status, response.read()
+    except urllib.error.HTTPError as error:
+        status, text = error.code, error.read()
+    try:
+        return status, json.loads(text)
+    except ValueError:
+        return status, text.decode('utf-8', 'replace')
+
+
+# Eşitlik içi sıradan bağımsız biçim: her kaydın sırası, en iyi skorlara göre eşitlik grubunun içindeyse
+# grubun ilk sırasına çevrilir ve kayıtlar (skor, oyuncu) ile dizilir. limit dolmuşsa son skorun hangi
+# oyuncularla kesildiği de sıraya bağlı olduğundan o gruptan yalnızca kayıt sayısı tutulur.
+def tie_insensitive(response, best_scores, limit=None):
+    status, body = response
+    if not isinstance(body, dict):
+        return response
+
+    def above(score):
+        return len(best_scores) - bisect.bisect_right(best_scores, score)
+
+    def equal(score):
+        return bisect.bisect_right(best_scores, score) - bisect.bisect_left(best_scores, score)
+
+    def fold(entry, subset):
+        entry = dict(entry)
+        score = entry.get('score')
+        if 'rank' in entry and above(score) < entry['rank'] <= above(score) + equal(score):
+            entry['rank'] = above(score) + 1
+        if 'friend_rank' in entry:
+            higher = sum(1 for other in subset if other['score'] > score)
+            same = sum(1 for other in subset if other['score'] == score)
+            if higher < entry['friend_rank'] <= higher + same:
+                entry['friend_rank'] = higher + 1
+        return entry
+
+    if 'scores' not in body:
+        return status, fold(body, [])
+    entries = [fold(entry, body['scores']) for entry in body['scores']]
+    entries.sort(key=lambda entry: (-entry['score'], entry['user']))
+    if limit is not None and len(entries) == limit and entries:
+        last = entries[-1]['score']
+        cut = [entry for entry in entries if entry['score'] != last]
+        entries = cut + [{'score': last, 'count': len(entries) - len(cut)}]
+    return status, dict(body, scores=entries)
+
+
+def main():
+    args = parse_args()
+    if args.shards < 1:
+        sys.exit('--shards en az 1 olmalı')
+    rng = random.Random(args.seed)
+    reference_port = args.base_port
+    front_port = args.base_port + 1
+    shard_ports = [args.base_port + 2 + i for i in range(args.shards)]
+
+    root = tempfile.mkdtemp(prefix='shard_harness_')
+    cluster = Cluster(args, root)
+    mismatches = []
+    checks = 0
+
+    best = {}
+    best_scores = []
+
+    def compare(label, port_path, body=None, limit=None):
+        nonlocal checks
+        checks += 1
+        expected = call(reference_port, port_path, body)
+        got = call(front_port, port_path, body)
+        if args.ties and (body is None or port_path != '/scores'):
+            expected = tie_insensitive(expected, best_scores, limit)
+            got = tie_insensitive(got, best_scores, limit)
+        if expected != got:
+            mismatches.append((label, expected, got))
+
+    try:
+        cluster.start('reference', reference_port, [])
+        for i, port in enumerate(shard_ports):
+            cluster.start('shard%d' % i, port, ['--shard=%d/%d' % (i, args.shards)])
+        cluster.start('front', front_port, ['--front=' + ','.join('127.0.0.1:%d' % p for p in shard_ports)])
+        cluster.wait_ready()
+
+        # Gönderimler: her oyuncu en az bir kez; kalan gönderimler rastgele oyuncuların tekrar denemeleri.
+        # Hepsi aynı anda yapıldığından günlük ve haftalık pencerelerde de oyuncunun en iyi skoru aynıdır.
+        players = ['oyuncu%d' % i for i in range(args.players)]
+        total = args.submissions or 2 * args.players
+        order = players + [rng.choice(players) for _ in range(max(0, total - len(players)))]
+        rng.shuffle(order)
+        if args.ties:
+            scores = [rng.randint(1, max(10, args.players // 2)) for _ in order]
+        else:
+            scores = rng.sample(range(2, 10 ** 9), len(order))
+        for player, score in zip(order, scores):
+            compare('POST /scores %s' % player, '/scores', {'user': player, 'score': score})
+            best[player] = max(best.get(player, 0), score)
+        best_scores[:] = sorted(best.values())
+
+        # Yanlış parçaya gelen gönderim 421 ile reddedilmeli; tam olarak bir parça kabul eder
+        if args.shards > 1:
+            accepted = [port for port in shard_ports
+                        if call(port, '/scores', {'user': players[0], 'score': 1})[0] != 421]
+            checks += 1
+            if len(accepted) != 1:
+                mismatches.append(('421 misdirected', 1, len(accepted)))
+
+        for window in WINDOWS:
+            suffix = '&window=' + window if window else ''
+            for limit in [1, 10, 50, 100, args.players + 10]:
+                compare('top-K %s limit=%d' % (window or 'all', limit), '/scores?limit=%d%s' % (limit, suffix),
+                        limit=min(limit, 1000))
+            compare('top-K %s varsayılan' % (window or 'all'), '/scores' + ('?window=' + window if window else ''),
+                    limit=10)
+
+            for player in rng.sample(players, min(80, len(players))) + ['olmayan_oyuncu']:
+                query = urllib.parse.urlencode({'user': player, 'window': window} if window else {'user': player})
+                compare('rank %s %s' % (window or 'all', player), '/scores/rank?' + query)
+
+            for size in [0, 1, 5, 50, min(500, len(players))]:
+                users = rng.sample(players, min(size, len(players))) + ['olmayan_oyuncu']
+                body = {'users': users, 'window': window} if window else {'users': users}
+                compare('ranks %s n=%d' % (window or 'all', size), '/scores/ranks', body)
+    finally:
+        cluster.stop()
+        if args.keep:
+            print('veri dizinleri ve günlükler:', root)
+        else:
+            shutil.rmtree(root, ignore_errors=True)
+
+    print('%d parça, %d oyuncu, %d gönderim: %d karşılaştırma, %d fark'
+          % (args.shards, args.players, len(order), checks, len(mismatches)))
+    for label, expected, got in mismatches[:10]:
+        print('FARK', label)
+        print('  referans :', expected)
+        print('  ön düğüm :', got)
+    sys.exit(1 if mismatches else 0)
+
+
+if __name__ == '__main__':
+    main()